@@ -19,6 +19,8 @@ expFromPlayersLevelRange = 75
 -- Connection Config
 -- NOTE: maxPlayers set to 0 means no limit
 -- NOTE: allowWalkthrough is only applicable to players
+-- NOTE: banRefreshInterval (in seconds) is how often bans are re-read from
+-- the database; /reload bans applies changes immediately, 0 disables polling
 ip = "127.0.0.1"
 bindOnlyGlobalAddress = false
 loginProtocolPort = 7171
@@ -33,6 +35,7 @@ serverName = "Forgotten"
 statusTimeout = 5000
 replaceKickOnLogin = true
 maxPacketsPerSecond = 25
+banRefreshInterval = 60
 
 -- Pathfinding
 -- pathfindingInterval handles how often paths are force drawn
@@ -41,6 +44,14 @@ maxPacketsPerSecond = 25
 pathfindingInterval = 200
 pathfindingDelay = 300
 
+-- Overload
+-- loadLagHigh and loadLagCritical are how many milliseconds the game loop may run behind
+-- before the server degrades: under high load paths are updated less often and fewer
+-- monsters respawn per tick, under critical load non-critical items also decay later and
+-- effects are only sent to players nearby, 0 disables the level
+loadLagHigh = 100
+loadLagCritical = 400
+
 -- Deaths
 -- NOTE: Leave deathLosePercent as -1 if you want to use the default
 -- death penalty formula. For the old formula, set it to 10. For
@@ -129,6 +140,64 @@ serverSaveCleanMap = false
 serverSaveClose = false
 serverSaveShutdown = true
 
+-- State Journal
+-- NOTE: stateJournal records storage values, bank balances and player/house
+-- items that changed since the last save into a local append-only file, so
+-- an unclean shutdown only loses up to stateJournalFlushInterval (ms) of
+-- item changes. The journal is applied to the database on the next startup.
+-- stateJournalMaxSize (in MB) triggers a full save when the journal outgrows it.
+stateJournal = false
+stateJournalFile = "data/journal/state.journal"
+stateJournalFlushInterval = 1000
+stateJournalMaxSize = 64
+
+-- Lua Profiler
+-- NOTE: luaProfiler starts measuring the time spent in every Lua callback at
+-- startup; it can also be toggled in-game with /luaprofile start|stop|dump.
+-- luaProfilerSampleInterval additionally samples Lua stacks every N
+-- instructions (0 disables sampling). Reports are written to
+-- luaProfilerOutput-<date>.txt with *.folded files for flamegraph tools.
+luaProfiler = false
+luaProfilerSampleInterval = 0
+luaProfilerOutput = "data/logs/luaprofile"
+
+-- Lua garbage collector
+-- NOTE: luaGcGovernor runs incremental collection steps of luaGcStepSize KB
+-- while the dispatcher has no tasks, so collection stays out of game ticks.
+-- luaGcPause and luaGcStepMultiplier tune the collector's own pacing, which
+-- remains as a backstop. luaGcMode "generational" needs Lua 5.4. Mode, pause
+-- and step multiplier only apply with luaGcGovernor enabled, otherwise the
+-- collector keeps the Lua defaults.
+-- /luaprofile gc shows a histogram of the governed collection times; steps
+-- the collector takes on its own during a task are not included.
+luaGcGovernor = true
+luaGcMode = "incremental"
+luaGcPause = 300
+luaGcStepMultiplier = 200
+luaGcStepSize = 64
+
+-- Lua bytecode cache
+-- NOTE: luaBytecodeCache keeps the compiled bytecode of every script so
+-- reloads and later startups skip parsing unchanged files. Entries are
+-- invalidated when a file's modification time and content change. The
+-- luaBytecodeCachePath directory must only be writable by the server.
+luaBytecodeCache = true
+luaBytecodeCachePath = "data/cache/luac"
+
+-- Script hot reload
+-- NOTE: scriptsHotReloadInterval (in seconds) polls data/scripts and reloads
+-- only the files that changed, swapping their actions, movements, spells,
+-- creaturescripts, talkactions and globalevents. /reload changed does the
+-- same on demand. 0 disables polling.
+scriptsHotReloadInterval = 0
+
+-- LuaJIT FFI bindings
+-- NOTE: luaFfiBindings replaces about 50 of the most called getters
+-- (creature:getHealth(), player:getLevel(), item:getId(), ...) with LuaJIT
+-- FFI calls that the JIT compiles into traces. It has no effect when the
+-- server is built with plain Lua. /luaprofile bench compares both paths.
+luaFfiBindings = true
+
 -- Experience stages
 -- NOTE: to use a flat experience multiplier, set experienceStages to nil
 -- minlevel and multiplier are MANDATORY
@@ -150,6 +219,11 @@ rateLoot = 2
 rateMagic = 3
 rateSpawn = 1
 
+-- Respawns
+-- maxSpawnsPerTick is how many monsters may respawn each second across the whole map,
+-- the spawns due after a server save are spread over the following seconds, 0 for no limit
+maxSpawnsPerTick = 100
+
 -- Monster Despawn Config
 -- despawnRange is the amount of floors a monster can be from its spawn position
 -- despawnRadius is how many tiles away it can be from its spawn position
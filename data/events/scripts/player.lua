@@ -58,6 +58,20 @@ function Player:onItemMoved(item, count, fromPosition, toPosition, fromCylinder,
 	end
 end
 
+-- Used instead of Player:onItemMoved when it is batched in events.xml,
+-- called once per dispatcher cycle with every move of that cycle.
+function Player.onItemMovedBatch(entries)
+	if not hasEvent.onItemMoved then
+		return
+	end
+
+	for _, entry in ipairs(entries) do
+		if entry.player:isPlayer() and entry.item:isItem() then
+			Event.onItemMoved(entry.player, entry.item, entry.count, entry.fromPosition, entry.toPosition, entry.fromCylinder, entry.toCylinder)
+		end
+	end
+end
+
 function Player:onMoveCreature(creature, fromPosition, toPosition)
 	if hasEvent.onMoveCreature then
 		return Event.onMoveCreature(self, creature, fromPosition, toPosition)
@@ -116,6 +130,19 @@ function Player:onGainExperience(source, exp, rawExp)
 	return hasEvent.onGainExperience and Event.onGainExperience(self, source, exp, rawExp) or exp
 end
 
+-- Batched variant: experience was already granted, return values are ignored.
+function Player.onGainExperienceBatch(entries)
+	if not hasEvent.onGainExperience then
+		return
+	end
+
+	for _, entry in ipairs(entries) do
+		if entry.player:isPlayer() then
+			Event.onGainExperience(entry.player, entry.source, entry.exp, entry.rawExp)
+		end
+	end
+end
+
 function Player:onLoseExperience(exp)
 	return hasEvent.onLoseExperience and Event.onLoseExperience(self, exp) or exp
 end
@@ -133,6 +160,20 @@ function Player:onGainSkillTries(skill, tries)
 	return hasEvent.onGainSkillTries and Event.onGainSkillTries(self, skill, tries) or tries
 end
 
+-- Batched variant: tries were already granted, so the skill rates of
+-- Player:onGainSkillTries are not applied and return values are ignored.
+function Player.onGainSkillTriesBatch(entries)
+	if not hasEvent.onGainSkillTries then
+		return
+	end
+
+	for _, entry in ipairs(entries) do
+		if entry.player:isPlayer() then
+			Event.onGainSkillTries(entry.player, entry.skill, entry.tries)
+		end
+	end
+end
+
 function Player:onWrapItem(item)
 	local topCylinder = item:getTopParent()
 	if not topCylinder then
@@ -176,6 +217,19 @@ function Player:onInventoryUpdate(item, slot, equip)
 	end
 end
 
+-- Batched variant, called once per dispatcher cycle.
+function Player.onInventoryUpdateBatch(entries)
+	if not hasEvent.onInventoryUpdate then
+		return
+	end
+
+	for _, entry in ipairs(entries) do
+		if entry.player:isPlayer() and entry.item:isItem() then
+			Event.onInventoryUpdate(entry.player, entry.item, entry.slot, entry.equip)
+		end
+	end
+end
+
 function Player:onNetworkMessage(recvByte, msg)
 	local handler = PacketHandlers[recvByte]
 	if not handler then
@@ -92,6 +92,25 @@ function getLootRandom()
 	return math.random(0, MAX_LOOTCHANCE) / configManager.getNumber(configKeys.RATE_LOOT)
 end
 
+-- Suspends the calling async function until condition() returns true.
+-- Returns false if timeout (ms) elapsed first.
+function waitUntil(condition, interval, timeout)
+	interval = interval or 100
+	local elapsed = 0
+	while not condition() do
+		if timeout and elapsed >= timeout then
+			return false
+		end
+
+		if wait(interval) == false then
+			-- not called from an async function
+			return false
+		end
+		elapsed = elapsed + interval
+	end
+	return true
+end
+
 table.contains = function(array, value)
 	for _, targetColumn in pairs(array) do
 		if targetColumn == value then
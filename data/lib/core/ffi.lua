@@ -0,0 +1,71 @@
+-- LuaJIT FFI fast path for the hottest getters, see src/luaffi.h.
+-- LuaFFI only exists when the server runs on LuaJIT with luaFfiBindings
+-- enabled; otherwise the regular bindings are kept.
+if type(LuaFFI) ~= "table" or type(jit) ~= "table" then
+	return
+end
+
+local ffi = require("ffi")
+
+ffi.cdef[[
+typedef struct {
+	uint16_t x;
+	uint16_t y;
+	uint8_t z;
+} LuaFfiPosition;
+]]
+
+local objectPointer = ffi.typeof("void* const*")
+local getterTypes = {
+	number = ffi.typeof("double (*)(const void*)"),
+	boolean = ffi.typeof("bool (*)(const void*)"),
+	position = ffi.typeof("void (*)(const void*, LuaFfiPosition*)")
+}
+
+local positionMetatable = LuaFFI.positionMetatable
+local positionOut = ffi.new("LuaFfiPosition")
+
+-- every wrapper returns nil for anything that is not a live object, like the
+-- regular bindings do for released objects and wrong arguments
+local function wrap(kind, getter)
+	if kind == "position" then
+		return function(self)
+			if type(self) ~= "userdata" then
+				return nil
+			end
+
+			local object = ffi.cast(objectPointer, self)[0]
+			if object == nil then
+				return nil
+			end
+
+			getter(object, positionOut)
+			return setmetatable({x = positionOut.x, y = positionOut.y, z = positionOut.z, stackpos = 0}, positionMetatable)
+		end
+	end
+
+	return function(self)
+		if type(self) ~= "userdata" then
+			return nil
+		end
+
+		local object = ffi.cast(objectPointer, self)[0]
+		if object == nil then
+			return nil
+		end
+		return getter(object)
+	end
+end
+
+-- the replaced C functions, kept for /luaprofile bench
+LuaFFI.original = LuaFFI.original or {}
+
+for _, binding in ipairs(LuaFFI.bindings) do
+	local class = rawget(_G, binding.className)
+	local original = class and rawget(class, binding.methodName)
+	if type(original) == "function" and debug.getinfo(original, "S").what == "C" then
+		local getter = ffi.cast(getterTypes[binding.kind], binding.pointer)
+		LuaFFI.original[binding.className .. "." .. binding.methodName] = original
+		rawset(class, binding.methodName, wrap(binding.kind, getter))
+	end
+end
@@ -0,0 +1,71 @@
+-- Micro-benchmark of the getters covered by the LuaJIT FFI bindings
+-- (data/lib/core/ffi.lua), used by /luaprofile bench. Every getter is timed
+-- through the regular C binding and, when LuaFFI replaced it, through the FFI
+-- path, so the same suite runs on plain Lua and on LuaJIT.
+
+local getterBenchmarkSuite = {
+	Creature = {
+		"getId", "getHealth", "getMaxHealth", "getSpeed", "getBaseSpeed", "getDirection", "getSkull", "getZone",
+		"isRemoved", "isInGhostMode", "isHealthHidden", "isMovementBlocked", "hasParent", "getPosition"
+	},
+	Player = {
+		"getGuid", "getAccountId", "getAccountType", "getLevel", "getExperience", "getMagicLevel", "getBaseMagicLevel",
+		"getMana", "getMaxMana", "getManaSpent", "getSoul", "getStamina", "getSex", "getCapacity", "getFreeCapacity",
+		"getBankBalance", "getSkullTime", "getIdleTime", "getLastLoginSaved", "getLastLogout", "isPzLocked"
+	},
+	Item = {
+		"getId", "getActionId", "getCount", "getCharges", "getFluidType", "getWeight", "getWorth", "getSubType",
+		"isLoadedFromMap", "isStoreItem", "hasParent", "getPosition"
+	}
+}
+
+local function timeGetter(getter, object, iterations)
+	local start = os.clock()
+	for _ = 1, iterations do
+		getter(object)
+	end
+	return (os.clock() - start) * 1e9 / iterations
+end
+
+-- Returns one line per getter with the ns/call of each path, and a total.
+function benchmarkGetters(player, iterations)
+	iterations = iterations or 100000
+
+	local item = Game.createItem(2160, 1)
+	local objects = {Creature = player, Player = player, Item = item}
+	local originals = LuaFFI and LuaFFI.original or {}
+
+	local lines = {string.format("%s, %d calls per getter (ns/call):", type(jit) == "table" and jit.version or _VERSION, iterations)}
+	local totalC, ffiBaseline, totalFfi, ffiGetters = 0, 0, 0, 0
+	for _, className in ipairs({"Creature", "Player", "Item"}) do
+		local class = _G[className]
+		for _, methodName in ipairs(getterBenchmarkSuite[className]) do
+			local current = class[methodName]
+			local original = originals[className .. "." .. methodName]
+			local object = objects[className]
+
+			local c = timeGetter(original or current, object, iterations)
+			totalC = totalC + c
+			if original then
+				local ffiTime = timeGetter(current, object, iterations)
+				totalFfi = totalFfi + ffiTime
+				ffiBaseline = ffiBaseline + c
+				ffiGetters = ffiGetters + 1
+				lines[#lines + 1] = string.format("%s.%s: C %.1f, FFI %.1f", className, methodName, c, ffiTime)
+			else
+				lines[#lines + 1] = string.format("%s.%s: C %.1f", className, methodName, c)
+			end
+		end
+	end
+
+	if ffiGetters > 0 then
+		lines[#lines + 1] = string.format("Total: C %.1f, FFI %.1f over the %d getters on the FFI path", ffiBaseline, totalFfi, ffiGetters)
+	else
+		lines[#lines + 1] = string.format("Total: C %.1f (FFI bindings not active)", totalC)
+	end
+
+	if item then
+		item:remove()
+	end
+	return lines
+end
@@ -12,6 +12,7 @@ dofile('data/lib/core/core.lua')
 -- Debugging helper function for Lua developers
 dofile('data/lib/debugging/dump.lua')
 dofile('data/lib/debugging/lua_version.lua')
+dofile('data/lib/debugging/getter_benchmark.lua')
 
 -- Serialization helpers
 dofile('data/lib/serialization.lua')
@@ -1,4 +1,5 @@
 function onUpdateDatabase()
-    print('[Migration] 40.lua: stopping migration loop (no further updates in snapshot)')
-    return false
+    print('[Migration] 40.lua: adding prefix length to ip bans')
+    db.query("ALTER TABLE `ip_bans` ADD `prefix_length` TINYINT UNSIGNED NOT NULL DEFAULT 0 AFTER `ip`")
+    return true
 end
@@ -0,0 +1,4 @@
+function onUpdateDatabase()
+    print('[Migration] 41.lua: stopping migration loop (no further updates in snapshot)')
+    return false
+end
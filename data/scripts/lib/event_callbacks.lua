@@ -99,7 +99,9 @@ local function register(self, triggerIndex)
 	events.maxn = #events + 1
 	events[events.maxn] = {
 		callback = callback,
-		triggerIndex = tonumber(triggerIndex) or 0
+		triggerIndex = tonumber(triggerIndex) or 0,
+		-- the file that registered it, see Event:unregisterFile
+		source = debug.getinfo(2, "S").source
 	}
  
 	table.sort(events, function(ecl, ecr) return ecl.triggerIndex < ecr.triggerIndex end)
@@ -114,6 +116,21 @@ Event = setmetatable({
 		for i = 1, autoID do
 			EventData[i] = {maxn = 0}
 		end
+	end,
+
+	-- drops the callbacks a script file registered, it is run again when reloaded on its own
+	unregisterFile = function(self, file)
+		local source = "@" .. file
+		for i = 1, autoID do
+			local events, kept = EventData[i], {}
+			for index = 1, events.maxn do
+				if events[index].source ~= source then
+					kept[#kept + 1] = events[index]
+				end
+			end
+			kept.maxn = #kept
+			EventData[i] = kept
+		end
 	end
 }, {
 	__call = function(self)
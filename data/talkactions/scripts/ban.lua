@@ -36,6 +36,7 @@ function onSay(player, words, param)
 		"VALUES (%d, %s, %d, %d, %d)",
 		accountId, db.escapeString(banReason), currentTime, expirationTime, player:getGuid()
 	))
+	Game.reload(RELOAD_TYPE_BANS)
 
 	local target = Player(targetName)
 	if target then
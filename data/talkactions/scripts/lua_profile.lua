@@ -0,0 +1,59 @@
+function onSay(player, words, param)
+	if not player:getGroup():getAccess() then
+		return true
+	end
+
+	if player:getAccountType() < ACCOUNT_TYPE_GOD then
+		return false
+	end
+
+	local split = param:split(" ")
+	local action = split[1] and split[1]:lower() or ""
+	if action == "start" then
+		local sampleInterval = tonumber(split[2])
+		Game.startLuaProfiler(sampleInterval)
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profiler started" .. (sampleInterval and sampleInterval > 0 and (", sampling every " .. sampleInterval .. " instructions") or "") .. ".")
+	elseif action == "stop" then
+		if Game.stopLuaProfiler() then
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profiler stopped.")
+		else
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profiler is not running.")
+		end
+	elseif action == "dump" then
+		local path = Game.dumpLuaProfile()
+		if path then
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profile written to " .. path .. ".*")
+		else
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Unable to write the Lua profile, check the console.")
+		end
+	elseif action == "gc" then
+		local stats = Game.getLuaGcStats()
+		local lines = {string.format("Lua heap %d KB, %d cycles completed while idle, %d KB freed inside tasks.", stats.memoryKb, stats.idleCycles, stats.inTaskFreedKb)}
+		for _, kind in ipairs({"idleSteps", "fullCollections", "inTaskCollections"}) do
+			local histogram = stats[kind]
+			local buckets = {}
+			for _, bucket in ipairs(histogram.buckets) do
+				if bucket.count > 0 then
+					buckets[#buckets + 1] = string.format("%s%d", bucket.limitUs > 0 and ("<" .. bucket.limitUs .. "us: ") or ">=10ms: ", bucket.count)
+				end
+			end
+			lines[#lines + 1] = string.format("%s: %d, %.1f ms total, max %d us [%s]", kind, histogram.count, histogram.totalMs, histogram.maxUs, table.concat(buckets, ", "))
+		end
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, table.concat(lines, "\n"))
+	elseif action == "events" then
+		local stats = Game.getEventDispatchStats()
+		local seconds = math.max(stats.seconds, 1)
+		local lines = {string.format("Event dispatch over the last %d seconds:", stats.seconds)}
+		for _, event in ipairs(stats.events) do
+			lines[#lines + 1] = string.format("%s%s: %.1f events/s, %.1f Lua calls/s", event.name, event.batched and " (batched)" or "", event.events / seconds, event.luaCalls / seconds)
+		end
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, table.concat(lines, "\n"))
+	elseif action == "bench" then
+		local lines = benchmarkGetters(player, tonumber(split[2]))
+		print(table.concat(lines, "\n"))
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, lines[1] .. "\n" .. lines[#lines] .. "\nFull results printed to the console.")
+	else
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Usage: " .. words .. " start [sampleInterval] | stop | dump | gc | events | bench [iterations]")
+	end
+	return false
+end
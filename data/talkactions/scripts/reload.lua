@@ -4,6 +4,11 @@ local reloadTypes = {
 	["action"] = RELOAD_TYPE_ACTIONS,
 	["actions"] = RELOAD_TYPE_ACTIONS,
 
+	["ban"] = RELOAD_TYPE_BANS,
+	["bans"] = RELOAD_TYPE_BANS,
+
+	["changed"] = RELOAD_TYPE_CHANGED_SCRIPTS,
+
 	["chat"] = RELOAD_TYPE_CHAT,
 	["channel"] = RELOAD_TYPE_CHAT,
 	["chatchannels"] = RELOAD_TYPE_CHAT,
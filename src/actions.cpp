@@ -44,6 +44,18 @@ void Actions::clear(bool fromLua) {
 	reInitState(fromLua);
 }
 
+void Actions::removeScriptEvents(ScriptEventSet& events) {
+	for (ActionUseMap* map : {&useItemMap, &uniqueItemMap, &actionItemMap}) {
+		for (auto it = map->begin(); it != map->end();) {
+			if (events.claim(it->second)) {
+				it = map->erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+}
+
 LuaScriptInterface& Actions::getScriptInterface() {
 	return scriptInterface;
 }
@@ -534,8 +546,7 @@ bool Action::executeUse(Player* player, Item* item, const Position& fromPosition
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	lua::pushThing(L, item);
 	lua::pushPosition(L, fromPosition);
@@ -81,6 +81,7 @@ class Actions final : public BaseEvents {
 
 		bool registerLuaEvent(Action* event);
 		void clear(bool fromLua) override final;
+		void removeScriptEvents(ScriptEventSet& events);
 
 		bool isValid(std::map<Action*, std::vector<uint16_t>> map, Action* action) {
 			return map.find(action) != map.end();
@@ -5,67 +5,188 @@
 
 #include "ban.h"
 
+#include "configmanager.h"
 #include "connection.h"
 #include "database.h"
 #include "databasetasks.h"
+#include "scheduler.h"
 
-namespace IOBan {
-	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId) {
-		Database& db = Database::getInstance();
+namespace {
 
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, `banned_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans` WHERE `account_id` = {:d}", accountId));
-		if (!result) {
-			return std::nullopt;
+	struct BanEntry {
+		std::string address; // as stored, ip bans only
+		std::string bannedBy;
+		std::string reason;
+		time_t bannedAt;
+		time_t expiresAt;
+		uint32_t bannedById;
+	};
+
+	// IP bans are grouped by prefix length and keyed by the masked address,
+	// longest prefixes first; a prefix length of 0 bans the whole address
+	using IpBanMap = std::map<uint8_t, std::unordered_map<std::string, BanEntry>, std::greater<>>;
+
+	std::mutex banLock;
+	std::unordered_map<uint32_t, BanEntry> accountBans;
+	IpBanMap ipBans;
+
+	std::string getAddressBytes(const Connection::Address& address) {
+		if (address.is_v6()) {
+			const auto& v6 = address.to_v6();
+			if (!v6.is_v4_mapped()) {
+				const auto bytes = v6.to_bytes();
+				return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+			}
+			return getAddressBytes(boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, v6));
 		}
 
-		int64_t expiresAt = result->getNumber<int64_t>("expires_at");
-		if (expiresAt != 0 && time(nullptr) > expiresAt) {
-			// Move the ban to history if it has expired
-			g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt, result->getNumber<uint32_t>("banned_by")));
-			g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
-			return std::nullopt;
+		const auto bytes = address.to_v4().to_bytes();
+		return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+	}
+
+	std::string maskAddress(std::string address, uint8_t prefixLength) {
+		if (prefixLength == 0 || prefixLength >= address.size() * 8) {
+			return address;
+		}
+
+		size_t byte = prefixLength / 8;
+		if (uint8_t bits = prefixLength % 8; bits != 0) {
+			address[byte] &= static_cast<char>(0xFF << (8 - bits));
+			++byte;
 		}
+		std::fill(address.begin() + byte, address.end(), '\0');
+		return address;
+	}
+
+	BanEntry readBanEntry(const DBResult_ptr& result) {
+		BanEntry entry;
+		entry.bannedBy = result->getString("name");
+		entry.reason = result->getString("reason");
+		entry.bannedAt = result->getNumber<time_t>("banned_at");
+		entry.expiresAt = result->getNumber<time_t>("expires_at");
+		entry.bannedById = result->getNumber<uint32_t>("banned_by");
+		return entry;
+	}
+
+	std::optional<IOBan::BanInfo> toBanInfo(const BanEntry& entry) {
+		auto banInfo = std::make_optional<IOBan::BanInfo>();
+		banInfo->expiresAt = entry.expiresAt;
 
-		auto banInfo = std::make_optional<BanInfo>();
-		banInfo->expiresAt = expiresAt;
-	 
-		banInfo->reason = result->getString("reason");
+		banInfo->reason = entry.reason;
 		if (banInfo->reason.empty()) {
 			banInfo->reason = "(none)";
 		}
-	 
-		banInfo->bannedBy = result->getString("name");
+
+		banInfo->bannedBy = entry.bannedBy;
 		return banInfo;
 	}
 
-	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP) {
-		if (clientIP.is_unspecified()) {
-			return std::nullopt;
+	bool isExpired(const BanEntry& entry) {
+		return entry.expiresAt != 0 && time(nullptr) > entry.expiresAt;
+	}
+
+	void setAccountBans(DBResult_ptr result, bool) {
+		std::unordered_map<uint32_t, BanEntry> bans;
+		if (result) {
+			do {
+				bans.emplace(result->getNumber<uint32_t>("account_id"), readBanEntry(result));
+			} while (result->next());
+		}
+
+		std::lock_guard<std::mutex> lockGuard(banLock);
+		accountBans = std::move(bans);
+	}
+
+	void setIpBans(DBResult_ptr result, bool) {
+		IpBanMap bans;
+		if (result) {
+			do {
+				BanEntry entry = readBanEntry(result);
+				entry.address = result->getString("ip");
+
+				uint8_t prefixLength = result->getNumber<uint16_t>("prefix_length");
+				bans[prefixLength].emplace(maskAddress(entry.address, prefixLength), std::move(entry));
+			} while (result->next());
 		}
 
+		std::lock_guard<std::mutex> lockGuard(banLock);
+		ipBans = std::move(bans);
+	}
+
+	constexpr auto ACCOUNT_BANS_QUERY = "SELECT `account_id`, `reason`, `banned_at`, `expires_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans`";
+	constexpr auto IP_BANS_QUERY = "SELECT `ip`, `prefix_length`, `reason`, `banned_at`, `expires_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans`";
+
+	void scheduleRefresh() {
+		int32_t refreshInterval = getNumber(ConfigManager::BAN_REFRESH_INTERVAL);
+		if (refreshInterval <= 0) {
+			return;
+		}
+
+		g_scheduler.addEvent(createSchedulerTask(refreshInterval * 1000, []() {
+			IOBan::reloadBans();
+			scheduleRefresh();
+		}));
+	}
+
+} // namespace
+
+namespace IOBan {
+	void loadBans() {
 		Database& db = Database::getInstance();
+		setAccountBans(db.storeQuery(ACCOUNT_BANS_QUERY), true);
+		setIpBans(db.storeQuery(IP_BANS_QUERY), true);
+		scheduleRefresh();
+	}
+
+	void reloadBans() {
+		g_databaseTasks.addTask(ACCOUNT_BANS_QUERY, setAccountBans, true);
+		g_databaseTasks.addTask(IP_BANS_QUERY, setIpBans, true);
+	}
+
+	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId) {
+		std::lock_guard<std::mutex> lockGuard(banLock);
 
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `reason`, `expires_at`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
-		if (!result) {
+		auto it = accountBans.find(accountId);
+		if (it == accountBans.end()) {
 			return std::nullopt;
 		}
 
-		int64_t expiresAt = result->getNumber<int64_t>("expires_at");
-		if (expiresAt != 0 && time(nullptr) > expiresAt) {
-			g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = INET6_ATON('{:s}')", clientIP.to_string()));
+		const BanEntry& entry = it->second;
+		if (isExpired(entry)) {
+			// Move the ban to history if it has expired
+			Database& db = Database::getInstance();
+			g_databaseTasks.addTask(fmt::format("INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})", accountId, db.escapeString(entry.reason), entry.bannedAt, entry.expiresAt, entry.bannedById));
+			g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+			accountBans.erase(it);
 			return std::nullopt;
 		}
+		return toBanInfo(entry);
+	}
 
-		auto banInfo = std::make_optional<BanInfo>();
-		banInfo->expiresAt = expiresAt;
-	 
-		banInfo->reason = result->getString("reason");
-		if (banInfo->reason.empty()) {
-			banInfo->reason = "(none)";
+	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP) {
+		if (clientIP.is_unspecified()) {
+			return std::nullopt;
 		}
-	 
-		banInfo->bannedBy = result->getString("name");
-		return banInfo;
+
+		const std::string address = getAddressBytes(clientIP);
+
+		std::lock_guard<std::mutex> lockGuard(banLock);
+		for (auto& [prefixLength, bans] : ipBans) {
+			auto it = bans.find(maskAddress(address, prefixLength));
+			if (it == bans.end()) {
+				continue;
+			}
+
+			const BanEntry& entry = it->second;
+			if (isExpired(entry)) {
+				Database& db = Database::getInstance();
+				g_databaseTasks.addTask(fmt::format("DELETE FROM `ip_bans` WHERE `ip` = {:s} AND `prefix_length` = {:d}", db.escapeString(entry.address), prefixLength));
+				bans.erase(it);
+				continue;
+			}
+			return toBanInfo(entry);
+		}
+		return std::nullopt;
 	}
 
 	bool isPlayerNamelocked(uint32_t playerId) {
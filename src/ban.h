@@ -14,6 +14,18 @@ namespace IOBan {
 		time_t expiresAt;
 	};
 
+	/**
+	 * Loads every account and IP ban into memory and schedules the periodic
+	 * refresh (banRefreshInterval). Lookups never touch the database after this.
+	 */
+	void loadBans();
+
+	/**
+	 * Refreshes the in-memory bans behind every query already queued on the
+	 * database task queue, e.g. right after a ban was issued or lifted.
+	 */
+	void reloadBans();
+
 	const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId);
 	const std::optional<BanInfo> getIpBanInfo(const Connection::Address& clientIP);
 	bool isPlayerNamelocked(uint32_t playerId);
@@ -147,6 +147,15 @@ bool Event::loadCallback() {
 	return true;
 }
 
+bool ScriptEventSet::claim(const Event& event) {
+	if (!event.fromLua || event.scriptInterface != interface || scriptIds.find(event.scriptId) == scriptIds.end()) {
+		return false;
+	}
+
+	removedIds.insert(event.scriptId);
+	return true;
+}
+
 bool CallBack::loadCallBack(LuaScriptInterface* interface, const std::string& name) {
 	if (!interface) {
 		std::cout << "Failure: [CallBack::loadCallBack] scriptInterface == nullptr" << std::endl;
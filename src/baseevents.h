@@ -39,6 +39,32 @@ class Event {
 
 		int32_t scriptId = 0;
 		LuaScriptInterface* scriptInterface = nullptr;
+
+		friend class ScriptEventSet;
+};
+
+/**
+ * The event functions one script file registered, used to take its events out
+ * of the registries when only that file is reloaded.
+ */
+class ScriptEventSet {
+	public:
+		ScriptEventSet(const LuaScriptInterface* interface, std::set<int32_t> scriptIds) :
+			interface(interface), scriptIds(std::move(scriptIds)) {}
+
+		/**
+		 * @return true if the event was registered by the file, its id is then reported by getRemovedIds
+		 */
+		bool claim(const Event& event);
+
+		const std::set<int32_t>& getRemovedIds() const {
+			return removedIds;
+		}
+
+	private:
+		const LuaScriptInterface* interface;
+		std::set<int32_t> scriptIds;
+		std::set<int32_t> removedIds;
 };
 
 class BaseEvents {
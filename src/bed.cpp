@@ -24,7 +24,7 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream) {
 				return ATTR_READ_ERROR;
 			}
 
-			if (guid != 0) {
+			if (guid != 0 && !DetachedItemLoad::defer()) {
 				std::string name = IOLoginData::getNameByGuid(guid);
 				if (!name.empty()) {
 					setSpecialDescription(name + " is sleeping there.");
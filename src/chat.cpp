@@ -144,8 +144,7 @@ bool ChatChannel::executeCanJoinEvent(const Player& player) {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(canJoinEvent);
-	lua::pushUserdata(L, &player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, &player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -168,8 +167,7 @@ bool ChatChannel::executeOnJoinEvent(const Player& player) {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(onJoinEvent);
-	lua::pushUserdata(L, &player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, &player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -192,8 +190,7 @@ bool ChatChannel::executeOnLeaveEvent(const Player& player) {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(onLeaveEvent);
-	lua::pushUserdata(L, &player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, &player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -216,8 +213,7 @@ bool ChatChannel::executeOnSpeakEvent(const Player& player, SpeakClasses& type,
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(onSpeakEvent);
-	lua::pushUserdata(L, &player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, &player);
 
 	lua_pushnumber(L, type);
 	lua::pushString(L, message);
@@ -8,57 +8,57 @@
 #include "configmanager.h"
 #include "events.h"
 #include "game/game.h"
-#include "matrixarea.h"
 #include "scripting/LuaErrorWrap.h"
 #include "spectators.h"
 #include "weapons.h"
 
+#include <boost/container/small_vector.hpp>
+
 extern Game g_game;
 extern Weapons* g_weapons;
 
-std::vector<Tile*> getList(const MatrixArea& area, const Position& targetPos, const Direction dir) {
-	auto casterPos = getNextPosition(dir, targetPos);
-
-	std::vector<Tile*> vec;
+namespace {
 
-	auto center = area.getCenter();
+// tiles of a single area combat, inline for all but the largest areas
+using CombatTiles = boost::container::small_vector<Tile*, 64>;
 
-	Position tmpPos(targetPos.x - center.first, targetPos.y - center.second, targetPos.z);
-	for (uint32_t row = 0; row < area.getRows(); ++row, ++tmpPos.y) {
-		for (uint32_t col = 0; col < area.getCols(); ++col, ++tmpPos.x) {
-			if (area(row, col)) {
-				if (g_game.isSightClear(casterPos, tmpPos, true)) {
-					Tile* tile = g_game.map.getTile(tmpPos);
-					if (!tile) {
-						tile = new StaticTile(tmpPos.x, tmpPos.y, tmpPos.z);
-						g_game.map.setTile(tmpPos, tile);
-					}
-					vec.push_back(tile);
-				}
-			}
-		}
-		tmpPos.x -= area.getCols();
+Tile* getOrCreateTile(const Position& pos) {
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		tile = new StaticTile(pos.x, pos.y, pos.z);
+		g_game.map.setTile(pos, tile);
 	}
-	return vec;
+	return tile;
 }
 
-std::vector<Tile*> getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area) {
+/**
+ * Fills tiles with the tiles of the area in sight of the caster.
+ *
+ * @return the largest distance of an area tile from the target position, to size the spectator range
+ */
+std::pair<int32_t, int32_t> getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, CombatTiles& tiles) {
 	if (targetPos.z >= MAP_MAX_LAYERS) {
-		return {};
+		return {0, 0};
 	}
 
-	if (area) {
-		return getList(area->getArea(centerPos, targetPos), targetPos, getDirectionTo(targetPos, centerPos));
+	if (!area) {
+		tiles.push_back(getOrCreateTile(targetPos));
+		return {0, 0};
 	}
 
-	Tile* tile = g_game.map.getTile(targetPos);
-	if (!tile) {
-		tile = new StaticTile(targetPos.x, targetPos.y, targetPos.z);
-		g_game.map.setTile(targetPos, tile);
+	const AreaOffsets& offsets = area->getArea(centerPos, targetPos);
+	const Position casterPos = getNextPosition(getDirectionTo(targetPos, centerPos), targetPos);
+	for (auto&& [x, y] : offsets.offsets) {
+		const Position tilePos(targetPos.x + x, targetPos.y + y, targetPos.z);
+		if (g_game.isSightClear(casterPos, tilePos, true)) {
+			tiles.push_back(getOrCreateTile(tilePos));
+		}
 	}
-	return {tile};
+	return {offsets.maxX, offsets.maxY};
 }
 
+} // namespace
+
 CombatDamage Combat::getCombatDamage(Creature* creature, Creature* target) const {
 	CombatDamage damage;
 	damage.origin = params.origin;
@@ -219,7 +219,7 @@ ReturnValue Combat::canTargetCreature(Player* attacker, Creature* target) {
 }
 
 ReturnValue Combat::canDoCombat(Creature* caster, Tile* tile, bool aggressive) {
-	if (tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+	if (tile->hasFlag(TILESTATE_BLOCKPROJECTILE)) {
 		return RETURNVALUE_NOTENOUGHROOM;
 	}
 
@@ -688,20 +688,10 @@ void Combat::doCombat(Creature* caster, const Position& position) const {
 		CombatDamage damage = getCombatDamage(caster, nullptr);
 		doAreaCombat(caster, position, area.get(), damage, params);
 	} else {
-		auto tiles = caster ? getCombatArea(caster->getPosition(), position, area.get()) : getCombatArea(position, position, area.get());
+		CombatTiles tiles;
+		auto [maxX, maxY] = getCombatArea(caster ? caster->getPosition() : position, position, area.get(), tiles);
 
 		SpectatorVec spectators;
-		int32_t maxX = 0;
-		int32_t maxY = 0;
-
-		//calculate the max viewable range
-		for (Tile* tile : tiles) {
-			const Position& tilePos = tile->getPosition();
-
-			maxX = std::max(maxX, tilePos.getDistanceX(position));
-			maxY = std::max(maxY, tilePos.getDistanceY(position));
-		}
-
 		const int32_t rangeX = maxX + Map::maxViewportX;
 		const int32_t rangeY = maxY + Map::maxViewportY;
 		g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
@@ -857,7 +847,8 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 }
 
 void Combat::doAreaCombat(Creature* caster, const Position& position, const AreaCombat* area, CombatDamage& damage, const CombatParams& params) {
-	auto tiles = caster ? getCombatArea(caster->getPosition(), position, area) : getCombatArea(position, position, area);
+	CombatTiles tiles;
+	auto [maxX, maxY] = getCombatArea(caster ? caster->getPosition() : position, position, area, tiles);
 
 	Player* casterPlayer = caster ? caster->getPlayer() : nullptr;
 	int32_t criticalPrimary = 0;
@@ -872,17 +863,6 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 		}
 	}
 
-	int32_t maxX = 0;
-	int32_t maxY = 0;
-
-	//calculate the max viewable range
-	for (Tile* tile : tiles) {
-		const Position& tilePos = tile->getPosition();
-
-		maxX = std::max(maxX, tilePos.getDistanceX(position));
-		maxY = std::max(maxY, tilePos.getDistanceY(position));
-	}
-
 	const int32_t rangeX = maxX + Map::maxViewportX;
 	const int32_t rangeY = maxY + Map::maxViewportY;
 
@@ -944,7 +924,7 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 		if (damageCopy.critical) {
 			damageCopy.primary.value += playerCombatReduced ? criticalPrimary / 2 : criticalPrimary;
 			damageCopy.secondary.value += playerCombatReduced ? criticalSecondary / 2 : criticalSecondary;
-			g_game.addMagicEffect(creature->getPosition(), CONST_ME_CRITICAL_DAMAGE);
+			Game::addMagicEffect(spectators, creature->getPosition(), CONST_ME_CRITICAL_DAMAGE);
 		}
 
 		bool success = false;
@@ -952,7 +932,9 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			if (g_game.combatBlockHit(damageCopy, caster, creature, params.blockedByShield, params.blockedByArmor, params.itemId != 0, params.ignoreResistances)) {
 				continue;
 			}
-			success = g_game.combatChangeHealth(caster, creature, damageCopy);
+			// scripts of the targets hit before may have moved this one out of the area
+			const bool inArea = creature->getPosition().isInRange(position, maxX, maxY, 0);
+			success = g_game.combatChangeHealth(caster, creature, damageCopy, inArea ? &spectators : nullptr);
 		} else {
 			success = g_game.combatChangeMana(caster, creature, damageCopy);
 		}
@@ -1030,8 +1012,7 @@ void ValueCallback::getMinMaxValues(Player* player, CombatDamage& damage) const
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	int parameters = 1;
 	switch (type) {
@@ -1111,8 +1092,7 @@ void TileCallback::onTileCombat(Creature* creature, Tile* tile) const {
 
 	scriptInterface->pushFunction(scriptId);
 	if (creature) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -1141,15 +1121,13 @@ void TargetCallback::onTargetCombat(Creature* creature, Creature* target) const
 	scriptInterface->pushFunction(scriptId);
 
 	if (creature) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
 
 	if (target) {
-		lua::pushUserdata(L, target);
-		lua::setCreatureMetatable(L, -1, target);
+		lua::pushCreature(L, target);
 	} else {
 		lua_pushnil(L);
 	}
@@ -1169,7 +1147,7 @@ void TargetCallback::onTargetCombat(Creature* creature, Creature* target) const
 
 //**********************************************************//
 
-const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position& targetPos) const {
+const AreaOffsets& AreaCombat::getArea(const Position& centerPos, const Position& targetPos) const {
 	int32_t dx = targetPos.getOffsetX(centerPos);
 	int32_t dy = targetPos.getOffsetY(centerPos);
 
@@ -1198,7 +1176,7 @@ const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position&
 
 	if (dir >= areas.size()) {
 		// this should not happen. it means we forgot to call setupArea.
-		static MatrixArea empty;
+		static AreaOffsets empty;
 		return empty;
 	}
 	return areas[dir];
@@ -1210,10 +1188,10 @@ void AreaCombat::setupArea(const std::vector<uint32_t>& vec, uint32_t rows) {
 		areas.resize(4);
 	}
 
-	areas[DIRECTION_EAST] = area.rotate90();
-	areas[DIRECTION_SOUTH] = area.rotate180();
-	areas[DIRECTION_WEST] = area.rotate270();
-	areas[DIRECTION_NORTH] = std::move(area);
+	areas[DIRECTION_EAST] = createAreaOffsets(area.rotate90());
+	areas[DIRECTION_SOUTH] = createAreaOffsets(area.rotate180());
+	areas[DIRECTION_WEST] = createAreaOffsets(area.rotate270());
+	areas[DIRECTION_NORTH] = createAreaOffsets(area);
 }
 
 void AreaCombat::setupArea(int32_t length, int32_t spread) {
@@ -1324,10 +1302,10 @@ void AreaCombat::setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows) {
 	hasExtArea = true;
 	auto area = createArea(vec, rows);
 	areas.resize(8);
-	areas[DIRECTION_NORTHEAST] = area.rotate90();
-	areas[DIRECTION_SOUTHEAST] = area.rotate180();
-	areas[DIRECTION_SOUTHWEST] = area.rotate270();
-	areas[DIRECTION_NORTHWEST] = std::move(area);
+	areas[DIRECTION_NORTHEAST] = createAreaOffsets(area.rotate90());
+	areas[DIRECTION_SOUTHEAST] = createAreaOffsets(area.rotate180());
+	areas[DIRECTION_SOUTHWEST] = createAreaOffsets(area.rotate270());
+	areas[DIRECTION_NORTHWEST] = createAreaOffsets(area);
 }
 
 //**********************************************************//
@@ -7,10 +7,10 @@
 #include "baseevents.h"
 #include "condition.h"
 #include "item.h"
+#include "matrixarea.h"
 #include "tools.h"
 
 class Creature;
-class MatrixArea;
 class Player;
 class SpectatorVec;
 class Tile;
@@ -68,10 +68,11 @@ class AreaCombat {
 		void setupArea(int32_t radius);
 		void setupAreaRing(int32_t ring);
 		void setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows);
-		const MatrixArea& getArea(const Position& centerPos, const Position& targetPos) const;
+		const AreaOffsets& getArea(const Position& centerPos, const Position& targetPos) const;
 
 	private:
-		std::vector<MatrixArea> areas;
+		// the area of each direction, rotated once at setup
+		std::vector<AreaOffsets> areas;
 		bool hasExtArea = false;
 };
 
@@ -0,0 +1,167 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_CONDITIONLIST_H
+#define FS_CONDITIONLIST_H
+
+#include "condition.h"
+
+#include <boost/container/small_vector.hpp>
+
+/**
+ * Conditions of a creature, stored inline for the usual handful of them.
+ *
+ * Creature::executeConditions walks the list while conditions run scripts
+ * that may remove any condition. While such a walk is running, erased
+ * entries are only cleared and the list is compacted once the walk ends, so
+ * indices stay stable and the walk needs no copy of the list. Iterators skip
+ * the cleared entries; an iterator is equal to end() as soon as it is past
+ * the last entry, so loops keeping a copy of end() survive an erase.
+ *
+ * A mask of the ConditionType_t present answers most lookups without a scan.
+ */
+class ConditionList {
+	public:
+		class iterator {
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = Condition*;
+				using difference_type = std::ptrdiff_t;
+				using pointer = Condition* const*;
+				using reference = Condition* const&;
+
+				iterator() = default;
+				iterator(const ConditionList* list, size_t index) : list(list), index(index) {
+					skipCleared();
+				}
+
+				reference operator*() const {
+					return list->entries[index];
+				}
+
+				iterator& operator++() {
+					++index;
+					skipCleared();
+					return *this;
+				}
+				iterator operator++(int) {
+					iterator it = *this;
+					++(*this);
+					return it;
+				}
+
+				bool operator==(const iterator& other) const {
+					return index == other.index || (atEnd() && other.atEnd());
+				}
+
+			private:
+				bool atEnd() const {
+					return !list || index >= list->entries.size();
+				}
+
+				void skipCleared() {
+					while (!atEnd() && !list->entries[index]) {
+						++index;
+					}
+				}
+
+				const ConditionList* list = nullptr;
+				size_t index = 0;
+
+				friend class ConditionList;
+		};
+		using const_iterator = iterator;
+
+		iterator begin() const {
+			return {this, 0};
+		}
+		iterator end() const {
+			return {this, entries.size()};
+		}
+
+		bool empty() const {
+			return count == 0;
+		}
+		size_t size() const {
+			return count;
+		}
+
+		void push_back(Condition* condition) {
+			entries.push_back(condition);
+			types |= condition->getType();
+			++count;
+		}
+
+		/**
+		 * @return the iterator following the erased condition
+		 */
+		iterator erase(iterator it) {
+			if (walking != 0) {
+				entries[it.index] = nullptr;
+				hasCleared = true;
+			} else {
+				entries.erase(entries.begin() + it.index);
+			}
+
+			--count;
+			updateTypes();
+			return {this, it.index};
+		}
+
+		/**
+		 * @return false if the condition is not in the list
+		 */
+		bool remove(Condition* condition) {
+			auto it = std::find(begin(), end(), condition);
+			if (it == end()) {
+				return false;
+			}
+
+			erase(it);
+			return true;
+		}
+
+		bool hasType(ConditionType_t type) const {
+			return (types & type) != 0;
+		}
+
+		/**
+		 * Calls fn(condition) for every condition present when the walk
+		 * starts and still present when its turn comes. Conditions added
+		 * meanwhile are left for the next walk.
+		 */
+		template <typename Fn>
+		void walk(Fn&& fn) {
+			const size_t walkSize = entries.size();
+			++walking;
+			for (size_t i = 0; i < walkSize; ++i) {
+				if (Condition* condition = entries[i]) {
+					fn(condition);
+				}
+			}
+
+			if (--walking == 0 && hasCleared) {
+				entries.erase(std::remove(entries.begin(), entries.end(), nullptr), entries.end());
+				hasCleared = false;
+			}
+		}
+
+	private:
+		void updateTypes() {
+			types = 0;
+			for (Condition* condition : entries) {
+				if (condition) {
+					types |= condition->getType();
+				}
+			}
+		}
+
+		boost::container::small_vector<Condition*, 4> entries;
+		// bitwise or of the ConditionType_t present
+		uint32_t types = 0;
+		uint32_t count = 0;
+		uint16_t walking = 0;
+		bool hasCleared = false;
+};
+
+#endif // FS_CONDITIONLIST_H
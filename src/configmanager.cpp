@@ -195,6 +195,9 @@ bool ConfigManager::load() {
 		integer[STATUS_PORT] = getGlobalNumber(L, "statusProtocolPort", 7171);
 
 		integer[MARKET_OFFER_DURATION] = getGlobalNumber(L, "marketOfferDuration", 30 * 24 * 60 * 60);
+
+		boolean[STATE_JOURNAL] = getGlobalBoolean(L, "stateJournal", false);
+		string[STATE_JOURNAL_FILE] = getGlobalString(L, "stateJournalFile", "data/journal/state.journal");
 	}
 
 	boolean[ALLOW_CHANGEOUTFIT] = getGlobalBoolean(L, "allowChangeOutfit", true);
@@ -237,6 +240,10 @@ bool ConfigManager::load() {
         boolean[ENABLE_REPUTATION_SYSTEM] = getGlobalBoolean(L, "enableReputationSystem", true);
         boolean[ENABLE_ECONOMY_SYSTEM] = getGlobalBoolean(L, "enableEconomySystem", true);
         boolean[ENABLE_MONSTER_RANK_SYSTEM] = getGlobalBoolean(L, "enableMonsterRankSystem", true);
+	boolean[LUA_PROFILER] = getGlobalBoolean(L, "luaProfiler", false);
+	boolean[LUA_BYTECODE_CACHE] = getGlobalBoolean(L, "luaBytecodeCache", true);
+	boolean[LUA_GC_GOVERNOR] = getGlobalBoolean(L, "luaGcGovernor", true);
+	boolean[LUA_FFI_BINDINGS] = getGlobalBoolean(L, "luaFfiBindings", true);
 
         string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	string[SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -246,6 +253,9 @@ bool ConfigManager::load() {
 	string[LOCATION] = getGlobalString(L, "location", "");
 	string[MOTD] = getGlobalString(L, "motd", "");
 	string[WORLD_TYPE] = getGlobalString(L, "worldType", "pvp");
+	string[LUA_PROFILER_OUTPUT] = getGlobalString(L, "luaProfilerOutput", "data/logs/luaprofile");
+	string[LUA_BYTECODE_CACHE_PATH] = getGlobalString(L, "luaBytecodeCachePath", "data/cache/luac");
+	string[LUA_GC_MODE] = getGlobalString(L, "luaGcMode", "incremental");
 
 	integer[MAX_PLAYERS] = getGlobalNumber(L, "maxPlayers");
 	integer[PZ_LOCKED] = getGlobalNumber(L, "pzLocked", 60000);
@@ -285,6 +295,17 @@ bool ConfigManager::load() {
 	integer[STAMINA_REGEN_PREMIUM] = getGlobalNumber(L, "timeToRegenMinutePremiumStamina", 10 * 60);
 	integer[PATHFINDING_INTERVAL] = getGlobalNumber(L, "pathfindingInterval", 200);
 	integer[PATHFINDING_DELAY] = getGlobalNumber(L, "pathfindingDelay", 300);
+	integer[STATE_JOURNAL_FLUSH_INTERVAL] = getGlobalNumber(L, "stateJournalFlushInterval", 1000);
+	integer[STATE_JOURNAL_MAX_SIZE] = getGlobalNumber(L, "stateJournalMaxSize", 64);
+	integer[BAN_REFRESH_INTERVAL] = getGlobalNumber(L, "banRefreshInterval", 60);
+	integer[SCRIPTS_HOT_RELOAD_INTERVAL] = getGlobalNumber(L, "scriptsHotReloadInterval", 0);
+	integer[LUA_GC_PAUSE] = getGlobalNumber(L, "luaGcPause", 300);
+	integer[LUA_GC_STEP_MULTIPLIER] = getGlobalNumber(L, "luaGcStepMultiplier", 200);
+	integer[LUA_GC_STEP_SIZE] = getGlobalNumber(L, "luaGcStepSize", 64);
+	integer[LUA_PROFILER_SAMPLE_INTERVAL] = getGlobalNumber(L, "luaProfilerSampleInterval", 0);
+	integer[MAX_SPAWNS_PER_TICK] = getGlobalNumber(L, "maxSpawnsPerTick", 100);
+	integer[LOAD_LAG_HIGH] = getGlobalNumber(L, "loadLagHigh", 100);
+	integer[LOAD_LAG_CRITICAL] = getGlobalNumber(L, "loadLagCritical", 400);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
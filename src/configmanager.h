@@ -49,6 +49,11 @@ namespace ConfigManager {
                 ENABLE_REPUTATION_SYSTEM,
                 ENABLE_ECONOMY_SYSTEM,
                 ENABLE_MONSTER_RANK_SYSTEM,
+		STATE_JOURNAL,
+		LUA_PROFILER,
+		LUA_BYTECODE_CACHE,
+		LUA_GC_GOVERNOR,
+		LUA_FFI_BINDINGS,
 
                 LAST_BOOLEAN_CONFIG /* this must be the last one */
         };
@@ -72,6 +77,10 @@ namespace ConfigManager {
 		DEFAULT_PRIORITY,
 		MAP_AUTHOR,
 		CONFIG_FILE,
+		STATE_JOURNAL_FILE,
+		LUA_PROFILER_OUTPUT,
+		LUA_BYTECODE_CACHE_PATH,
+		LUA_GC_MODE,
 
 		LAST_STRING_CONFIG /* this must be the last one */
 	};
@@ -120,6 +129,17 @@ namespace ConfigManager {
 		STAMINA_REGEN_PREMIUM,
 		PATHFINDING_INTERVAL,
 		PATHFINDING_DELAY,
+		STATE_JOURNAL_FLUSH_INTERVAL,
+		STATE_JOURNAL_MAX_SIZE,
+		BAN_REFRESH_INTERVAL,
+		SCRIPTS_HOT_RELOAD_INTERVAL,
+		LUA_GC_PAUSE,
+		LUA_GC_STEP_MULTIPLIER,
+		LUA_GC_STEP_SIZE,
+		LUA_PROFILER_SAMPLE_INTERVAL,
+		MAX_SPAWNS_PER_TICK,
+		LOAD_LAG_HIGH,
+		LOAD_LAG_CRITICAL,
 
 		LAST_INTEGER_CONFIG /* this must be the last one */
 	};
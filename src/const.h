@@ -539,6 +539,8 @@ enum PlayerFlags : uint64_t {
 enum ReloadTypes_t : uint8_t {
 	RELOAD_TYPE_ALL,
 	RELOAD_TYPE_ACTIONS,
+	RELOAD_TYPE_BANS,
+	RELOAD_TYPE_CHANGED_SCRIPTS,
 	RELOAD_TYPE_CHAT,
 	RELOAD_TYPE_CONFIG,
 	RELOAD_TYPE_CREATURESCRIPTS,
@@ -555,6 +555,7 @@ void Container::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 	if (hasParent()) {
 		onUpdateContainerItem(index, item, item);
 	}
+	item->markHouseItemsDirty();
 }
 
 void Container::replaceThing(uint32_t index, Thing* thing) {
@@ -580,6 +581,7 @@ void Container::replaceThing(uint32_t index, Thing* thing) {
 	if (hasParent()) {
 		onUpdateContainerItem(index, replacedItem, item);
 	}
+	item->markHouseItemsDirty();
 
 	replacedItem->setParent(nullptr);
 }
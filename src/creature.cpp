@@ -9,6 +9,7 @@
 #include "configmanager.h"
 #include "events.h"
 #include "game/game.h"
+#include "luascript.h"
 #include "monster.h"
 #include "party.h"
 #include "scheduler.h"
@@ -38,6 +39,8 @@ Creature::~Creature() {
 	for (auto condition : conditions) {
 		delete condition;
         }
+
+	lua::releaseUserdata(this);
 }
 
 void Creature::setInstanceId(uint32_t id) {
@@ -681,6 +684,7 @@ void Creature::setAttackedCreature(Creature* creature) {
 	}
 
 	attackedCreature = creature;
+	g_game.setCreatureCheckFlag(this, CreatureTickRegistry::FLAG_HAS_TARGET);
 	creature->addFollower(this);
 	onAttackedCreature(attackedCreature);
 	attackedCreature->onAttacked();
@@ -967,6 +971,13 @@ bool Creature::setMaster(Creature* newMaster) {
 			decrementReferenceCounter();
 		}
 	}
+
+	// monsters look for their targets among the players and their summons of each leaf
+	if (getTile()) {
+		if (QTreeLeafNode* leaf = g_game.map.getQTNode(position.x, position.y)) {
+			leaf->updateCreature(this);
+		}
+	}
 	return true;
 }
 
@@ -992,6 +1003,7 @@ bool Creature::addCondition(Condition* condition, bool force/* = false*/) {
 
 	if (condition->startCondition(this)) {
 		conditions.push_back(condition);
+		g_game.setCreatureCheckFlag(this, CreatureTickRegistry::FLAG_HAS_CONDITIONS);
 		onAddCondition(condition->getType());
 		return true;
 	}
@@ -1013,55 +1025,61 @@ bool Creature::addCombatCondition(Condition* condition) {
 }
 
 void Creature::removeCondition(ConditionType_t type, bool force/* = false*/) {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
-		if (condition->getType() != type) {
-			++it;
-			continue;
+	if (!conditions.hasType(type)) {
+		return;
+	}
+
+	bool delayed = false;
+	conditions.walk([&](Condition* condition) {
+		if (delayed || condition->getType() != type) {
+			return;
 		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
 			if (walkDelay > 0) {
 				g_scheduler.addEvent(createSchedulerTask(walkDelay, [=, id = getID()] () { g_game.forceRemoveCondition(id, type); }));
+				delayed = true;
 				return;
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.remove(condition);
 
 		condition->endCondition(this);
 		delete condition;
 
 		onEndCondition(type);
-	}
+	});
 }
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId, bool force/* = false*/) {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
-		if (condition->getType() != type || condition->getId() != conditionId) {
-			++it;
-			continue;
+	if (!conditions.hasType(type)) {
+		return;
+	}
+
+	bool delayed = false;
+	conditions.walk([&](Condition* condition) {
+		if (delayed || condition->getType() != type || condition->getId() != conditionId) {
+			return;
 		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
 			if (walkDelay > 0) {
 				g_scheduler.addEvent(createSchedulerTask(walkDelay, [=, id = getID()] () { g_game.forceRemoveCondition(id, type); }));
+				delayed = true;
 				return;
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.remove(condition);
 
 		condition->endCondition(this);
 		delete condition;
 
 		onEndCondition(type);
-	}
+	});
 }
 
 void Creature::removeCombatCondition(ConditionType_t type) {
@@ -1099,6 +1117,10 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/) {
 }
 
 Condition* Creature::getCondition(ConditionType_t type) const {
+	if (!conditions.hasType(type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type) {
 			return condition;
@@ -1108,6 +1130,10 @@ Condition* Creature::getCondition(ConditionType_t type) const {
 }
 
 Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId/* = 0*/) const {
+	if (!conditions.hasType(type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type && condition->getId() == conditionId && condition->getSubId() == subId) {
 			return condition;
@@ -1117,27 +1143,18 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 }
 
 void Creature::executeConditions(uint32_t interval) {
-	ConditionList tempConditions{ conditions };
-	for (Condition* condition : tempConditions) {
-		auto it = std::find(conditions.begin(), conditions.end(), condition);
-		if (it == conditions.end()) {
-			continue;
-		}
-
-		if (!condition->executeCondition(this, interval)) {
-			it = std::find(conditions.begin(), conditions.end(), condition);
-			if (it != conditions.end()) {
-				conditions.erase(it);
-				condition->endCondition(this);
-				onEndCondition(condition->getType());
-				delete condition;
-			}
+	// conditions removed by another one are skipped, see ConditionList::walk
+	conditions.walk([&](Condition* condition) {
+		if (!condition->executeCondition(this, interval) && conditions.remove(condition)) {
+			condition->endCondition(this);
+			onEndCondition(condition->getType());
+			delete condition;
 		}
-	}
+	});
 }
 
 bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const {
-	if (isSuppress(type)) {
+	if (isSuppress(type) || !conditions.hasType(type)) {
 		return false;
 	}
 
@@ -1393,9 +1410,7 @@ bool FrozenPathingConditionCall::operator()(const Position& startPos, const Posi
 }
 
 bool Creature::isInvisible() const {
-	return std::find_if(conditions.begin(), conditions.end(), [] (const Condition* condition) {
-		return condition->getType() == CONDITION_INVISIBLE;
-	}) != conditions.end();
+	return conditions.hasType(CONDITION_INVISIBLE);
 }
 
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp) const {
@@ -4,11 +4,13 @@
 #ifndef FS_CREATURE_H
 #define FS_CREATURE_H
 
+#include "conditionlist.h"
 #include "const.h"
 #include "creatureevent.h"
 #include "enums.h"
 #include "map.h"
 #include "position.h"
+#include "tickregistry.h"
 #include "tile.h"
 
 class Condition;
@@ -18,7 +20,6 @@ class Monster;
 class Npc;
 class Player;
 
-using ConditionList = std::list<Condition*>;
 using CreatureEventList = std::list<CreatureEvent*>;
 
 enum slots_t : uint8_t {
@@ -175,6 +176,10 @@ class Creature : virtual public Thing {
 		virtual bool canSeeGhostMode(const Creature*) const {
 			return false;
 		}
+		// a sleeping creature is left out of the creature ticks until it wakes up
+		virtual bool isSleeping() const {
+			return false;
+		}
 
 		int32_t getWalkDelay(Direction dir) const;
 		int32_t getWalkDelay() const;
@@ -436,6 +441,10 @@ class Creature : virtual public Thing {
 			return movementBlocked;
 		}
 
+		TickHandle& getTickHandle() {
+			return tickHandle;
+		}
+
 		//creature script events
 		bool registerCreatureEvent(const std::string& name);
 		bool unregisterCreatureEvent(const std::string& name);
@@ -539,12 +548,12 @@ class Creature : virtual public Thing {
 		Position lastPosition;
 		LightInfo internalLight;
 
+		TickHandle tickHandle;
+
 		Direction direction = DIRECTION_SOUTH;
 		Skulls_t skull = SKULL_NONE;
 
 		bool isInternalRemoved = false;
-		bool creatureCheck = false;
-		bool inCheckCreaturesVector = false;
 		bool skillLoss = true;
 		bool lootDrop = true;
 		bool cancelNextWalk = false;
@@ -585,4 +594,7 @@ class Creature : virtual public Thing {
 		std::map<uint32_t, int32_t> storageMap;
 };
 
+// creatures ticked by Game::checkCreatures, one bucket every EVENT_CHECK_CREATURE_INTERVAL
+using CreatureTickRegistry = TickRegistry<Creature, EVENT_CREATURECOUNT>;
+
 #endif // FS_CREATURE_H
\ No newline at end of file
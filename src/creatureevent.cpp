@@ -6,6 +6,7 @@
 #include "creatureevent.h"
 
 #include "item.h"
+#include "player.h"
 #include "tools.h"
 
 CreatureEvents::CreatureEvents() : scriptInterface("CreatureScript Interface") {
@@ -36,6 +37,14 @@ void CreatureEvents::clear(bool fromLua) {
 	reInitState(fromLua);
 }
 
+void CreatureEvents::removeScriptEvents(ScriptEventSet& events) {
+	for (auto& it : creatureEvents) {
+		if (it.second.isLoaded() && events.claim(it.second)) {
+			it.second.clearEvent();
+		}
+	}
+}
+
 void CreatureEvents::removeInvalidEvents() {
 	for (auto it = creatureEvents.begin(); it != creatureEvents.end(); ++it) {
 		if (it->second.getScriptId() == 0) {
@@ -290,8 +299,7 @@ bool CreatureEvent::executeOnLogin(Player* player) const {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -309,8 +317,7 @@ bool CreatureEvent::executeOnLogout(Player* player) const {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -328,8 +335,7 @@ void CreatureEvent::executeOnReconnect(Player* player) const {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	scriptInterface->callFunction(1);
 }
 
@@ -346,8 +352,7 @@ bool CreatureEvent::executeOnThink(Creature* creature, uint32_t interval) {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	lua_pushnumber(L, interval);
 
 	return scriptInterface->callFunction(2);
@@ -367,12 +372,10 @@ bool CreatureEvent::executeOnPrepareDeath(Creature* creature, Creature* killer)
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 
 	if (killer) {
-		lua::pushUserdata(L, killer);
-		lua::setCreatureMetatable(L, -1, killer);
+		lua::pushCreature(L, killer);
 	} else {
 		lua_pushnil(L);
 	}
@@ -393,21 +396,18 @@ bool CreatureEvent::executeOnDeath(Creature* creature, Item* corpse, Creature* k
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 
 	lua::pushThing(L, corpse);
 
 	if (killer) {
-		lua::pushUserdata(L, killer);
-		lua::setCreatureMetatable(L, -1, killer);
+		lua::pushCreature(L, killer);
 	} else {
 		lua_pushnil(L);
 	}
 
 	if (mostDamageKiller) {
-		lua::pushUserdata(L, mostDamageKiller);
-		lua::setCreatureMetatable(L, -1, mostDamageKiller);
+		lua::pushCreature(L, mostDamageKiller);
 	} else {
 		lua_pushnil(L);
 	}
@@ -432,8 +432,7 @@ bool CreatureEvent::executeAdvance(Player* player, skills_t skill, uint32_t oldL
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	lua_pushnumber(L, static_cast<uint32_t>(skill));
 	lua_pushnumber(L, oldLevel);
 	lua_pushnumber(L, newLevel);
@@ -454,10 +453,8 @@ void CreatureEvent::executeOnKill(Creature* creature, Creature* target) {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
-	lua::pushUserdata(L, target);
-	lua::setCreatureMetatable(L, -1, target);
+	lua::pushCreature(L, creature);
+	lua::pushCreature(L, target);
 	scriptInterface->callVoidFunction(2);
 }
 
@@ -474,8 +471,7 @@ void CreatureEvent::executeModalWindow(Player* player, uint32_t modalWindowId, u
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	lua_pushnumber(L, modalWindowId);
 	lua_pushnumber(L, buttonId);
@@ -497,8 +493,7 @@ bool CreatureEvent::executeTextEdit(Player* player, Item* item, std::string_view
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	lua::pushThing(L, item);
 	lua::pushString(L, text);
@@ -521,11 +516,9 @@ void CreatureEvent::executeHealthChange(Creature* creature, Creature* attacker,
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	if (attacker) {
-		lua::pushUserdata(L, attacker);
-		lua::setCreatureMetatable(L, -1, attacker);
+		lua::pushCreature(L, attacker);
 	} else {
 		lua_pushnil(L);
 	}
@@ -563,11 +556,9 @@ void CreatureEvent::executeManaChange(Creature* creature, Creature* attacker, Co
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	if (attacker) {
-		lua::pushUserdata(L, attacker);
-		lua::setCreatureMetatable(L, -1, attacker);
+		lua::pushCreature(L, attacker);
 	} else {
 		lua_pushnil(L);
 	}
@@ -601,8 +592,7 @@ void CreatureEvent::executeExtendedOpcode(Player* player, uint8_t opcode, const
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	lua_pushnumber(L, opcode);
 	lua::pushString(L, buffer);
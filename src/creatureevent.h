@@ -100,6 +100,12 @@ class CreatureEvents final : public BaseEvents {
 		bool registerLuaEvent(CreatureEvent* event);
 		void clear(bool fromLua) override final;
 
+		/**
+		 * Unloads the events instead of erasing them, creatures keep pointers
+		 * to them and registering the same name again reuses the entry.
+		 */
+		void removeScriptEvents(ScriptEventSet& events);
+
 		void removeInvalidEvents();
 
 	private:
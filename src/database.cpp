@@ -332,6 +332,31 @@ retry:
         return result;
 }
 
+DBResult_ptr Database::useQuery(std::string_view query) {
+	std::unique_lock<std::recursive_mutex> connectionLock(databaseLock);
+
+retry:
+	if (!::executeQuery(handle, query, retryQueries) && !retryQueries) {
+		return nullptr;
+	}
+
+	detail::MysqlResult_ptr res{mysql_use_result(handle.get())};
+	if (!res) {
+		std::cout << "[Error - mysql_use_result] Query: " << query << std::endl << "Message: " << mysql_error(handle.get()) << std::endl;
+		const unsigned error = mysql_errno(handle.get());
+		if (!isLostConnectionError(error) || !retryQueries) {
+			return nullptr;
+		}
+		goto retry;
+	}
+
+	DBResult_ptr result = std::make_shared<DBResult>(std::move(res), std::move(connectionLock));
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
 std::string Database::escapeBlob(const char* s, uint32_t length) const {
 	// the worst case is 2n + 1
 	size_t maxLength = (length * 2) + 1;
@@ -363,6 +388,11 @@ DBResult::DBResult(detail::MysqlResult_ptr&& res) : handle {std::move(res)} {
 	row = mysql_fetch_row(handle.get());
 }
 
+DBResult::DBResult(detail::MysqlResult_ptr&& res, std::unique_lock<std::recursive_mutex>&& connectionLock) :
+	DBResult(std::move(res)) {
+	this->connectionLock = std::move(connectionLock);
+}
+
 std::string_view DBResult::getString(std::string_view column) const {
 	auto it = listNames.find(column);
 	if (it == listNames.end()) {
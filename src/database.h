@@ -60,6 +60,17 @@ class Database {
 		 */
 		DBResult_ptr storeQuery(std::string_view query);
 
+		/**
+		 * Queries database without buffering the whole result set.
+		 *
+		 * Rows are fetched from the server while the result is iterated, so
+		 * the connection stays locked to the calling thread until the result
+		 * is released and no other query may be issued from it meanwhile.
+		 *
+		 * @return results object (nullptr on error)
+		 */
+		DBResult_ptr useQuery(std::string_view query);
+
 		/**
 		 * Escapes string for query.
 		 *
@@ -129,6 +140,7 @@ class Database {
 class DBResult {
 	public:
 		explicit DBResult(detail::MysqlResult_ptr&& res);
+		DBResult(detail::MysqlResult_ptr&& res, std::unique_lock<std::recursive_mutex>&& connectionLock);
 
 		// non-copyable
 		DBResult(const DBResult&) = delete;
@@ -155,6 +167,8 @@ class DBResult {
 		bool next();
 
 	private:
+		// held by unbuffered results, released after the handle is freed
+		std::unique_lock<std::recursive_mutex> connectionLock;
 		detail::MysqlResult_ptr handle;
 		MYSQL_ROW row;
 
@@ -5,6 +5,7 @@
 
 #include "depotchest.h"
 
+#include "statejournal.h"
 #include "tools.h"
 
 DepotChest::DepotChest(uint16_t type):
@@ -47,6 +48,11 @@ void DepotChest::postAddNotification(Thing* thing, const Cylinder* oldParent, in
 	if (parent) {
 		parent->postAddNotification(thing, oldParent, index, LINK_PARENT);
 	}
+
+	// the locker forwards to its tile, so the owner never hears of it
+	if (thing->getItem()) {
+		g_stateJournal.playerItemsChanged(ownerId);
+	}
 }
 
 void DepotChest::postRemoveNotification(Thing* thing, const Cylinder* newParent, int32_t index, cylinderlink_t) {
@@ -54,6 +60,10 @@ void DepotChest::postRemoveNotification(Thing* thing, const Cylinder* newParent,
 	if (parent) {
 		parent->postRemoveNotification(thing, newParent, index, LINK_PARENT);
 	}
+
+	if (thing->getItem()) {
+		g_stateJournal.playerItemsChanged(ownerId);
+	}
 }
 
 Cylinder* DepotChest::getParent() const {
@@ -18,6 +18,9 @@ class DepotChest final : public Container {
 		void setMaxDepotItems(uint32_t maxitems) {
 			maxDepotItems = maxitems;
 		}
+		void setOwnerId(uint32_t guid) {
+			ownerId = guid;
+		}
 
 		// Cylinder implementations
 		ReturnValue queryAdd(int32_t index, const Thing& thing, uint32_t count,
@@ -43,6 +46,8 @@ class DepotChest final : public Container {
 
 	private:
 		uint32_t maxDepotItems;
+		// guid of the player whose items this holds, journaled on every change
+		uint32_t ownerId = 0;
 };
 
 #endif // FS_DEPOTCHEST_H
\ No newline at end of file
@@ -6,7 +6,9 @@
 #include "events.h"
 
 #include "item.h"
+#include "monster.h"
 #include "player.h"
+#include "tasks.h"
 
 namespace {
 
@@ -64,6 +66,144 @@ namespace {
 		int32_t onSpawn = -1;
 	} monsterHandlers;
 
+	constexpr size_t BATCHED_EVENT_COUNT = static_cast<size_t>(BatchedEventId::LAST);
+
+	constexpr std::array<const char*, BATCHED_EVENT_COUNT> batchedEventNames = {
+		"onItemMoved",
+		"onGainExperience",
+		"onGainSkillTries",
+		"onInventoryUpdate",
+	};
+
+	struct EventBatch {
+		// registry reference of the pending entries, LUA_NOREF while empty
+		int entriesRef = LUA_NOREF;
+		int size = 0;
+		events::DispatchStats stats;
+	};
+
+	std::array<EventBatch, BATCHED_EVENT_COUNT> eventBatches;
+
+	// one bit per BatchedEventId whose handler is delivered in batches
+	uint32_t batchedEvents = 0;
+	bool flushScheduled = false;
+	int64_t dispatchStatsStart = 0;
+
+	constexpr uint32_t batchedEventBit(BatchedEventId id) {
+		return 1u << static_cast<uint32_t>(id);
+	}
+
+	EventBatch& getEventBatch(BatchedEventId id) {
+		return eventBatches[static_cast<size_t>(id)];
+	}
+
+	std::optional<BatchedEventId> getBatchedEventId(std::string_view className, std::string_view methodName) {
+		if (className != "Player") {
+			return std::nullopt;
+		}
+
+		for (size_t i = 0; i < BATCHED_EVENT_COUNT; ++i) {
+			if (methodName == batchedEventNames[i]) {
+				return static_cast<BatchedEventId>(i);
+			}
+		}
+		return std::nullopt;
+	}
+
+	int32_t getBatchedHandler(BatchedEventId id) {
+		switch (id) {
+			case BatchedEventId::PLAYER_ONITEMMOVED:
+				return playerHandlers.onItemMoved;
+			case BatchedEventId::PLAYER_ONGAINEXPERIENCE:
+				return playerHandlers.onGainExperience;
+			case BatchedEventId::PLAYER_ONGAINSKILLTRIES:
+				return playerHandlers.onGainSkillTries;
+			case BatchedEventId::PLAYER_ONINVENTORYUPDATE:
+				return playerHandlers.onInventoryUpdate;
+			default:
+				return -1;
+		}
+	}
+
+	void resetEventBatches() {
+		lua_State* L = scriptInterface.getLuaState();
+		for (EventBatch& batch : eventBatches) {
+			if (L && batch.entriesRef != LUA_NOREF) {
+				luaL_unref(L, LUA_REGISTRYINDEX, batch.entriesRef);
+			}
+			batch = {};
+		}
+
+		batchedEvents = 0;
+		dispatchStatsStart = OTSYS_TIME();
+	}
+
+	void flushEventBatches() {
+		// Player.<method>Batch(entries)
+		flushScheduled = false;
+
+		lua_State* L = scriptInterface.getLuaState();
+		for (size_t i = 0; i < BATCHED_EVENT_COUNT; ++i) {
+			EventBatch& batch = eventBatches[i];
+			if (batch.entriesRef == LUA_NOREF) {
+				continue;
+			}
+
+			// entries queued by the handler itself go to the next batch
+			const int entriesRef = batch.entriesRef;
+			batch.entriesRef = LUA_NOREF;
+			batch.size = 0;
+
+			const int32_t scriptId = getBatchedHandler(static_cast<BatchedEventId>(i));
+			if (scriptId == -1) {
+				luaL_unref(L, LUA_REGISTRYINDEX, entriesRef);
+				continue;
+			}
+
+			if (!lua::reserveScriptEnv()) {
+				std::cout << "[Error - events::flushEventBatches] Call stack overflow" << std::endl;
+				luaL_unref(L, LUA_REGISTRYINDEX, entriesRef);
+				continue;
+			}
+
+			ScriptEnvironment* env = lua::getScriptEnv();
+			env->setScriptId(scriptId, &scriptInterface);
+
+			scriptInterface.pushFunction(scriptId);
+			lua_rawgeti(L, LUA_REGISTRYINDEX, entriesRef);
+			luaL_unref(L, LUA_REGISTRYINDEX, entriesRef);
+
+			++batch.stats.luaCalls;
+			scriptInterface.callVoidFunction(1);
+		}
+	}
+
+	// pushes the entries table and a new entry for the caller to fill, see commitBatchEntry
+	lua_State* pushBatchEntry(BatchedEventId id, int fields) {
+		EventBatch& batch = getEventBatch(id);
+		lua_State* L = scriptInterface.getLuaState();
+		if (batch.entriesRef == LUA_NOREF) {
+			lua_newtable(L);
+			batch.entriesRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+			// runs after the tasks already queued, so everything they trigger shares one call
+			if (!flushScheduled) {
+				flushScheduled = true;
+				g_dispatcher.addTask(flushEventBatches);
+			}
+		}
+
+		lua_rawgeti(L, LUA_REGISTRYINDEX, batch.entriesRef);
+		lua_createtable(L, 0, fields);
+		return L;
+	}
+
+	void commitBatchEntry(BatchedEventId id, lua_State* L) {
+		// entries[#entries + 1] = entry
+		lua_rawseti(L, -2, ++getEventBatch(id).size);
+		lua_pop(L, 1);
+	}
+
 	bool load_from_xml() {
 		pugi::xml_document doc;
 		pugi::xml_parse_result result = doc.load_file("data/events/events.xml");
@@ -76,6 +216,7 @@ namespace {
 		partyHandlers = {};
 		playerHandlers = {};
 		monsterHandlers = {};
+		resetEventBatches();
 
 		std::set<std::string> classes;
 		for (auto eventNode : doc.child("events").children()) {
@@ -94,7 +235,19 @@ namespace {
 			}
 
 			const std::string& methodName = eventNode.attribute("method").as_string();
-			const auto event = scriptInterface.getMetaEvent(className, methodName);
+			std::optional<BatchedEventId> batchedEventId;
+			if (eventNode.attribute("batched").as_bool()) {
+				batchedEventId = getBatchedEventId(className, methodName);
+				if (!batchedEventId) {
+					std::cout << "[Warning - events::load_from_xml] " << className << ':' << methodName << " can not be batched." << std::endl;
+				}
+			}
+
+			// batched handlers are Player.<method>Batch(entries)
+			const auto event = scriptInterface.getMetaEvent(className, batchedEventId ? methodName + "Batch" : methodName);
+			if (batchedEventId && event != -1) {
+				batchedEvents |= batchedEventBit(*batchedEventId);
+			}
 			if (className == "Creature") {
 				if (methodName == "onChangeOutfit") {
 					creatureHandlers.onChangeOutfit = event;
@@ -207,6 +360,22 @@ namespace events {
 		}
 	}
 
+	const char* getBatchedEventName(BatchedEventId id) {
+		return batchedEventNames[static_cast<size_t>(id)];
+	}
+
+	bool isBatched(BatchedEventId id) {
+		return (batchedEvents & batchedEventBit(id)) != 0;
+	}
+
+	const DispatchStats& getDispatchStats(BatchedEventId id) {
+		return getEventBatch(id).stats;
+	}
+
+	int64_t getDispatchStatsStart() {
+		return dispatchStatsStart;
+	}
+
 	bool load() {
 		scriptInterface.initState();
 		return load_from_xml();
@@ -238,8 +407,7 @@ namespace events::creature {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(creatureHandlers.onChangeOutfit);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		lua::pushOutfit(L, outfit);
 
@@ -264,8 +432,7 @@ namespace events::creature {
 		scriptInterface.pushFunction(creatureHandlers.onAreaCombat);
 
 		if (creature) {
-			lua::pushUserdata(L, creature);
-			lua::setCreatureMetatable(L, -1, creature);
+			lua::pushCreature(L, creature);
 		} else {
 			lua_pushnil(L);
 		}
@@ -306,14 +473,12 @@ namespace events::creature {
 		scriptInterface.pushFunction(creatureHandlers.onTargetCombat);
 
 		if (creature) {
-			lua::pushUserdata(L, creature);
-			lua::setCreatureMetatable(L, -1, creature);
+			lua::pushCreature(L, creature);
 		} else {
 			lua_pushnil(L);
 		}
 
-		lua::pushUserdata(L, target);
-		lua::setCreatureMetatable(L, -1, target);
+		lua::pushCreature(L, target);
 
 		ReturnValue returnValue;
 		if (lua::protectedCall(L, 2, 1) != 0) {
@@ -345,11 +510,9 @@ namespace events::creature {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(creatureHandlers.onHear);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
-		lua::pushUserdata(L, speaker);
-		lua::setCreatureMetatable(L, -1, speaker);
+		lua::pushCreature(L, speaker);
 
 		lua::pushString(L, words);
 		lua_pushnumber(L, type);
@@ -374,8 +537,7 @@ namespace events::creature {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(creatureHandlers.onChangeZone);
 	 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 	 
 		lua_pushnumber(L, fromZone);
 		lua_pushnumber(L, toZone);
@@ -400,8 +562,7 @@ namespace events::creature {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(creatureHandlers.onUpdateStorage);
 
-		lua::pushUserdata(L, creature);
-		lua::setMetatable(L, -1, "Creature");
+		lua::pushCreature(L, creature);
 
 		lua_pushnumber(L, key);
 
@@ -446,8 +607,7 @@ namespace events::party {
 		lua::pushUserdata(L, party);
 		lua::setMetatable(L, -1, "Party");
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		return scriptInterface.callFunction(2);
 	}
@@ -472,8 +632,7 @@ namespace events::party {
 		lua::pushUserdata(L, party);
 		lua::setMetatable(L, -1, "Party");
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		return scriptInterface.callFunction(2);
 	}
@@ -521,8 +680,7 @@ namespace events::party {
 		lua::pushUserdata(L, party);
 		lua::setMetatable(L, -1, "Party");
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		return scriptInterface.callFunction(2);
 	}
@@ -547,8 +705,7 @@ namespace events::party {
 		lua::pushUserdata(L, party);
 		lua::setMetatable(L, -1, "Party");
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		return scriptInterface.callFunction(2);
 	}
@@ -573,8 +730,7 @@ namespace events::party {
 		lua::pushUserdata(L, party);
 		lua::setMetatable(L, -1, "Party");
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		return scriptInterface.callFunction(2);
 	}
@@ -632,8 +788,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onBrowseField);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua::pushPosition(L, position);
 
@@ -657,15 +812,12 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onLook);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		if (Creature* creature = thing->getCreature()) {
-			lua::pushUserdata(L, creature);
-			lua::setCreatureMetatable(L, -1, creature);
+			lua::pushCreature(L, creature);
 		} else if (Item* item = thing->getItem()) {
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 		} else {
 			lua_pushnil(L);
 		}
@@ -693,11 +845,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onLookInBattleList);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		lua_pushnumber(L, lookDistance);
 
@@ -721,14 +871,11 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onLookInTrade);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, partner);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, partner);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		lua_pushnumber(L, lookDistance);
 
@@ -752,8 +899,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onLookInShop);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua::pushUserdata(L, itemType);
 		lua::setMetatable(L, -1, "ItemType");
@@ -781,11 +927,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onMoveItem);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		lua_pushnumber(L, count);
 		lua::pushPosition(L, fromPosition);
@@ -813,6 +957,28 @@ namespace events::player {
 			return;
 		}
 
+		EventBatch& batch = getEventBatch(BatchedEventId::PLAYER_ONITEMMOVED);
+		++batch.stats.events;
+		if (batchedEvents & batchedEventBit(BatchedEventId::PLAYER_ONITEMMOVED)) {
+			lua_State* L = pushBatchEntry(BatchedEventId::PLAYER_ONITEMMOVED, 7);
+			lua::pushCreature(L, player);
+			lua_setfield(L, -2, "player");
+			lua::pushItem(L, item);
+			lua_setfield(L, -2, "item");
+			lua_pushnumber(L, count);
+			lua_setfield(L, -2, "count");
+			lua::pushPosition(L, fromPosition);
+			lua_setfield(L, -2, "fromPosition");
+			lua::pushPosition(L, toPosition);
+			lua_setfield(L, -2, "toPosition");
+			lua::pushCylinder(L, fromCylinder);
+			lua_setfield(L, -2, "fromCylinder");
+			lua::pushCylinder(L, toCylinder);
+			lua_setfield(L, -2, "toCylinder");
+			commitBatchEntry(BatchedEventId::PLAYER_ONITEMMOVED, L);
+			return;
+		}
+
 		if (!lua::reserveScriptEnv()) {
 			std::cout << "[Error - events::player::onItemMoved] Call stack overflow" << std::endl;
 			return;
@@ -824,11 +990,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onItemMoved);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		lua_pushnumber(L, count);
 		lua::pushPosition(L, fromPosition);
@@ -837,6 +1001,7 @@ namespace events::player {
 		lua::pushCylinder(L, fromCylinder);
 		lua::pushCylinder(L, toCylinder);
 
+		++batch.stats.luaCalls;
 		scriptInterface.callVoidFunction(7);
 	}
 
@@ -857,11 +1022,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onMoveCreature);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		lua::pushPosition(L, fromPosition);
 		lua::pushPosition(L, toPosition);
@@ -886,8 +1049,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onReportRuleViolation);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua::pushString(L, targetName);
 
@@ -917,8 +1079,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onReportBug);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua::pushString(L, message);
 		lua::pushPosition(L, position);
@@ -944,11 +1105,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onRotateItem);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		scriptInterface.callFunction(2);
 	}
@@ -970,8 +1129,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onTurn);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua_pushnumber(L, direction);
 
@@ -995,14 +1153,11 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onTradeRequest);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, target);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, target);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		return scriptInterface.callFunction(3);
 	}
@@ -1024,17 +1179,13 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onTradeAccept);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, target);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, target);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
-		lua::pushUserdata(L, targetItem);
-		lua::setItemMetatable(L, -1, targetItem);
+		lua::pushItem(L, targetItem);
 
 		return scriptInterface.callFunction(4);
 	}
@@ -1056,17 +1207,13 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onTradeCompleted);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, target);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, target);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
-		lua::pushUserdata(L, targetItem);
-		lua::setItemMetatable(L, -1, targetItem);
+		lua::pushItem(L, targetItem);
 
 		lua::pushBoolean(L, isSuccess);
 
@@ -1080,6 +1227,25 @@ namespace events::player {
 			return;
 		}
 
+		EventBatch& batch = getEventBatch(BatchedEventId::PLAYER_ONGAINEXPERIENCE);
+		++batch.stats.events;
+		if (batchedEvents & batchedEventBit(BatchedEventId::PLAYER_ONGAINEXPERIENCE)) {
+			// reported after the fact, exp is left unchanged
+			lua_State* L = pushBatchEntry(BatchedEventId::PLAYER_ONGAINEXPERIENCE, 4);
+			lua::pushCreature(L, player);
+			lua_setfield(L, -2, "player");
+			if (source) {
+				lua::pushCreature(L, source);
+				lua_setfield(L, -2, "source");
+			}
+			lua_pushnumber(L, exp);
+			lua_setfield(L, -2, "exp");
+			lua_pushnumber(L, rawExp);
+			lua_setfield(L, -2, "rawExp");
+			commitBatchEntry(BatchedEventId::PLAYER_ONGAINEXPERIENCE, L);
+			return;
+		}
+
 		if (!lua::reserveScriptEnv()) {
 			std::cout << "[Error - events::player::onGainExperience] Call stack overflow" << std::endl;
 			return;
@@ -1091,12 +1257,10 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onGainExperience);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		if (source) {
-			lua::pushUserdata(L, source);
-			lua::setCreatureMetatable(L, -1, source);
+			lua::pushCreature(L, source);
 		} else {
 			lua_pushnil(L);
 		}
@@ -1104,6 +1268,7 @@ namespace events::player {
 		lua_pushnumber(L, exp);
 		lua_pushnumber(L, rawExp);
 
+		++batch.stats.luaCalls;
 		if (lua::protectedCall(L, 4, 1) != 0) {
 			reportErrorFunc(L, lua::popString(L));
 		} else {
@@ -1131,8 +1296,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onLoseExperience);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua_pushnumber(L, exp);
 
@@ -1152,6 +1316,21 @@ namespace events::player {
 			return;
 		}
 
+		EventBatch& batch = getEventBatch(BatchedEventId::PLAYER_ONGAINSKILLTRIES);
+		++batch.stats.events;
+		if (batchedEvents & batchedEventBit(BatchedEventId::PLAYER_ONGAINSKILLTRIES)) {
+			// reported after the fact, tries are left unchanged
+			lua_State* L = pushBatchEntry(BatchedEventId::PLAYER_ONGAINSKILLTRIES, 3);
+			lua::pushCreature(L, player);
+			lua_setfield(L, -2, "player");
+			lua_pushnumber(L, skill);
+			lua_setfield(L, -2, "skill");
+			lua_pushnumber(L, tries);
+			lua_setfield(L, -2, "tries");
+			commitBatchEntry(BatchedEventId::PLAYER_ONGAINSKILLTRIES, L);
+			return;
+		}
+
 		if (!lua::reserveScriptEnv()) {
 			std::cout << "[Error - events::player::onGainSkillTries] Call stack overflow" << std::endl;
 			return;
@@ -1163,12 +1342,12 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onGainSkillTries);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua_pushnumber(L, skill);
 		lua_pushnumber(L, tries);
 
+		++batch.stats.luaCalls;
 		if (lua::protectedCall(L, 3, 1) != 0) {
 			reportErrorFunc(L, lua::popString(L));
 		} else {
@@ -1196,11 +1375,9 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onWrapItem);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		scriptInterface.callVoidFunction(2);
 	}
@@ -1211,6 +1388,22 @@ namespace events::player {
 			return;
 		}
 
+		EventBatch& batch = getEventBatch(BatchedEventId::PLAYER_ONINVENTORYUPDATE);
+		++batch.stats.events;
+		if (batchedEvents & batchedEventBit(BatchedEventId::PLAYER_ONINVENTORYUPDATE)) {
+			lua_State* L = pushBatchEntry(BatchedEventId::PLAYER_ONINVENTORYUPDATE, 4);
+			lua::pushCreature(L, player);
+			lua_setfield(L, -2, "player");
+			lua::pushItem(L, item);
+			lua_setfield(L, -2, "item");
+			lua_pushnumber(L, slot);
+			lua_setfield(L, -2, "slot");
+			lua::pushBoolean(L, equip);
+			lua_setfield(L, -2, "equip");
+			commitBatchEntry(BatchedEventId::PLAYER_ONINVENTORYUPDATE, L);
+			return;
+		}
+
 		if (!lua::reserveScriptEnv()) {
 			std::cout << "[Error - events::player::onInventoryUpdate] Call stack overflow" << std::endl;
 			return;
@@ -1222,15 +1415,14 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onInventoryUpdate);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 
 		lua_pushnumber(L, slot);
 		lua::pushBoolean(L, equip);
 
+		++batch.stats.luaCalls;
 		scriptInterface.callVoidFunction(4);
 	}
 
@@ -1251,8 +1443,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onNetworkMessage);
 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 
 		lua_pushnumber(L, recvByte);
 
@@ -1279,8 +1470,7 @@ namespace events::player {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(playerHandlers.onSpellCheck);
 	 
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 	 
 		lua::pushSpell(L, *spell);
 	 
@@ -1308,8 +1498,7 @@ namespace events::monster {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(monsterHandlers.onSpawn);
 
-		lua::pushUserdata(L, monster);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, monster);
 		lua::pushPosition(L, position);
 		lua::pushBoolean(L, startup);
 		lua::pushBoolean(L, artificial);
@@ -1334,11 +1523,9 @@ namespace events::monster {
 		lua_State* L = scriptInterface.getLuaState();
 		scriptInterface.pushFunction(monsterHandlers.onDropLoot);
 
-		lua::pushUserdata(L, monster);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, monster);
 
-		lua::pushUserdata(L, corpse);
-		lua::setMetatable(L, -1, "Container");
+		lua::pushItem(L, corpse);
 
 		return scriptInterface.callVoidFunction(2);
 	}
@@ -23,12 +23,35 @@ enum class EventInfoId {
 	MONSTER_ONSPAWN
 };
 
+// high-frequency notifications that can be delivered in batches, see data/events/events.xml
+enum class BatchedEventId : uint8_t {
+	PLAYER_ONITEMMOVED,
+	PLAYER_ONGAINEXPERIENCE,
+	PLAYER_ONGAINSKILLTRIES,
+	PLAYER_ONINVENTORYUPDATE,
+
+	LAST
+};
+
 namespace events {
 
 	bool load();
 	bool reload();
 	int32_t getScriptId(EventInfoId eventInfoId);
 
+	struct DispatchStats {
+		// occurrences of the event since the last (re)load
+		uint64_t events = 0;
+		// Lua calls made to deliver them
+		uint64_t luaCalls = 0;
+	};
+
+	const char* getBatchedEventName(BatchedEventId id);
+	bool isBatched(BatchedEventId id);
+	const DispatchStats& getDispatchStats(BatchedEventId id);
+	// OTSYS_TIME of the last (re)load, when the stats were reset
+	int64_t getDispatchStatsStart();
+
 } // namespace events
 
 namespace events::creature {
@@ -87,6 +87,21 @@ class PropStream {
 			return {ret, true};
 		}
 
+		std::pair<std::string_view, bool> readBlob() {
+			uint32_t blobLen;
+			if (!read<uint32_t>(blobLen)) {
+				return {"", false};
+			}
+
+			if (size() < blobLen) {
+				return {"", false};
+			}
+
+			std::string_view ret{p, blobLen};
+			p += blobLen;
+			return {ret, true};
+		}
+
 		bool skip(size_t n) {
 			if (size() < n) {
 				return false;
@@ -134,6 +149,11 @@ class PropWriteStream {
 			std::copy(str.begin(), str.end(), std::back_inserter(buffer));
 		}
 
+		void writeBlob(std::string_view blob) {
+			write(static_cast<uint32_t>(blob.size()));
+			std::copy(blob.begin(), blob.end(), std::back_inserter(buffer));
+		}
+
 	private:
 		std::vector<char> buffer;
 };
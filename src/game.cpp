@@ -9,6 +9,7 @@
 #include "globalevent.h"
 
 #include "actions.h"
+#include "ban.h"
 #include "bed.h"
 #include "configmanager.h"
 #include "creature.h"
@@ -32,8 +33,10 @@
 #include "server.h"
 #include "spectators.h"
 #include "spells.h"
+#include "statejournal.h"
 #include "storeinbox.h"
 #include "talkaction.h"
+#include "tickbudget.h"
 #include "weapons.h"
 #include "world/WorldPressureManager.hpp"
 #if ENABLE_INSTANCING
@@ -101,6 +104,9 @@ void Game::start(ServiceManager* manager) {
                 checkPressure();
         }));
 
+        g_scheduler.addEvent(createSchedulerTask(EVENT_LOADINTERVAL, [this]() {
+                checkLoad();
+        }));
 }
 
 GameState_t Game::getGameState() const {
@@ -197,15 +203,21 @@ void Game::saveGameState() {
 		std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
 	}
 
+	bool saved = true;
 	for (const auto& it : players) {
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		saved = IOLoginData::savePlayer(it.second) && saved;
 	}
 
-	Map::save();
+	saved = Map::save() && saved;
 
 	g_databaseTasks.flush();
 
+	// everything journaled since the last save is in the database now
+	if (saved) {
+		g_stateJournal.compact();
+	}
+
 	if (gameState == GAME_STATE_MAINTAIN) {
 		setGameState(GAME_STATE_NORMAL);
 	}
@@ -1417,9 +1429,7 @@ ReturnValue Game::internalRemoveItem(Item* item, int32_t count /*= -1*/, bool te
 
 		if (item->isRemoved()) {
 			item->onRemoved();
-			if (item->canDecay()) {
-				decayItems->remove(item);
-			}
+			stopDecay(item);
 			ReleaseItem(item);
 		}
 
@@ -2440,6 +2450,8 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, std::string
 		writeItem->resetDate();
 	}
 
+	writeItem->markHouseItemsDirty();
+
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
 		transformItem(writeItem, newId);
@@ -3452,14 +3464,13 @@ void Game::playerSay(uint32_t playerId, uint16_t channelId, SpeakClasses type,
 }
 
 bool Game::playerSaySpell(Player* player, SpeakClasses type, const std::string& text) {
-	std::string words = text;
-
-	TalkActionResult_t result = g_talkActions->playerSaySpell(player, type, words);
+	TalkActionResult_t result = g_talkActions->playerSaySpell(player, type, text);
 	if (result == TALKACTION_BREAK) {
 		return true;
 	}
 
-	result = g_spells->playerSaySpell(player, words);
+	std::string words;
+	result = g_spells->playerSaySpell(player, text, words);
 	if (result == TALKACTION_BREAK) {
 		if (!getBoolean(ConfigManager::EMOTE_SPELLS)) {
 			return internalCreatureSay(player, TALKTYPE_SAY, words, false);
@@ -3598,6 +3609,25 @@ void Game::getSpectatorsInInstance(SpectatorVec& spectators, const Position& cen
 #endif
 }
 
+void Game::filterSpectatorsInInstance(SpectatorVec& spectators, const SpectatorVec& from, const Position& centerPos,
+                                      [[maybe_unused]] InstanceId instanceId, bool multifloor /*= false*/, bool onlyPlayers /*= false*/) {
+	for (Creature* spectator : from) {
+		if (onlyPlayers && !spectator->getPlayer()) {
+			continue;
+		}
+
+#if ENABLE_INSTANCING
+		if (spectator->getInstanceId() != instanceId) {
+			continue;
+		}
+#endif
+
+		if (Map::isInSpectatorRange(centerPos, spectator->getPosition(), multifloor)) {
+			spectators.emplace_back(spectator);
+		}
+	}
+}
+
 bool Game::internalCreatureTurn(Creature* creature, Direction dir) {
         if (creature->getDirection() == dir) {
                 return false;
@@ -3701,22 +3731,26 @@ void Game::checkCreatureAttack(uint32_t creatureId) {
 }
 
 void Game::addCreatureCheck(Creature* creature) {
-	creature->creatureCheck = true;
-
-	if (creature->inCheckCreaturesVector) {
-		// already in a vector
+	// a sleeping creature is registered once it wakes up
+	if (creature->isSleeping()) {
 		return;
 	}
 
-	creature->inCheckCreaturesVector = true;
-	checkCreatureLists[uniform_random(0, EVENT_CREATURECOUNT - 1)].push_back(creature);
-	creature->incrementReferenceCounter();
+	uint8_t flags = 0;
+	if (creature->getAttackedCreature()) {
+		flags |= CreatureTickRegistry::FLAG_HAS_TARGET;
+	}
+	if (!creature->conditions.empty()) {
+		flags |= CreatureTickRegistry::FLAG_HAS_CONDITIONS;
+	}
+
+	if (creatureTicks.add(creature, uniform_random(0, EVENT_CREATURECOUNT - 1), flags)) {
+		creature->incrementReferenceCounter();
+	}
 }
 
 void Game::removeCreatureCheck(Creature* creature) {
-	if (creature->inCheckCreaturesVector) {
-		creature->creatureCheck = false;
-	}
+	creatureTicks.remove(creature);
 }
 
 void Game::checkCreatures(size_t index) {
@@ -3724,38 +3758,43 @@ void Game::checkCreatures(size_t index) {
 		checkCreatures((index + 1) % EVENT_CREATURECOUNT);
 	}));
 
-	auto& checkCreatureList = checkCreatureLists[index];
-	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
-	while (it != end) {
-		Creature* creature = *it;
-		if (creature->creatureCheck) {
-			if (!creature->isDead()) {
-				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
-				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
-				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+	creatureTicks.tick(index, [this](Creature* creature) {
+		if (creature->isDead()) {
+			return;
+		}
+
+		creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
+
+		// both flags are set when a target or condition is added and cleared here once gone
+		if (creatureTicks.hasFlag(creature, CreatureTickRegistry::FLAG_HAS_TARGET)) {
+			creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
+			if (!creature->getAttackedCreature()) {
+				creatureTicks.setFlag(creature, CreatureTickRegistry::FLAG_HAS_TARGET, false);
 			}
-			++it;
-		} else {
-			creature->inCheckCreaturesVector = false;
-			it = checkCreatureList.erase(it);
-			ReleaseCreature(creature);
 		}
-	}
+
+		if (creatureTicks.hasFlag(creature, CreatureTickRegistry::FLAG_HAS_CONDITIONS)) {
+			creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+			if (creature->conditions.empty()) {
+				creatureTicks.setFlag(creature, CreatureTickRegistry::FLAG_HAS_CONDITIONS, false);
+			}
+		}
+	});
 
 	cleanup();
 }
 
 void Game::updateCreaturesPath(size_t index) {
-	g_scheduler.addEvent(createSchedulerTask(getNumber(ConfigManager::PATHFINDING_INTERVAL), [=, this]() {
+	const uint32_t interval = g_tickBudget.scalePathfindingInterval(getNumber(ConfigManager::PATHFINDING_INTERVAL));
+	g_scheduler.addEvent(createSchedulerTask(interval, [=, this]() {
 		updateCreaturesPath((index + 1) % EVENT_CREATURECOUNT);
 	}));
 
-	auto& checkCreatureList = checkCreatureLists[index];
-	for (Creature* creature : checkCreatureList) {
+	creatureTicks.tick(index, [](Creature* creature) {
 		if (!creature->isDead()) {
 			creature->forceUpdatePath();
 		}
-	}
+	});
 }
 
 void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta) {
@@ -3982,8 +4021,17 @@ void Game::combatGetTypeInfo(CombatType_t combatType, Creature* target, TextColo
 	}
 }
 
-bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage) {
+bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage, const SpectatorVec* areaSpectators/* = nullptr*/) {
 	const Position& targetPos = target->getPosition();
+	// the recursive calls after health change scripts scan the map again, the scripts may have moved the target
+	auto getTargetSpectators = [&](SpectatorVec& spectators, bool multifloor) {
+		if (areaSpectators) {
+			filterSpectatorsInInstance(spectators, *areaSpectators, targetPos, target->getInstanceId(), multifloor, true);
+		} else {
+			getSpectatorsInInstance(spectators, targetPos, target->getInstanceId(), multifloor, true);
+		}
+	};
+
 	if (damage.primary.value > 0) {
 		if (target->isDead()) {
 			return false;
@@ -4026,8 +4074,8 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			message.primary.value = realHealthChange;
 			message.primary.color = TEXTCOLOR_PASTELRED;
 
-        SpectatorVec spectators;
-        getSpectatorsInInstance(spectators, targetPos, target->getInstanceId(), false, true);
+			SpectatorVec spectators;
+			getTargetSpectators(spectators, false);
 			for (Creature* spectator : spectators) {
 				assert(dynamic_cast<Player*>(spectator) != nullptr);
 				Player* spectatorPlayer = static_cast<Player*>(spectator);
@@ -4063,7 +4111,11 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 	} else {
 		if (!target->isAttackable()) {
 			if (!target->isInGhostMode()) {
-				addMagicEffect(targetPos, CONST_ME_POFF);
+				if (areaSpectators) {
+					addMagicEffect(*areaSpectators, targetPos, CONST_ME_POFF);
+				} else {
+					addMagicEffect(targetPos, CONST_ME_POFF);
+				}
 			}
 			return true;
 		}
@@ -4150,7 +4202,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 				}
 
 				targetPlayer->drainMana(attacker, manaDamage);
-                                getSpectatorsInInstance(spectators, targetPos, target->getInstanceId(), true, true);
+				getTargetSpectators(spectators, true);
 				addMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
 
 				std::string spectatorMessage;
@@ -4232,9 +4284,9 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			return true;
 		}
 
-                if (spectators.empty()) {
-                        getSpectatorsInInstance(spectators, targetPos, target->getInstanceId(), true, true);
-                }
+		if (spectators.empty()) {
+			getTargetSpectators(spectators, true);
+		}
 
 		message.primary.value = damage.primary.value;
 		message.secondary.value = damage.secondary.value;
@@ -4462,7 +4514,9 @@ void Game::addMagicEffect(const Position& pos, uint8_t effect) {
 void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect) {
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+			if (g_tickBudget.isEffectSent(tmpPlayer->getPosition(), pos)) {
+				tmpPlayer->sendMagicEffect(pos, effect);
+			}
 		}
 	}
 }
@@ -4479,7 +4533,10 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect) {
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			const Position& playerPos = tmpPlayer->getPosition();
+			if (g_tickBudget.isEffectSent(playerPos, fromPos) || g_tickBudget.isEffectSent(playerPos, toPos)) {
+				tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			}
 		}
 	}
 }
@@ -4566,6 +4623,29 @@ void Game::startDecay(Item* item) {
 	}
 }
 
+void Game::stopDecay(Item* item) {
+	if (!item->isDecayScheduled()) {
+		return;
+	}
+
+	item->setDuration(item->getDuration());
+	// a queued item keeps its place in decayQueue, the entry is skipped
+	item->setDecayQueued(false);
+	decayWheel.unschedule(item);
+	item->setDecaying(DECAYING_FALSE);
+	item->markHouseItemsDirty();
+	ReleaseItem(item);
+}
+
+void Game::setItemDuration(Item* item, int32_t duration) {
+	if (item->isDecayScheduled()) {
+		item->setDecayQueued(false);
+		decayWheel.schedule(item, OTSYS_TIME() + std::max<int32_t>(0, duration));
+	}
+	item->setDuration(duration);
+	item->markHouseItemsDirty();
+}
+
 void Game::internalDecayItem(Item* item) {
 	const int32_t decayTo = item->getDecayTo();
 	if (decayTo > 0) {
@@ -4583,46 +4663,66 @@ void Game::checkDecay() {
                 checkDecay();
         }));
 
-	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
+	// under critical load the items that do not block anything beyond a budget wait in decayQueue
+	const bool deferDecay = g_tickBudget.isDegraded(DEGRADED_DECAY);
+	size_t decayBudget = TickBudget::DECAY_BUDGET;
 
-	auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
-	while (it != end) {
-		Item* item = *it;
+	auto decay = [this](Item* item) {
 		if (!item->canDecay()) {
 			item->setDecaying(DECAYING_FALSE);
 			ReleaseItem(item);
-			it = decayItems[bucket].erase(it);
-			continue;
+			return;
 		}
 
-		int32_t duration = item->getDuration();
-		int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS, duration);
+		item->setDuration(0);
+		internalDecayItem(item);
+		ReleaseItem(item);
+	};
 
-		duration -= decreaseTime;
-		item->decreaseDuration(decreaseTime);
+	// the items deferred by earlier passes go first, in the order they came due
+	while (!decayQueue.empty() && (!deferDecay || decayBudget != 0)) {
+		Item* item = decayQueue.front();
+		decayQueue.pop_front();
 
-		if (duration <= 0) {
-			it = decayItems[bucket].erase(it);
-			internalDecayItem(item);
-			ReleaseItem(item);
-		} else if (duration < EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket = (bucket + ((duration + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAY_BUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				ReleaseItem(item);
-			} else {
-				decayItems[newBucket].push_back(item);
+		// not stopped or given a new duration while waiting
+		if (item->isDecayQueued()) {
+			item->setDecayQueued(false);
+			if (deferDecay) {
+				--decayBudget;
 			}
-		} else {
-			++it;
+			decay(item);
 		}
+
+		// the reference of the queue entry
+		ReleaseItem(item);
 	}
 
-	lastBucket = bucket;
+	// only the items expired since the last check are touched
+	decayWheel.advance(OTSYS_TIME(), [=, this, &decayBudget](Item* item) {
+		if (deferDecay && item->canDecay() && !item->isMagicField() && !item->isBlocking()) {
+			if (decayBudget == 0) {
+				item->incrementReferenceCounter();
+				item->setDecayQueued(true);
+				decayQueue.push_back(item);
+				return;
+			}
+			--decayBudget;
+		}
+
+		decay(item);
+	});
+
         cleanup();
 }
 
+void Game::checkLoad() {
+        g_scheduler.addEvent(createSchedulerTask(EVENT_LOADINTERVAL, [this]() {
+                checkLoad();
+        }));
+
+        g_tickBudget.update();
+}
+
 void Game::checkPressure() {
         g_scheduler.addEvent(createSchedulerTask(60000, [this]() {
                 checkPressure();
@@ -4683,6 +4783,7 @@ void Game::shutdown() {
                 std::cout << "[Pressure] " << sErr << std::endl;
         }
 
+        g_stateJournal.shutdown();
         g_scheduler.shutdown();
         g_databaseTasks.shutdown();
         g_dispatcher.shutdown();
@@ -4711,12 +4812,11 @@ void Game::cleanup() {
 	}
 	ToReleaseItems.clear();
 
+	const int64_t now = OTSYS_TIME();
 	for (Item* item : toDecayItems) {
-		const uint32_t dur = item->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			decayItems[lastBucket].push_back(item);
-		} else {
-			decayItems[(lastBucket + 1 + dur / 1000) % EVENT_DECAY_BUCKETS].push_back(item);
+		if (!decayWheel.schedule(item, now + item->getDuration())) {
+			// queued twice, the wheel holds a single reference
+			item->decrementReferenceCounter();
 		}
 	}
 	toDecayItems.clear();
@@ -5221,7 +5321,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		const auto debitCash = std::min(playerMoney, fee);
 		const auto debitBank = fee - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 	} else {
 		uint64_t totalPrice = static_cast<uint64_t>(price) * amount;
 		totalPrice += fee;
@@ -5232,7 +5332,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		const auto debitCash = std::min(playerMoney, totalPrice);
 		const auto debitBank = totalPrice - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 	}
 
 	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
@@ -5259,7 +5359,7 @@ void Game::playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 	}
 
 	if (offer.type == MARKETACTION_BUY) {
-		player->bankBalance += static_cast<uint64_t>(offer.price) * offer.amount;
+		player->setBankBalance(player->getBankBalance() + static_cast<uint64_t>(offer.price) * offer.amount);
 		player->sendMarketEnter(player->getLastDepotId());
 	} else {
 		const ItemType& it = Item::items[offer.itemId];
@@ -5378,7 +5478,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			}
 		}
 
-		player->bankBalance += totalPrice;
+		player->setBankBalance(player->getBankBalance() + totalPrice);
 
 		if (it.stackable) {
 			uint16_t tmpAmount = amount;
@@ -5424,7 +5524,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		const auto debitCash = std::min(playerMoney, totalPrice);
 		const auto debitBank = totalPrice - debitCash;
 		removeMoney(player, debitCash);
-		player->bankBalance -= debitBank;
+		player->setBankBalance(player->getBankBalance() - debitBank);
 
 		if (it.stackable) {
 			uint16_t tmpAmount = amount;
@@ -5457,7 +5557,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 		Player* sellerPlayer = getPlayerByGUID(offer.playerId);
 		if (sellerPlayer) {
-			sellerPlayer->bankBalance += totalPrice;
+			sellerPlayer->setBankBalance(sellerPlayer->getBankBalance() + totalPrice);
 		} else {
 			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
 		}
@@ -5735,6 +5835,14 @@ void Game::removeUniqueItem(uint16_t uniqueId) {
 bool Game::reload(ReloadTypes_t reloadType) {
 	switch (reloadType) {
 		case RELOAD_TYPE_ACTIONS: return g_actions->reload();
+		case RELOAD_TYPE_BANS: {
+			IOBan::reloadBans();
+			return true;
+		}
+		case RELOAD_TYPE_CHANGED_SCRIPTS: {
+			g_scripts->reloadChangedScripts("scripts");
+			return true;
+		}
 		case RELOAD_TYPE_CHAT: return g_chat->load();
 		case RELOAD_TYPE_CONFIG: return ConfigManager::reload();
 		case RELOAD_TYPE_CREATURESCRIPTS: {
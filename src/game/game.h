@@ -45,7 +45,7 @@ static constexpr int32_t PLAYER_NAME_LENGTH = 25;
 static constexpr int32_t EVENT_LIGHTINTERVAL = 10000;
 static constexpr int32_t EVENT_WORLDTIMEINTERVAL = 2500;
 static constexpr int32_t EVENT_DECAYINTERVAL = 250;
-static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
+static constexpr int32_t EVENT_LOADINTERVAL = 1000;
 
 static constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 
@@ -206,7 +206,10 @@ class Game {
 		void executeDeath(uint32_t creatureId);
 
 		void addCreatureCheck(Creature* creature);
-		static void removeCreatureCheck(Creature* creature);
+		void removeCreatureCheck(Creature* creature);
+		void setCreatureCheckFlag(Creature* creature, CreatureTickRegistry::Flag flag) {
+			creatureTicks.setFlag(creature, flag, true);
+		}
 
 		size_t getPlayersOnline() const {
 			return players.size();
@@ -421,6 +424,9 @@ class Game {
                                              bool multifloor = false, bool onlyPlayers = false,
                                              int32_t minRangeX = 0, int32_t maxRangeX = 0,
                                              int32_t minRangeY = 0, int32_t maxRangeY = 0);
+                // getSpectatorsInInstance with the default range, picked from spectators gathered before for a range containing it
+                static void filterSpectatorsInInstance(SpectatorVec& spectators, const SpectatorVec& from, const Position& centerPos,
+                                                       InstanceId instanceId, bool multifloor = false, bool onlyPlayers = false);
 
                 void changeSpeed(Creature* creature, int32_t varSpeedDelta);
 		void internalCreatureChangeOutfit(Creature* creature, const Outfit_t& outfit);
@@ -445,12 +451,16 @@ class Game {
                 void updateCreaturesPath(size_t index);
                 void checkLight();
                 void checkPressure();
+                void checkLoad();
 
                 bool combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor, bool field, bool ignoreResistances = false);
 
 		void combatGetTypeInfo(CombatType_t combatType, Creature* target, TextColor_t& color, uint8_t& effect);
 
-		bool combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage);
+		/**
+		 * @param areaSpectators spectators of a whole area combat, the target's are picked from them instead of scanning the map again
+		 */
+		bool combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage, const SpectatorVec* areaSpectators = nullptr);
 		bool combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage);
 
 		//animation help functions
@@ -467,6 +477,12 @@ class Game {
 		bool saveAccountStorageValues() const;
 
 		void startDecay(Item* item);
+		// unschedules a decaying item, keeping the duration it has left
+		void stopDecay(Item* item);
+		// sets the duration left of the item, a decaying item goes on decaying with it
+		void setItemDuration(Item* item, int32_t duration);
+		// decays the items that came due, every EVENT_DECAYINTERVAL
+		void checkDecay();
 
 		int16_t getWorldTime() { return worldTime; }
 		void updateWorldTime();
@@ -539,7 +555,6 @@ class Game {
 		bool playerSpeakTo(Player* player, SpeakClasses type, const std::string& receiver, const std::string& text);
 		void playerSpeakToNpc(Player* player, const std::string& text);
 
-		void checkDecay();
 		void internalDecayItem(Item* item);
 
 		std::unordered_map<uint32_t, Player*> players;
@@ -549,14 +564,14 @@ class Game {
 		std::unordered_map<uint16_t, Item*> uniqueItems;
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, int32_t>> accountStorageMap;
 
-		std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
-		std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+		TimingWheel<Item> decayWheel{EVENT_DECAYINTERVAL, OTSYS_TIME()};
+		// items whose decay came due beyond the budget of a degraded pass, see checkDecay
+		std::deque<Item*> decayQueue;
+		CreatureTickRegistry creatureTicks{[this](Creature* creature) { ReleaseCreature(creature); }};
 
 		std::vector<Creature*> ToReleaseCreatures;
 		std::vector<Item*> ToReleaseItems;
 
-		size_t lastBucket = 0;
-
 		WildcardTreeNode wildcardTree { false };
 
 		std::map<uint32_t, Npc*> npcs;
@@ -42,6 +42,29 @@ void GlobalEvents::clear(bool fromLua) {
 	reInitState(fromLua);
 }
 
+void GlobalEvents::removeScriptEvents(ScriptEventSet& events) {
+	for (GlobalEventMap* map : {&thinkMap, &serverMap, &timerMap}) {
+		for (auto it = map->begin(); it != map->end();) {
+			if (events.claim(it->second)) {
+				it = map->erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	// an empty map is not rescheduled, let the next registration start it again
+	if (thinkMap.empty()) {
+		g_scheduler.stopEvent(thinkEventId);
+		thinkEventId = 0;
+	}
+
+	if (timerMap.empty()) {
+		g_scheduler.stopEvent(timerEventId);
+		timerEventId = 0;
+	}
+}
+
 Event_ptr GlobalEvents::getEvent(const std::string& nodeName) {
 	if (!caseInsensitiveEqual(nodeName, "globalevent")) {
 		return nullptr;
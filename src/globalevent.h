@@ -44,6 +44,7 @@ class GlobalEvents final : public BaseEvents {
 
 		bool registerLuaEvent(GlobalEvent* event);
 		void clear(bool fromLua) override final;
+		void removeScriptEvents(ScriptEventSet& events);
 
 	private:
 		std::string_view getScriptBaseName() const override {
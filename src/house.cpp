@@ -12,6 +12,7 @@
 #include "inbox.h"
 #include "iologindata.h"
 #include "pugicast.h"
+#include "statejournal.h"
 
 extern Game g_game;
 
@@ -22,6 +23,11 @@ void House::addTile(HouseTile* tile) {
 	houseTiles.push_back(tile);
 }
 
+void House::markItemsDirty() {
+	itemsDirty = true;
+	g_stateJournal.houseItemsChanged(this);
+}
+
 void House::setOwner(uint32_t guid, bool updateDatabase/* = true*/, Player* player/* = nullptr*/) {
 	if (updateDatabase && owner != guid) {
 		Database& db = Database::getInstance();
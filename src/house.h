@@ -206,6 +206,16 @@ class House {
 			return static_cast<uint32_t>(std::ceil(bedsList.size() / 2.)); //each bed takes 2 sqms of space, ceil is just for bad maps
 		}
 
+		// tracks item changes on the house tiles so that a save only rewrites
+		// the tile_store rows of houses that actually changed
+		void markItemsDirty();
+		bool hasDirtyItems() const {
+			return itemsDirty;
+		}
+		void resetDirtyItems() {
+			itemsDirty = false;
+		}
+
 	private:
 		bool transferToDepot() const;
 		bool transferToDepot(Player* player) const;
@@ -236,6 +246,7 @@ class House {
 		Position posEntry = {};
 
 		bool isLoaded = false;
+		bool itemsDirty = false;
 };
 
 using HouseMap = std::map<uint32_t, House*>;
@@ -38,6 +38,22 @@ void HouseTile::internalAddThing(uint32_t index, Thing* thing) {
 	}
 }
 
+void HouseTile::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_t index, cylinderlink_t link /*= LINK_OWNER*/) {
+	if (thing->getItem()) {
+		house->markItemsDirty();
+	}
+
+	Tile::postAddNotification(thing, oldParent, index, link);
+}
+
+void HouseTile::postRemoveNotification(Thing* thing, const Cylinder* newParent, int32_t index, cylinderlink_t link /*= LINK_OWNER*/) {
+	if (thing->getItem()) {
+		house->markItemsDirty();
+	}
+
+	Tile::postRemoveNotification(thing, newParent, index, link);
+}
+
 void HouseTile::updateHouse(Item* item) {
 	if (item->getParent() != this) {
 		return;
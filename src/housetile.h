@@ -24,6 +24,9 @@ class HouseTile final : public DynamicTile {
 		void addThing(int32_t index, Thing* thing) override;
 		void internalAddThing(uint32_t index, Thing* thing) override;
 
+		void postAddNotification(Thing* thing, const Cylinder* oldParent, int32_t index, cylinderlink_t link = LINK_OWNER) override;
+		void postRemoveNotification(Thing* thing, const Cylinder* newParent, int32_t index, cylinderlink_t link = LINK_OWNER) override;
+
 		House* getHouse() const {
 			return house;
 		}
@@ -5,6 +5,7 @@
 
 #include "inbox.h"
 
+#include "statejournal.h"
 #include "tools.h"
 
 Inbox::Inbox(uint16_t type) : Container(type, 30, false, true) {}
@@ -36,6 +37,11 @@ void Inbox::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_t
 	if (parent) {
 		parent->postAddNotification(thing, oldParent, index, LINK_PARENT);
 	}
+
+	// the locker forwards to its tile, so the owner never hears of it
+	if (thing->getItem()) {
+		g_stateJournal.playerItemsChanged(ownerId);
+	}
 }
 
 void Inbox::postRemoveNotification(Thing* thing, const Cylinder* newParent, int32_t index, cylinderlink_t) {
@@ -43,6 +49,10 @@ void Inbox::postRemoveNotification(Thing* thing, const Cylinder* newParent, int3
 	if (parent) {
 		parent->postRemoveNotification(thing, newParent, index, LINK_PARENT);
 	}
+
+	if (thing->getItem()) {
+		g_stateJournal.playerItemsChanged(ownerId);
+	}
 }
 
 Cylinder* Inbox::getParent() const {
@@ -14,6 +14,10 @@ class Inbox final : public Container {
 	public:
 		explicit Inbox(uint16_t type);
 
+		void setOwnerId(uint32_t guid) {
+			ownerId = guid;
+		}
+
 		// Cylinder implementations
 		ReturnValue queryAdd(int32_t index, const Thing& thing, uint32_t count,
 				uint32_t flags, Creature* actor = nullptr) const override;
@@ -34,6 +38,10 @@ class Inbox final : public Container {
 		Cylinder* getRealParent() const override {
 			return parent;
 		}
+
+	private:
+		// guid of the player whose items this holds, journaled on every change
+		uint32_t ownerId = 0;
 };
 
 #endif // FS_INBOX_H
\ No newline at end of file
@@ -12,10 +12,74 @@
 #include "game/InstanceManager.h"
 
 #include "inbox.h"
+#include "statejournal.h"
 #include "storeinbox.h"
 
 extern Game g_game;
 
+namespace {
+
+enum PlayerItemTable_t : uint8_t {
+	PLAYER_ITEMS_INVENTORY,
+	PLAYER_ITEMS_DEPOT,
+	PLAYER_ITEMS_INBOX,
+	PLAYER_ITEMS_STOREINBOX,
+};
+
+constexpr std::array<std::string_view, 4> playerItemTables = {"player_items", "player_depotitems", "player_inboxitems", "player_storeinboxitems"};
+
+// walks the item tree in the (pid, sid) order the item tables are stored in
+template <typename Callback>
+bool forEachItemRow(const ItemBlockList& itemList, PropWriteStream& propWriteStream, Callback&& callback) {
+	using ContainerBlock = std::pair<Container*, int32_t>;
+	std::vector<ContainerBlock> containers;
+	containers.reserve(32);
+
+	int32_t runningId = 100;
+
+	for (const auto& it : itemList) {
+		int32_t pid = it.first;
+		Item* item = it.second;
+		++runningId;
+
+		propWriteStream.clear();
+		item->serializeAttr(propWriteStream);
+
+		if (!callback(pid, runningId, item, propWriteStream.getStream())) {
+			return false;
+		}
+
+		if (Container* container = item->getContainer()) {
+			containers.emplace_back(container, runningId);
+		}
+	}
+
+	for (size_t i = 0; i < containers.size(); i++) {
+		const ContainerBlock& cb = containers[i];
+		Container* container = cb.first;
+		int32_t parentId = cb.second;
+
+		for (Item* item : container->getItemList()) {
+			++runningId;
+
+			Container* subContainer = item->getContainer();
+			if (subContainer) {
+				containers.emplace_back(subContainer, runningId);
+			}
+
+			propWriteStream.clear();
+			item->serializeAttr(propWriteStream);
+
+			if (!callback(parentId, runningId, item, propWriteStream.getStream())) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
 std::string decodeSecret(std::string_view secret) {
 	// simple base32 decoding
 	std::string key;
@@ -527,52 +591,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result) {
 }
 
 bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream) {
-	using ContainerBlock = std::pair<Container*, int32_t>;
-	std::vector<ContainerBlock> containers;
-	containers.reserve(32);
-
-	int32_t runningId = 100;
-
 	Database& db = Database::getInstance();
-	for (const auto& it : itemList) {
-		int32_t pid = it.first;
-		Item* item = it.second;
-		++runningId;
-
-		propWriteStream.clear();
-		item->serializeAttr(propWriteStream);
-
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
-			return false;
-		}
-
-		if (Container* container = item->getContainer()) {
-			containers.emplace_back(container, runningId);
-		}
-	}
-
-	for (size_t i = 0; i < containers.size(); i++) {
-		const ContainerBlock& cb = containers[i];
-		Container* container = cb.first;
-		int32_t parentId = cb.second;
-
-		for (Item* item : container->getItemList()) {
-			++runningId;
-
-			Container* subContainer = item->getContainer();
-			if (subContainer) {
-				containers.emplace_back(subContainer, runningId);
-			}
-
-			propWriteStream.clear();
-			item->serializeAttr(propWriteStream);
-
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId, runningId, item->getID(), item->getSubType(), db.escapeString(propWriteStream.getStream())))) {
-				return false;
-			}
-		}
-	}
-	return query_insert.execute();
+	bool rowsAdded = forEachItemRow(itemList, propWriteStream, [&](int32_t pid, int32_t sid, const Item* item, std::string_view attributes) {
+		return query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, sid, item->getID(), item->getSubType(), db.escapeString(attributes)));
+	});
+	return rowsAdded && query_insert.execute();
 }
 
 bool IOLoginData::savePlayer(Player* player) {
@@ -834,7 +857,99 @@ bool IOLoginData::savePlayer(Player* player) {
 	}
 
 	//End the transaction
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	g_stateJournal.playerSaved(player->getGUID());
+	return true;
+}
+
+void IOLoginData::serializePlayerItems(Player* player, PropWriteStream& stream) {
+	PropWriteStream propWriteStream;
+	auto writeTable = [&](PlayerItemTable_t table, const ItemBlockList& itemList) {
+		stream.write<uint8_t>(table);
+		forEachItemRow(itemList, propWriteStream, [&](int32_t pid, int32_t sid, const Item* item, std::string_view attributes) {
+			stream.write<uint8_t>(1);
+			stream.write<int32_t>(pid);
+			stream.write<int32_t>(sid);
+			stream.write<uint16_t>(item->getID());
+			stream.write<uint16_t>(item->getSubType());
+			stream.writeBlob(attributes);
+			return true;
+		});
+		stream.write<uint8_t>(0);
+	};
+
+	ItemBlockList itemList;
+	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
+		if (Item* item = player->inventory[slotId]) {
+			itemList.emplace_back(slotId, item);
+		}
+	}
+	writeTable(PLAYER_ITEMS_INVENTORY, itemList);
+
+	if (player->lastDepotId != -1) {
+		itemList.clear();
+		for (const auto& it : player->depotChests) {
+			for (Item* item : it.second->getItemList()) {
+				itemList.emplace_back(it.first, item);
+			}
+		}
+		writeTable(PLAYER_ITEMS_DEPOT, itemList);
+	}
+
+	itemList.clear();
+	for (Item* item : player->getInbox()->getItemList()) {
+		itemList.emplace_back(0, item);
+	}
+	writeTable(PLAYER_ITEMS_INBOX, itemList);
+
+	itemList.clear();
+	for (Item* item : player->getStoreInbox()->getItemList()) {
+		itemList.emplace_back(0, item);
+	}
+	writeTable(PLAYER_ITEMS_STOREINBOX, itemList);
+}
+
+bool IOLoginData::restorePlayerItems(uint32_t guid, PropStream& propStream) {
+	Database& db = Database::getInstance();
+
+	uint8_t table;
+	while (propStream.read<uint8_t>(table)) {
+		if (table >= playerItemTables.size()) {
+			return false;
+		}
+
+		if (!db.executeQuery(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d}", playerItemTables[table], guid))) {
+			return false;
+		}
+
+		DBInsert query(fmt::format("INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", playerItemTables[table]));
+
+		uint8_t hasRow;
+		while (propStream.read<uint8_t>(hasRow) && hasRow != 0) {
+			int32_t pid, sid;
+			uint16_t type, count;
+			if (!propStream.read<int32_t>(pid) || !propStream.read<int32_t>(sid) || !propStream.read<uint16_t>(type) || !propStream.read<uint16_t>(count)) {
+				return false;
+			}
+
+			auto [attributes, ok] = propStream.readBlob();
+			if (!ok) {
+				return false;
+			}
+
+			if (!query.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", guid, pid, sid, type, count, db.escapeString(attributes)))) {
+				return false;
+			}
+		}
+
+		if (!query.execute()) {
+			return false;
+		}
+	}
+	return true;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid) {
@@ -9,6 +9,7 @@
 
 class Item;
 class Player;
+class PropStream;
 class PropWriteStream;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
@@ -44,6 +45,10 @@ class IOLoginData {
 
 		static void updatePremiumTime(uint32_t accountId, time_t endTime);
 
+		// compact item snapshots used by the state journal
+		static void serializePlayerItems(Player* player, PropWriteStream& stream);
+		static bool restorePlayerItems(uint32_t guid, PropStream& propStream);
+
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
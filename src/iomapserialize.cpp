@@ -8,76 +8,254 @@
 #include "bed.h"
 #include "game/game.h"
 #include "housetile.h"
+#include "statejournal.h"
+#include "utils/StartupProbe.h"
 
 extern Game g_game;
 
+struct IOMapSerialize::DecodedTile {
+	// a run of items decoded into a detached tree, or left for the dispatcher
+	// to load from the raw row data (item is nullptr) when decoding it
+	// requires the map or global state
+	struct Entry {
+		Item* item;
+		uint32_t begin;
+		uint32_t end;
+		uint32_t count;
+	};
+
+	std::string data;
+	std::vector<Entry> entries;
+	uint16_t x = 0;
+	uint16_t y = 0;
+	uint8_t z = 0;
+	bool valid = false;
+};
+
 void IOMapSerialize::loadHouseItems(Map* map) {
 	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
-	if (!result) {
-		return;
+	// rows are streamed from the database and decoded by a pool of workers
+	// while the remaining rows are still being received
+	std::list<DecodedTile> tiles;
+	std::deque<DecodedTile*> queue;
+	std::mutex queueLock;
+	std::condition_variable queueSignal;
+	bool streaming = true;
+
+	std::vector<std::thread> workers(std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+	for (std::thread& worker : workers) {
+		worker = std::thread([&]() {
+			std::unique_lock<std::mutex> lock(queueLock);
+			while (true) {
+				queueSignal.wait(lock, [&]() { return !queue.empty() || !streaming; });
+				if (queue.empty()) {
+					return;
+				}
+
+				DecodedTile* tile = queue.front();
+				queue.pop_front();
+
+				lock.unlock();
+				decodeTile(*tile);
+				lock.lock();
+			}
+		});
 	}
 
-	do {
-		auto attr = result->getString("data");
+	if (DBResult_ptr result = Database::getInstance().useQuery("SELECT `data` FROM `tile_store`")) {
+		do {
+			DecodedTile& tile = tiles.emplace_back();
+			tile.data = result->getString("data");
 
-		PropStream propStream;
-		propStream.init(attr.data(), attr.size());
+			{
+				std::lock_guard<std::mutex> lock(queueLock);
+				queue.push_back(&tile);
+			}
+			queueSignal.notify_one();
+		} while (result->next());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		streaming = false;
+	}
+	queueSignal.notify_all();
 
-		uint16_t x, y;
-		uint8_t z;
-		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	StartupProbe::mark("house_items_decode");
+
+	for (DecodedTile& decoded : tiles) {
+		if (!decoded.valid) {
 			continue;
 		}
 
-		Tile* tile = map->getTile(x, y, z);
-		if (!tile) {
-			continue;
+		Tile* tile = map->getTile(decoded.x, decoded.y, decoded.z);
+		for (const DecodedTile::Entry& entry : decoded.entries) {
+			if (!tile) {
+				delete entry.item;
+			} else if (entry.item) {
+				tile->internalAddThing(entry.item);
+				entry.item->startDecaying();
+			} else {
+				PropStream propStream;
+				propStream.init(decoded.data.data() + entry.begin, entry.end - entry.begin);
+				for (uint32_t i = 0; i < entry.count; ++i) {
+					loadItem(propStream, tile);
+				}
+			}
 		}
+	}
+	StartupProbe::mark("house_items_attach");
 
-		uint32_t item_count;
-		if (!propStream.read<uint32_t>(item_count)) {
-			continue;
+	std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+}
+
+void IOMapSerialize::decodeTile(DecodedTile& decoded) {
+	PropStream propStream;
+	propStream.init(decoded.data.data(), decoded.data.size());
+
+	uint32_t itemCount;
+	if (!propStream.read<uint16_t>(decoded.x) || !propStream.read<uint16_t>(decoded.y) || !propStream.read<uint8_t>(decoded.z) || !propStream.read<uint32_t>(itemCount)) {
+		return;
+	}
+
+	decoded.valid = true;
+
+	auto position = [&]() {
+		return static_cast<uint32_t>(decoded.data.size() - propStream.size());
+	};
+
+	while (itemCount > 0) {
+		const uint32_t begin = position();
+
+		uint16_t id;
+		PropStream peek = propStream;
+		if (!peek.read<uint16_t>(id)) {
+			return;
 		}
 
-		while (item_count--) {
-			loadItem(propStream, tile);
+		DetachedItemLoad load;
+		Item* item = nullptr;
+		if (!decodeItem(propStream, item)) {
+			// let the dispatcher go through the rest of the row like it always did
+			decoded.entries.push_back({nullptr, begin, static_cast<uint32_t>(decoded.data.size()), itemCount});
+			return;
 		}
-	} while (result->next());
-	std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+
+		// stationary items (doors, beds, ...) are matched against the map items
+		const ItemType& it = Item::items[id];
+		if (item && (load.deferred || !(it.moveable || it.forceSerialize))) {
+			delete item;
+			item = nullptr;
+		}
+
+		decoded.entries.push_back({item, begin, position(), 1});
+		--itemCount;
+	}
+}
+
+bool IOMapSerialize::decodeItem(PropStream& propStream, Item*& item) {
+	uint16_t id;
+	if (!propStream.read<uint16_t>(id)) {
+		return false;
+	}
+
+	item = Item::CreateItem(id);
+	if (!item) {
+		return true;
+	}
+
+	if (!item->unserializeAttr(propStream)) {
+		std::cout << "WARNING: Unserialization error in IOMapSerialize::loadItem()" << id << std::endl;
+		delete item;
+		item = nullptr;
+		return false;
+	}
+
+	Container* container = item->getContainer();
+	if (container && !decodeContainer(propStream, container)) {
+		delete item;
+		item = nullptr;
+		return false;
+	}
+	return true;
+}
+
+bool IOMapSerialize::decodeContainer(PropStream& propStream, Container* container) {
+	while (container->serializationCount > 0) {
+		Item* item;
+		if (!decodeItem(propStream, item)) {
+			std::cout << "[Warning - IOMapSerialize::loadContainer] Unserialization error for container item: " << container->getID() << std::endl;
+			return false;
+		}
+
+		if (item) {
+			container->internalAddThing(item);
+		}
+		container->serializationCount--;
+	}
+
+	uint8_t endAttr;
+	if (!propStream.read<uint8_t>(endAttr) || endAttr != 0) {
+		std::cout << "[Warning - IOMapSerialize::loadContainer] Unserialization error for container item: " << container->getID() << std::endl;
+		return false;
+	}
+	return true;
 }
 
 bool IOMapSerialize::saveHouseItems() {
 	int64_t start = OTSYS_TIME();
 	Database& db = Database::getInstance();
 
+	// only houses whose items changed since their last save are rewritten
+	std::vector<House*> dirtyHouses;
+	std::ostringstream houseIds;
+	std::ostringstream loadedHouseIds;
+	for (const auto& it : g_game.map.houses.getHouses()) {
+		House* house = it.second;
+		if (loadedHouseIds.tellp() > 0) {
+			loadedHouseIds << ',';
+		}
+		loadedHouseIds << house->getId();
+
+		if (!house->hasDirtyItems()) {
+			continue;
+		}
+
+		if (!dirtyHouses.empty()) {
+			houseIds << ',';
+		}
+		houseIds << house->getId();
+		dirtyHouses.push_back(house);
+	}
+
 	//Start the transaction
 	DBTransaction transaction;
 	if (!transaction.begin()) {
 		return false;
 	}
 
+	//clear the tile data of houses that are no longer on the map
+	if (loadedHouseIds.tellp() > 0) {
+		if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` NOT IN ({:s})", loadedHouseIds.str()))) {
+			return false;
+		}
+	} else if (!db.executeQuery("DELETE FROM `tile_store`")) {
+		return false;
+	}
+
 	//clear old tile data
-	if (!db.executeQuery("DELETE FROM `tile_store`")) {
+	if (!dirtyHouses.empty() && !db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` IN ({:s})", houseIds.str()))) {
 		return false;
 	}
 
 	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
-
-	PropWriteStream stream;
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		//save house items
-		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
-			saveTile(stream, tile);
-
-			if (auto attributes = stream.getStream(); !attributes.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)))) {
-					return false;
-				}
-				stream.clear();
-			}
+	for (const House* house : dirtyHouses) {
+		if (!saveHouseTiles(stmt, house)) {
+			return false;
 		}
 	}
 
@@ -86,10 +264,18 @@ bool IOMapSerialize::saveHouseItems() {
 	}
 
 	//End the transaction
-	bool success = transaction.commit();
-	std::cout << "> Saved house items in: " <<
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	for (House* house : dirtyHouses) {
+		house->resetDirtyItems();
+		g_stateJournal.houseSaved(house->getId());
+	}
+
+	std::cout << "> Saved items of " << dirtyHouses.size() << " houses in: " <<
 	          (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
-	return success;
+	return true;
 }
 
 bool IOMapSerialize::loadContainer(PropStream& propStream, Container* container) {
@@ -336,6 +522,23 @@ bool IOMapSerialize::saveHouseInfo() {
 	return transaction.commit();
 }
 
+bool IOMapSerialize::saveHouseTiles(DBInsert& stmt, const House* house) {
+	Database& db = Database::getInstance();
+
+	PropWriteStream stream;
+	for (const HouseTile* tile : house->getTiles()) {
+		saveTile(stream, tile);
+
+		if (auto attributes = stream.getStream(); !attributes.empty()) {
+			if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)))) {
+				return false;
+			}
+			stream.clear();
+		}
+	}
+	return true;
+}
+
 bool IOMapSerialize::saveHouse(House* house) {
 	Database& db = Database::getInstance();
 
@@ -353,23 +556,48 @@ bool IOMapSerialize::saveHouse(House* house) {
 	}
 
 	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
+	if (!saveHouseTiles(stmt, house) || !stmt.execute()) {
+		return false;
+	}
 
-	PropWriteStream stream;
-	for (HouseTile* tile : house->getTiles()) {
-		saveTile(stream, tile);
+	//End the transaction
+	if (!transaction.commit()) {
+		return false;
+	}
 
-		if (auto attributes = stream.getStream(); attributes.size() > 0) {
-			if (!stmt.addRow(fmt::format("{:d}, {:s}", houseId, db.escapeString(attributes)))) {
-				return false;
-			}
-			stream.clear();
+	house->resetDirtyItems();
+	g_stateJournal.houseSaved(houseId);
+	return true;
+}
+
+void IOMapSerialize::serializeHouseItems(const House* house, PropWriteStream& stream) {
+	PropWriteStream tileStream;
+	for (const HouseTile* tile : house->getTiles()) {
+		saveTile(tileStream, tile);
+
+		if (auto attributes = tileStream.getStream(); !attributes.empty()) {
+			stream.writeBlob(attributes);
+			tileStream.clear();
 		}
 	}
+}
 
-	if (!stmt.execute()) {
+bool IOMapSerialize::restoreHouseItems(uint32_t houseId, PropStream& propStream) {
+	Database& db = Database::getInstance();
+	if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` = {:d}", houseId))) {
 		return false;
 	}
 
-	//End the transaction
-	return transaction.commit();
+	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
+	while (propStream.size() > 0) {
+		auto [attributes, ok] = propStream.readBlob();
+		if (!ok) {
+			return false;
+		}
+
+		if (!stmt.addRow(fmt::format("{:d}, {:s}", houseId, db.escapeString(attributes)))) {
+			return false;
+		}
+	}
+	return stmt.execute();
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 class Container;
 class Cylinder;
+class DBInsert;
 class House;
 class Item;
 class Map;
@@ -20,11 +21,24 @@ class IOMapSerialize {
 		static bool loadHouseInfo();
 		static bool saveHouseInfo();
 
+		// rewrites the tile_store rows of a single house, regardless of whether it is dirty
 		static bool saveHouse(House* house);
 
+		// compact item snapshots used by the state journal
+		static void serializeHouseItems(const House* house, PropWriteStream& stream);
+		static bool restoreHouseItems(uint32_t houseId, PropStream& propStream);
+
 	private:
+		struct DecodedTile;
+
+		// decoding of tile_store rows into detached items, safe off the dispatcher
+		static void decodeTile(DecodedTile& decoded);
+		static bool decodeItem(PropStream& propStream, Item*& item);
+		static bool decodeContainer(PropStream& propStream, Container* container);
+
 		static void saveItem(PropWriteStream& stream, const Item* item);
 		static void saveTile(PropWriteStream& stream, const Tile* tile);
+		static bool saveHouseTiles(DBInsert& stmt, const House* house);
 
 		static bool loadContainer(PropStream& propStream, Container* container);
 		static bool loadItem(PropStream& propStream, Cylinder* parent);
@@ -14,52 +14,131 @@
 
 extern Game g_game;
 
+void IOMarket::loadOffers() {
+	offers.clear();
+	for (auto& offerIndex : itemOffers) {
+		offerIndex.clear();
+	}
+	playerOffers.clear();
+	counterOffers.clear();
+	nextOfferId = 1;
+
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers`");
+	if (!result) {
+		return;
+	}
+
+	do {
+		Offer offer;
+		offer.id = result->getNumber<uint32_t>("id");
+		offer.playerId = result->getNumber<uint32_t>("player_id");
+		offer.created = result->getNumber<uint32_t>("created");
+		offer.price = result->getNumber<uint32_t>("price");
+		offer.amount = result->getNumber<uint16_t>("amount");
+		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.type = result->getNumber<uint16_t>("sale") == MARKETACTION_BUY ? MARKETACTION_BUY : MARKETACTION_SELL;
+		offer.anonymous = result->getNumber<uint16_t>("anonymous") != 0;
+		offer.playerName = result->getString("player_name");
+
+		nextOfferId = std::max(nextOfferId, offer.id + 1);
+		addOffer(std::move(offer));
+	} while (result->next());
+}
+
+void IOMarket::addOffer(Offer&& offer) {
+	const uint32_t offerId = offer.id;
+	itemOffers[offer.type][offer.itemId].insert(offerId);
+	playerOffers[offer.playerId].insert(offerId);
+	counterOffers.emplace(std::make_pair(offer.created, static_cast<uint16_t>(offerId & 0xFFFF)), offerId);
+	offers.emplace(offerId, std::move(offer));
+}
+
+std::optional<IOMarket::Offer> IOMarket::removeOffer(uint32_t offerId) {
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return std::nullopt;
+	}
+
+	Offer offer = std::move(it->second);
+	offers.erase(it);
+
+	auto& sameItem = itemOffers[offer.type];
+	if (auto itemIt = sameItem.find(offer.itemId); itemIt != sameItem.end()) {
+		itemIt->second.erase(offerId);
+		if (itemIt->second.empty()) {
+			sameItem.erase(itemIt);
+		}
+	}
+
+	if (auto playerIt = playerOffers.find(offer.playerId); playerIt != playerOffers.end()) {
+		playerIt->second.erase(offerId);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
+		}
+	}
+
+	auto counterIt = counterOffers.find(std::make_pair(offer.created, static_cast<uint16_t>(offerId & 0xFFFF)));
+	if (counterIt != counterOffers.end() && counterIt->second == offerId) {
+		counterOffers.erase(counterIt);
+	}
+	return offer;
+}
+
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId) {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}", static_cast<int>(action), itemId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.itemOffers[action].find(itemId);
+	if (it == market.itemOffers[action].end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
-		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = itemId;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+	for (uint32_t offerId : it->second) {
+		const Offer& offer = market.offers.at(offerId);
+
+		MarketOffer marketOffer;
+		marketOffer.amount = offer.amount;
+		marketOffer.price = offer.price;
+		marketOffer.timestamp = offer.created + marketOfferDuration;
+		marketOffer.counter = offer.id & 0xFFFF;
+		marketOffer.itemId = itemId;
+		if (!offer.anonymous) {
+			marketOffer.playerName = offer.playerName;
 		} else {
-			offer.playerName = "Anonymous";
+			marketOffer.playerName = "Anonymous";
 		}
-		offerList.push_back(offer);
-	} while (result->next());
+		offerList.push_back(marketOffer);
+	}
 	return offerList;
 }
 
 MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId) {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}", playerId, static_cast<int>(action)));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
-		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offerList.push_back(offer);
-	} while (result->next());
+	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (uint32_t offerId : it->second) {
+		const Offer& offer = market.offers.at(offerId);
+		if (offer.type != action) {
+			continue;
+		}
+
+		MarketOffer marketOffer;
+		marketOffer.amount = offer.amount;
+		marketOffer.price = offer.price;
+		marketOffer.timestamp = offer.created + marketOfferDuration;
+		marketOffer.counter = offer.id & 0xFFFF;
+		marketOffer.itemId = offer.itemId;
+		offerList.push_back(marketOffer);
+	}
 	return offerList;
 }
 
@@ -90,20 +169,26 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 	return offerList;
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
-	if (!result) {
-		return;
-	}
+void IOMarket::processExpiredOffers(const std::vector<uint32_t>& offerIds) {
+	IOMarket& market = getInstance();
+	for (uint32_t offerId : offerIds) {
+		auto it = market.offers.find(offerId);
+		if (it == market.offers.end()) {
+			continue;
+		}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
+		const uint32_t playerId = it->second.playerId;
+		const uint16_t amount = it->second.amount;
+		const uint16_t itemId = it->second.itemId;
+		const MarketAction_t type = it->second.type;
+		const uint64_t price = it->second.price;
+
+		if (!IOMarket::moveOfferToHistory(offerId, OFFERSTATE_EXPIRED)) {
 			continue;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
+		if (type == MARKETACTION_SELL) {
+			const ItemType& itemType = Item::items[itemId];
 			if (itemType.id == 0) {
 				continue;
 			}
@@ -151,7 +236,7 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
 				delete player;
 			}
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+			uint64_t totalPrice = price * amount;
 
 			Player* player = g_game.getPlayerByGUID(playerId);
 			if (player) {
@@ -160,13 +245,21 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool) {
 				IOLoginData::increaseBankBalance(playerId, totalPrice);
 			}
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers() {
 	const time_t lastExpireDate = time(nullptr) - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(fmt::format("SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}", lastExpireDate), IOMarket::processExpiredOffers, true);
+	// offers are indexed by creation time, so the expired ones come first
+	std::vector<uint32_t> expiredOffers;
+	for (const auto& it : getInstance().counterOffers) {
+		if (it.first.first > lastExpireDate) {
+			break;
+		}
+		expiredOffers.push_back(it.second);
+	}
+	processExpiredOffers(expiredOffers);
 
 	int32_t checkExpiredMarketOffersEachMinutes = getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -177,35 +270,38 @@ void IOMarket::checkExpiredOffers() {
 }
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId) {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter) {
 	MarketOfferEx offer;
 
-	const int32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1", created, counter));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.counterOffers.find(std::make_pair(created, counter));
+	if (it == market.counterOffers.end()) {
 		offer.id = 0;
 		offer.playerId = 0;
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint32_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
+	const Offer& marketOffer = market.offers.at(it->second);
+	offer.id = marketOffer.id;
+	offer.type = marketOffer.type;
+	offer.amount = marketOffer.amount;
+	offer.counter = marketOffer.id & 0xFFFF;
+	offer.timestamp = marketOffer.created;
+	offer.price = marketOffer.price;
+	offer.itemId = marketOffer.itemId;
+	offer.playerId = marketOffer.playerId;
+	if (!marketOffer.anonymous) {
+		offer.playerName = marketOffer.playerName;
 	} else {
 		offer.playerName = "Anonymous";
 	}
@@ -213,36 +309,62 @@ MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 }
 
 void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
-	Database::getInstance().executeQuery(fmt::format("INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, time(nullptr), anonymous));
+	IOMarket& market = getInstance();
+
+	Offer offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.created = static_cast<uint32_t>(time(nullptr));
+	offer.price = price;
+	offer.amount = amount;
+	offer.itemId = static_cast<uint16_t>(itemId);
+	offer.type = action;
+	offer.anonymous = anonymous;
+	if (Player* player = g_game.getPlayerByGUID(playerId)) {
+		offer.playerName = player->getName();
+	} else {
+		offer.playerName = IOLoginData::getNameByGuid(playerId);
+	}
+
+	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", offer.id, playerId, static_cast<int>(action), itemId, amount, price, offer.created, anonymous));
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount) {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	it->second.amount -= std::min(amount, it->second.amount);
+	g_databaseTasks.addTask(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
 }
 
 void IOMarket::deleteOffer(uint32_t offerId) {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	getInstance().removeOffer(offerId);
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state) {
+	if (state == OFFERSTATE_ACCEPTED) {
+		getInstance().addStatistics(action, itemId, price);
+	}
+
 	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, static_cast<int>(action), itemId, amount, price, timestamp, time(nullptr), static_cast<int>(state)));
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state) {
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}", offerId));
-	if (!result) {
+	std::optional<Offer> offer = getInstance().removeOffer(offerId);
+	if (!offer) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
-	}
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint32_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
+	appendHistory(offer->playerId, offer->type, offer->itemId, offer->amount, offer->price, offer->created + marketOfferDuration, state);
 	return true;
 }
 
@@ -267,6 +389,16 @@ void IOMarket::updateStatistics() {
 	} while (result->next());
 }
 
+void IOMarket::addStatistics(MarketAction_t action, uint16_t itemId, uint32_t price) {
+	MarketStatistics& statistics = action == MARKETACTION_BUY ? purchaseStatistics[itemId] : saleStatistics[itemId];
+	if (statistics.numTransactions == 0 || price < statistics.lowestPrice) {
+		statistics.lowestPrice = price;
+	}
+	statistics.highestPrice = std::max(statistics.highestPrice, price);
+	statistics.totalPrice += price;
+	++statistics.numTransactions;
+}
+
 MarketStatistics* IOMarket::getPurchaseStatistics(uint16_t itemId) {
 	auto it = purchaseStatistics.find(itemId);
 	if (it == purchaseStatistics.end()) {
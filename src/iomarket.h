@@ -7,6 +7,11 @@
 #include "database.h"
 #include "enums.h"
 
+/**
+ * The active market offers are kept in memory, indexed by item, by player and
+ * by (creation time, counter), so browsing and trading never wait on the
+ * database. Every change is written behind through the database task queue.
+ */
 class IOMarket {
 	public:
 		static IOMarket& getInstance() {
@@ -14,11 +19,13 @@ class IOMarket {
 			return instance;
 		}
 
+		void loadOffers();
+
 		static MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId);
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
+		static void processExpiredOffers(const std::vector<uint32_t>& offerIds);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
@@ -39,6 +46,28 @@ class IOMarket {
 	private:
 		IOMarket() = default;
 
+		struct Offer {
+			uint32_t id;
+			uint32_t playerId;
+			uint32_t created;
+			uint32_t price;
+			uint16_t amount;
+			uint16_t itemId;
+			MarketAction_t type;
+			bool anonymous;
+			std::string playerName;
+		};
+
+		void addOffer(Offer&& offer);
+		std::optional<Offer> removeOffer(uint32_t offerId);
+		void addStatistics(MarketAction_t action, uint16_t itemId, uint32_t price);
+
+		std::unordered_map<uint32_t, Offer> offers;
+		std::array<std::unordered_map<uint16_t, std::set<uint32_t>>, 2> itemOffers; // indexed by MarketAction_t
+		std::unordered_map<uint32_t, std::set<uint32_t>> playerOffers;
+		std::map<std::pair<uint32_t, uint16_t>, uint32_t> counterOffers;
+		uint32_t nextOfferId = 1;
+
 		std::map<uint16_t, MarketStatistics> purchaseStatistics;
 		std::map<uint16_t, MarketStatistics> saleStatistics;
 };
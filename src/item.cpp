@@ -10,6 +10,8 @@
 #include "container.h"
 #include "game/game.h"
 #include "house.h"
+#include "housetile.h"
+#include "luascript.h"
 #include "mailbox.h"
 #include "spells.h"
 #include "teleport.h"
@@ -21,6 +23,8 @@ extern Vocations g_vocations;
 
 Items Item::items;
 
+thread_local DetachedItemLoad* DetachedItemLoad::current = nullptr;
+
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/) {
 	Item* newItem = nullptr;
 
@@ -155,10 +159,19 @@ Item::Item(const Item& i) :
 	}
 }
 
+Item::~Item() {
+	lua::releaseUserdata(this);
+}
+
 Item* Item::clone() const {
 	Item* item = Item::CreateItem(id, count);
 	if (attributes) {
 		item->attributes.reset(new ItemAttributes(*attributes));
+		// while decaying the attribute holds the duration this item was scheduled with,
+		// a copy of an item waiting in the decay queue decays in the next pass
+		if (isDecayScheduled()) {
+			item->setDuration(std::max<uint32_t>(1, getDuration()));
+		}
 		if (item->getDuration() > 0) {
 			item->incrementReferenceCounter();
 			item->setDecaying(DECAYING_TRUE);
@@ -233,6 +246,10 @@ void Item::onRemoved() {
 }
 
 void Item::setID(uint16_t newid) {
+	// a decaying item is stopped with the duration it has left, the new type decides below whether it goes on
+	const bool wasDecaying = isDecayScheduled();
+	g_game.stopDecay(this);
+
 	const ItemType& prevIt = Item::items[id];
 	id = newid;
 
@@ -250,6 +267,27 @@ void Item::setID(uint16_t newid) {
 		setDecaying(DECAYING_FALSE);
 		setDuration(newDuration);
 	}
+
+	if (wasDecaying && canDecay()) {
+		incrementReferenceCounter();
+		setDecaying(DECAYING_TRUE);
+		g_game.toDecayItems.push_front(this);
+	}
+}
+
+void Item::markHouseItemsDirty() {
+	if (!parent) {
+		return;
+	}
+
+	// carried by someone standing in the house
+	if (getTopParent()->getCreature()) {
+		return;
+	}
+
+	if (HouseTile* houseTile = dynamic_cast<HouseTile*>(getTile())) {
+		houseTile->getHouse()->markItemsDirty();
+	}
 }
 
 Cylinder* Item::getTopParent() {
@@ -364,7 +402,9 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream) {
 				return ATTR_READ_ERROR;
 			}
 
-			setUniqueId(uniqueId);
+			if (!DetachedItemLoad::defer()) {
+				setUniqueId(uniqueId);
+			}
 			break;
 		}
 
@@ -739,7 +779,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const {
 
 	if (hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
 		propWriteStream.write<uint8_t>(ATTR_DURATION);
-		propWriteStream.write<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION));
+		propWriteStream.write<uint32_t>(getDuration());
 	}
 
 	ItemDecayState_t decayState = getDecaying();
@@ -1720,6 +1760,23 @@ ItemAttributes::Attribute& ItemAttributes::getAttr(itemAttrTypes type) {
 	return attributes.back();
 }
 
+uint32_t Item::getDuration() const {
+	if (!attributes) {
+		return 0;
+	}
+
+	if (attributes->decayQueued.value) {
+		return 0;
+	}
+
+	// while decaying the attribute holds the duration it was scheduled with
+	const TimerHandle& handle = attributes->decayHandle;
+	if (handle.isScheduled()) {
+		return static_cast<uint32_t>(std::max<int64_t>(0, handle.expiry - OTSYS_TIME()));
+	}
+	return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+}
+
 void Item::startDecaying() {
 	g_game.startDecay(this);
 }
@@ -1736,8 +1793,7 @@ bool Item::hasMarketAttributes() const {
 				return false;
 			}
 		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration != getDefaultDuration()) {
+			if (getDuration() != getDefaultDuration()) {
 				return false;
 			}
 		} else {
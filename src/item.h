@@ -8,6 +8,7 @@
 #include "items.h"
 #include "luascript.h"
 #include "thing.h"
+#include "timingwheel.h"
 
 class BedItem;
 class Container;
@@ -404,6 +405,21 @@ class ItemAttributes {
 		std::vector<Attribute> attributes;
 		uint32_t attributeBits = 0;
 
+		// position in Game::decayWheel, while it is scheduled ITEM_ATTRIBUTE_DURATION holds the duration when scheduled
+		TimerHandle decayHandle;
+
+		// the decay came due and waits in Game::decayQueue, like the handle a copy is not queued
+		struct DecayQueued {
+			DecayQueued() = default;
+			DecayQueued(const DecayQueued&) {}
+			DecayQueued& operator=(const DecayQueued&) {
+				value = false;
+				return *this;
+			}
+
+			bool value = false;
+		} decayQueued;
+
 		const std::string& getStrAttr(itemAttrTypes type) const;
 		void setStrAttr(itemAttrTypes type, std::string_view value);
 
@@ -525,7 +541,7 @@ class Item : virtual public Thing {
 		Item(const Item& i);
 		virtual Item* clone() const;
 
-		virtual ~Item() = default;
+		virtual ~Item();
 
 		// non-assignable
 		Item& operator=(const Item&) = delete;
@@ -751,12 +767,7 @@ class Item : virtual public Thing {
 		void decreaseDuration(int32_t time) {
 			increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time);
 		}
-		uint32_t getDuration() const {
-			if (!attributes) {
-				return 0;
-			}
-			return getIntAttr(ITEM_ATTRIBUTE_DURATION);
-		}
+		uint32_t getDuration() const;
 
 		void setDecaying(ItemDecayState_t decayState) {
 			setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState);
@@ -1007,6 +1018,19 @@ class Item : virtual public Thing {
 			return attributes;
 		}
 
+		TimerHandle& getTimerHandle() {
+			return getAttributes()->decayHandle;
+		}
+		bool isDecayScheduled() const {
+			return attributes && (attributes->decayQueued.value || attributes->decayHandle.isScheduled());
+		}
+		bool isDecayQueued() const {
+			return attributes && attributes->decayQueued.value;
+		}
+		void setDecayQueued(bool value) {
+			getAttributes()->decayQueued.value = value;
+		}
+
 		void incrementReferenceCounter() {
 			++referenceCounter;
 		}
@@ -1033,6 +1057,10 @@ class Item : virtual public Thing {
 			return !parent || parent->isRemoved();
 		}
 
+		// the house of the tile the item lies on has to save its items again,
+		// called by the cylinder update points and by changes made around them
+		void markHouseItemsDirty();
+
 	protected:
 		Cylinder* parent = nullptr;
 
@@ -1055,4 +1083,41 @@ class Item : virtual public Thing {
 using ItemList = std::list<Item*>;
 using ItemDeque = std::deque<Item*>;
 
+/**
+ * While an instance is alive, items unserialized on the current thread do not
+ * register themselves in global game state (unique ids, bed sleepers), which
+ * allows decoding item trees off the dispatcher. Whether anything had to be
+ * skipped is recorded in `deferred`; such items must be loaded again on the
+ * dispatcher instead.
+ */
+class DetachedItemLoad {
+	public:
+		DetachedItemLoad() : previous(current) {
+			current = this;
+		}
+		~DetachedItemLoad() {
+			current = previous;
+		}
+
+		// non-copyable
+		DetachedItemLoad(const DetachedItemLoad&) = delete;
+		DetachedItemLoad& operator=(const DetachedItemLoad&) = delete;
+
+		static bool defer() {
+			if (!current) {
+				return false;
+			}
+
+			current->deferred = true;
+			return true;
+		}
+
+		bool deferred = false;
+
+	private:
+		DetachedItemLoad* previous;
+
+		static thread_local DetachedItemLoad* current;
+};
+
 #endif // FS_ITEM_H
\ No newline at end of file
@@ -0,0 +1,237 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luachunkcache.h"
+
+#include "configmanager.h"
+
+#include <boost/crc.hpp>
+#include <fstream>
+
+LuaChunkCache g_luaChunkCache;
+
+namespace {
+
+constexpr std::string_view CACHE_MAGIC = "OTLC";
+
+// bytecode is only portable between builds of the same Lua implementation
+#ifdef LUAJIT_VERSION
+constexpr std::string_view CACHE_TAG = LUAJIT_VERSION;
+#else
+constexpr std::string_view CACHE_TAG = LUA_VERSION;
+#endif
+
+uint32_t checksum(std::string_view data) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data.data(), data.size());
+	return crc.checksum();
+}
+
+bool readFile(const std::string& path, std::string& data) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+template <typename T>
+void append(std::string& out, T value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool consume(std::string_view& in, T& value) {
+	if (in.size() < sizeof(value)) {
+		return false;
+	}
+
+	std::memcpy(&value, in.data(), sizeof(value));
+	in.remove_prefix(sizeof(value));
+	return true;
+}
+
+bool consume(std::string_view& in, std::string_view expected) {
+	uint16_t length;
+	if (!consume(in, length) || length != expected.size() || in.substr(0, length) != expected) {
+		return false;
+	}
+
+	in.remove_prefix(length);
+	return true;
+}
+
+int writeBytecode(lua_State*, const void* p, size_t size, void* ud) {
+	static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+	return 0;
+}
+
+} // namespace
+
+int LuaChunkCache::load(lua_State* L, const std::string& file) {
+	if (!ConfigManager::getBoolean(ConfigManager::LUA_BYTECODE_CACHE)) {
+		return luaL_loadfile(L, file.data());
+	}
+
+	std::error_code ec;
+	uint64_t size = std::filesystem::file_size(file, ec);
+	int64_t mtime = 0;
+	if (!ec) {
+		mtime = std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+	}
+
+	if (ec) {
+		// let Lua report the missing or unreadable file
+		return luaL_loadfile(L, file.data());
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto finish = [&](uint32_t& counter) {
+		++counter;
+		loadNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		return 0;
+	};
+
+	const std::string chunkName = '@' + file;
+	auto tryLoad = [&](const Entry& entry) {
+		if (luaL_loadbuffer(L, entry.bytecode.data(), entry.bytecode.size(), chunkName.data()) == 0) {
+			return true;
+		}
+
+		// written by another Lua build, fall back to the source
+		lua_pop(L, 1);
+		return false;
+	};
+
+	auto it = entries.find(file);
+	if (it != entries.end() && it->second.mtime == mtime && it->second.size == size && tryLoad(it->second)) {
+		return finish(memoryHits);
+	}
+
+	Entry entry;
+	bool cached = loadFromDisk(file, entry);
+	if (cached && entry.mtime == mtime && entry.size == size && tryLoad(entry)) {
+		entries[file] = std::move(entry);
+		return finish(diskHits);
+	}
+
+	std::string source;
+	if (!readFile(file, source)) {
+		return luaL_loadfile(L, file.data());
+	}
+
+	uint32_t hash = checksum(source);
+	if (cached && entry.hash == hash && entry.size == source.size() && tryLoad(entry)) {
+		// only the timestamp changed
+		entry.mtime = mtime;
+		saveToDisk(file, entry);
+		entries[file] = std::move(entry);
+		return finish(diskHits);
+	}
+
+	if (!source.empty() && source.front() == '#') {
+		// skip a shebang line like luaL_loadfile does, keeping the line numbers
+		source.erase(0, source.find('\n'));
+	}
+
+	int ret = luaL_loadbuffer(L, source.data(), source.size(), chunkName.data());
+	if (ret != 0) {
+		return ret;
+	}
+
+	entry = {};
+	entry.mtime = mtime;
+	entry.size = size;
+	entry.hash = hash;
+#if LUA_VERSION_NUM >= 503
+	lua_dump(L, writeBytecode, &entry.bytecode, 0);
+#else
+	lua_dump(L, writeBytecode, &entry.bytecode);
+#endif
+
+	saveToDisk(file, entry);
+	entries[file] = std::move(entry);
+	return finish(compiled);
+}
+
+void LuaChunkCache::clear() {
+	entries.clear();
+}
+
+void LuaChunkCache::logStats(std::string_view context) {
+	uint32_t total = memoryHits + diskHits + compiled;
+	if (total != 0) {
+		std::cout << fmt::format(">> Lua chunk cache ({:s}): {:d} files in {:.1f} ms, {:d} from memory, {:d} from disk, {:d} compiled", context, total,
+		                         loadNs / 1e6, memoryHits, diskHits, compiled)
+		          << std::endl;
+	}
+
+	memoryHits = 0;
+	diskHits = 0;
+	compiled = 0;
+	loadNs = 0;
+}
+
+bool LuaChunkCache::loadFromDisk(const std::string& file, Entry& entry) {
+	std::string data;
+	if (!readFile(getCachePath(file), data)) {
+		return false;
+	}
+
+	std::string_view in = data;
+	if (in.substr(0, CACHE_MAGIC.size()) != CACHE_MAGIC) {
+		return false;
+	}
+	in.remove_prefix(CACHE_MAGIC.size());
+
+	if (!consume(in, CACHE_TAG) || !consume(in, std::string_view(file))) {
+		return false;
+	}
+
+	if (!consume(in, entry.mtime) || !consume(in, entry.size) || !consume(in, entry.hash) || in.empty()) {
+		return false;
+	}
+
+	entry.bytecode.assign(in.data(), in.size());
+	return true;
+}
+
+void LuaChunkCache::saveToDisk(const std::string& file, const Entry& entry) {
+	std::filesystem::path path = getCachePath(file);
+
+	std::error_code ec;
+	std::filesystem::create_directories(path.parent_path(), ec);
+
+	std::string data{CACHE_MAGIC};
+	append<uint16_t>(data, CACHE_TAG.size());
+	data.append(CACHE_TAG);
+	append<uint16_t>(data, file.size());
+	data.append(file);
+	append(data, entry.mtime);
+	append(data, entry.size);
+	append(data, entry.hash);
+	data.append(entry.bytecode);
+
+	// write next to the target and rename, so a crash never leaves a torn entry
+	std::filesystem::path tmpPath = path;
+	tmpPath += ".tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out || !out.write(data.data(), data.size())) {
+			return;
+		}
+	}
+
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::filesystem::remove(tmpPath, ec);
+	}
+}
+
+std::string LuaChunkCache::getCachePath(const std::string& file) const {
+	return fmt::format("{:s}/{:08x}.luac", ConfigManager::getString(ConfigManager::LUA_BYTECODE_CACHE_PATH), checksum(file));
+}
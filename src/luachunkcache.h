@@ -0,0 +1,69 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUACHUNKCACHE_H
+#define FS_LUACHUNKCACHE_H
+
+struct lua_State;
+
+/**
+ * Keeps the precompiled bytecode of every Lua file loaded by the server.
+ *
+ * A file is compiled from source once; its bytecode (lua_dump) is kept in
+ * memory for later reloads and written to an on-disk cache so the next
+ * startup can skip parsing as well. An entry is valid while the source file
+ * keeps its modification time and size; when those changed, the source is
+ * hashed and the cached bytecode is still reused if the content is the same
+ * (e.g. after a checkout that only touched the file).
+ *
+ * The on-disk cache is trusted: binary chunks are not verified by Lua, so the
+ * cache directory must only be writable by the server.
+ */
+class LuaChunkCache {
+	public:
+		LuaChunkCache() = default;
+
+		// non-copyable
+		LuaChunkCache(const LuaChunkCache&) = delete;
+		LuaChunkCache& operator=(const LuaChunkCache&) = delete;
+
+		/**
+		 * Loads the file as a function at the top of the stack, like luaL_loadfile.
+		 *
+		 * @return 0 on success, otherwise the luaL_loadfile error code with the message at the top of the stack
+		 */
+		int load(lua_State* L, const std::string& file);
+
+		/**
+		 * Drops the bytecode kept in memory. The on-disk cache is left untouched.
+		 */
+		void clear();
+
+		/**
+		 * Logs how the files loaded since the last call were served and resets the counters.
+		 */
+		void logStats(std::string_view context);
+
+	private:
+		struct Entry {
+			int64_t mtime = 0;
+			uint64_t size = 0;
+			uint32_t hash = 0;
+			std::string bytecode;
+		};
+
+		bool loadFromDisk(const std::string& file, Entry& entry);
+		void saveToDisk(const std::string& file, const Entry& entry);
+		std::string getCachePath(const std::string& file) const;
+
+		std::unordered_map<std::string, Entry> entries;
+
+		uint32_t memoryHits = 0;
+		uint32_t diskHits = 0;
+		uint32_t compiled = 0;
+		int64_t loadNs = 0;
+};
+
+extern LuaChunkCache g_luaChunkCache;
+
+#endif // FS_LUACHUNKCACHE_H
@@ -0,0 +1,156 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaffi.h"
+
+#include "configmanager.h"
+#include "item.h"
+#include "player.h"
+
+#ifdef LUAJIT_VERSION
+namespace {
+
+// keep in sync with the cdef in data/lib/core/ffi.lua
+struct LuaFfiPosition {
+	uint16_t x;
+	uint16_t y;
+	uint8_t z;
+};
+
+struct FfiBinding {
+	const char* className;
+	const char* methodName;
+	const char* kind;
+	void* pointer;
+};
+
+// the object pointer is the one stored in the userdata, resolved like lua::getUserdata<C> does;
+// the member is called through C so methods inherited from a virtual base (Thing) are adjusted
+template <typename C, auto method>
+double numberGetter(const void* object) {
+	return static_cast<double>((static_cast<const C*>(object)->*method)());
+}
+
+template <typename C, auto method>
+bool booleanGetter(const void* object) {
+	return (static_cast<const C*>(object)->*method)();
+}
+
+template <typename C, auto method>
+void positionGetter(const void* object, LuaFfiPosition* out) {
+	const Position& position = (static_cast<const C*>(object)->*method)();
+	out->x = position.x;
+	out->y = position.y;
+	out->z = position.z;
+}
+
+template <typename C, auto method>
+FfiBinding number(const char* className, const char* methodName) {
+	return {className, methodName, "number", reinterpret_cast<void*>(&numberGetter<C, method>)};
+}
+
+template <typename C, auto method>
+FfiBinding boolean(const char* className, const char* methodName) {
+	return {className, methodName, "boolean", reinterpret_cast<void*>(&booleanGetter<C, method>)};
+}
+
+template <typename C, auto method>
+FfiBinding position(const char* className, const char* methodName) {
+	return {className, methodName, "position", reinterpret_cast<void*>(&positionGetter<C, method>)};
+}
+
+const std::vector<FfiBinding>& getBindings() {
+	static const std::vector<FfiBinding> bindings = {
+		// Creature
+		number<Creature, &Creature::getID>("Creature", "getId"),
+		number<Creature, &Creature::getHealth>("Creature", "getHealth"),
+		number<Creature, &Creature::getMaxHealth>("Creature", "getMaxHealth"),
+		number<Creature, &Creature::getSpeed>("Creature", "getSpeed"),
+		number<Creature, &Creature::getBaseSpeed>("Creature", "getBaseSpeed"),
+		number<Creature, &Creature::getDirection>("Creature", "getDirection"),
+		number<Creature, &Creature::getSkull>("Creature", "getSkull"),
+		number<Creature, &Creature::getZone>("Creature", "getZone"),
+		boolean<Creature, &Creature::isRemoved>("Creature", "isRemoved"),
+		boolean<Creature, &Creature::isInGhostMode>("Creature", "isInGhostMode"),
+		boolean<Creature, &Creature::isHealthHidden>("Creature", "isHealthHidden"),
+		boolean<Creature, &Creature::isMovementBlocked>("Creature", "isMovementBlocked"),
+		boolean<Creature, &Creature::hasParent>("Creature", "hasParent"),
+		position<Creature, &Creature::getPosition>("Creature", "getPosition"),
+
+		// Player
+		number<Player, &Player::getGUID>("Player", "getGuid"),
+		number<Player, &Player::getAccount>("Player", "getAccountId"),
+		number<Player, &Player::getAccountType>("Player", "getAccountType"),
+		number<Player, &Player::getLevel>("Player", "getLevel"),
+		number<Player, &Player::getExperience>("Player", "getExperience"),
+		number<Player, &Player::getMagicLevel>("Player", "getMagicLevel"),
+		number<Player, &Player::getBaseMagicLevel>("Player", "getBaseMagicLevel"),
+		number<Player, &Player::getMana>("Player", "getMana"),
+		number<Player, &Player::getMaxMana>("Player", "getMaxMana"),
+		number<Player, &Player::getSpentMana>("Player", "getManaSpent"),
+		number<Player, &Player::getSoul>("Player", "getSoul"),
+		number<Player, &Player::getStaminaMinutes>("Player", "getStamina"),
+		number<Player, &Player::getSex>("Player", "getSex"),
+		number<Player, &Player::getCapacity>("Player", "getCapacity"),
+		number<Player, &Player::getFreeCapacity>("Player", "getFreeCapacity"),
+		number<Player, &Player::getBankBalance>("Player", "getBankBalance"),
+		number<Player, &Player::getSkullTicks>("Player", "getSkullTime"),
+		number<Player, &Player::getIdleTime>("Player", "getIdleTime"),
+		number<Player, &Player::getLastLoginSaved>("Player", "getLastLoginSaved"),
+		number<Player, &Player::getLastLogout>("Player", "getLastLogout"),
+		boolean<Player, &Player::isPzLocked>("Player", "isPzLocked"),
+
+		// Item
+		number<Item, &Item::getID>("Item", "getId"),
+		number<Item, &Item::getActionId>("Item", "getActionId"),
+		number<Item, &Item::getItemCount>("Item", "getCount"),
+		number<Item, &Item::getCharges>("Item", "getCharges"),
+		number<Item, &Item::getFluidType>("Item", "getFluidType"),
+		number<Item, &Item::getWeight>("Item", "getWeight"),
+		number<Item, &Item::getWorth>("Item", "getWorth"),
+		number<Item, &Item::getSubType>("Item", "getSubType"),
+		boolean<Item, &Item::isLoadedFromMap>("Item", "isLoadedFromMap"),
+		boolean<Item, &Item::isStoreItem>("Item", "isStoreItem"),
+		boolean<Item, &Item::hasParent>("Item", "hasParent"),
+		position<Item, &Item::getPosition>("Item", "getPosition"),
+	};
+	return bindings;
+}
+
+} // namespace
+#endif
+
+void registerLuaFfiBindings([[maybe_unused]] lua_State* L) {
+#ifdef LUAJIT_VERSION
+	if (!ConfigManager::getBoolean(ConfigManager::LUA_FFI_BINDINGS)) {
+		return;
+	}
+
+	const auto& bindings = getBindings();
+
+	// LuaFFI = {bindings = {...}, positionMetatable = Position.metatable}
+	lua_createtable(L, 0, 2);
+	lua_createtable(L, bindings.size(), 0);
+	for (size_t i = 0; i < bindings.size(); ++i) {
+		const FfiBinding& binding = bindings[i];
+		lua_createtable(L, 0, 4);
+		lua_pushstring(L, binding.className);
+		lua_setfield(L, -2, "className");
+		lua_pushstring(L, binding.methodName);
+		lua_setfield(L, -2, "methodName");
+		lua_pushstring(L, binding.kind);
+		lua_setfield(L, -2, "kind");
+		lua_pushlightuserdata(L, binding.pointer);
+		lua_setfield(L, -2, "pointer");
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "bindings");
+
+	luaL_getmetatable(L, "Position");
+	lua_setfield(L, -2, "positionMetatable");
+
+	lua_setglobal(L, "LuaFFI");
+#endif
+}
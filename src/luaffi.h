@@ -0,0 +1,24 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAFFI_H
+#define FS_LUAFFI_H
+
+struct lua_State;
+
+/**
+ * Exposes the hottest read-only getters of Creature, Player and Item as plain
+ * function pointers for the LuaJIT FFI.
+ *
+ * A call into a lua_CFunction ends the current JIT trace, so scripts calling
+ * getters in loops (e.g. creature:getHealth() over every spectator) run in
+ * the interpreter. Calls through the FFI are compiled into the trace instead.
+ *
+ * The pointers are published in the global LuaFFI table, which
+ * data/lib/core/ffi.lua uses to replace the matching class methods. When the
+ * server is not built with LuaJIT, or the layer is disabled in the config,
+ * the table is not created and the regular bindings stay in place.
+ */
+void registerLuaFfiBindings(lua_State* L);
+
+#endif // FS_LUAFFI_H
@@ -0,0 +1,130 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luagc.h"
+
+#include "configmanager.h"
+
+LuaGcGovernor g_luaGcGovernor;
+
+namespace {
+
+// heap growth in percent since the last cycle that starts an idle cycle
+constexpr int IDLE_CYCLE_GROWTH = 10;
+
+int64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+void LuaGcGovernor::Histogram::add(uint64_t ns) {
+	uint64_t us = ns / 1000;
+	size_t bucket = 0;
+	while (bucket < BUCKET_LIMITS.size() && us >= BUCKET_LIMITS[bucket]) {
+		++bucket;
+	}
+
+	++buckets[bucket];
+	++count;
+	totalNs += ns;
+	maxNs = std::max(maxNs, ns);
+}
+
+void LuaGcGovernor::attach(lua_State* L) {
+	this->L = L;
+	cycleRunning = false;
+	// a task running across the switch compares nothing
+	taskStartKb = 0;
+	if (!L) {
+		return;
+	}
+
+	nextCycleKb = lua_gc(L, LUA_GCCOUNT, 0);
+
+	// without the governor the collector keeps the Lua defaults
+	if (!ConfigManager::getBoolean(ConfigManager::LUA_GC_GOVERNOR)) {
+		return;
+	}
+
+	int pause = ConfigManager::getNumber(ConfigManager::LUA_GC_PAUSE);
+	int stepMultiplier = ConfigManager::getNumber(ConfigManager::LUA_GC_STEP_MULTIPLIER);
+#if LUA_VERSION_NUM >= 504
+	if (ConfigManager::getString(ConfigManager::LUA_GC_MODE) == "generational") {
+		lua_gc(L, LUA_GCGEN, 0, 0);
+	} else {
+		lua_gc(L, LUA_GCINC, pause, stepMultiplier, 0);
+	}
+#else
+	// only the incremental collector is available before Lua 5.4
+	lua_gc(L, LUA_GCSETPAUSE, pause);
+	lua_gc(L, LUA_GCSETSTEPMUL, stepMultiplier);
+#endif
+}
+
+bool LuaGcGovernor::idleStep() {
+	if (!L || !ConfigManager::getBoolean(ConfigManager::LUA_GC_GOVERNOR)) {
+		return false;
+	}
+
+	if (!cycleRunning) {
+		if (lua_gc(L, LUA_GCCOUNT, 0) < nextCycleKb) {
+			return false;
+		}
+		cycleRunning = true;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	bool finished = lua_gc(L, LUA_GCSTEP, ConfigManager::getNumber(ConfigManager::LUA_GC_STEP_SIZE)) != 0;
+	idleSteps.add(elapsedNs(start));
+
+	if (!finished) {
+		return true;
+	}
+
+	++idleCycles;
+	cycleRunning = false;
+	nextCycleKb = lua_gc(L, LUA_GCCOUNT, 0) * (100 + IDLE_CYCLE_GROWTH) / 100;
+	return false;
+}
+
+void LuaGcGovernor::fullCollect() {
+	if (!L) {
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	fullCollections.add(elapsedNs(start));
+
+	cycleRunning = false;
+	int kb = lua_gc(L, LUA_GCCOUNT, 0);
+	nextCycleKb = kb * (100 + IDLE_CYCLE_GROWTH) / 100;
+
+	// a task asking for the collection is already timed above
+	taskStartKb = kb;
+	taskStart = std::chrono::steady_clock::now();
+}
+
+void LuaGcGovernor::beginTask() {
+	if (!L) {
+		return;
+	}
+
+	taskStartKb = lua_gc(L, LUA_GCCOUNT, 0);
+	taskStart = std::chrono::steady_clock::now();
+}
+
+void LuaGcGovernor::endTask() {
+	if (!L) {
+		return;
+	}
+
+	int kb = lua_gc(L, LUA_GCCOUNT, 0);
+	if (kb < taskStartKb) {
+		inTaskCollections.add(elapsedNs(taskStart));
+		inTaskFreedKb += taskStartKb - kb;
+	}
+}
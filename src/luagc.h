@@ -0,0 +1,109 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAGC_H
+#define FS_LUAGC_H
+
+struct lua_State;
+
+/**
+ * Moves Lua garbage collection of the main state into dispatcher idle time.
+ *
+ * Once the heap grew past the size left by the last cycle, each time the
+ * dispatcher runs out of tasks a bounded incremental step is performed,
+ * until the cycle completes. The dispatcher checks its queue between two
+ * steps, so a task never waits for more than one step. The collector's own
+ * pause is raised so allocation-driven collection mostly acts as a backstop
+ * when the server has no idle time at all.
+ *
+ * Every step and full collection is timed into a histogram. Collection the
+ * allocator triggers inside a task cannot be timed on its own: the dispatcher
+ * reports each task, and a task after which the heap is smaller than before
+ * it ran a collection. Its whole run time goes into a third histogram, an
+ * upper bound of the collection work. A task that allocated more than the
+ * collection freed is not seen.
+ */
+class LuaGcGovernor {
+	public:
+		static constexpr size_t HISTOGRAM_BUCKETS = 10;
+		// upper bound of each bucket in microseconds, the last one is unbounded
+		static constexpr std::array<uint32_t, HISTOGRAM_BUCKETS - 1> BUCKET_LIMITS = {25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+		struct Histogram {
+			std::array<uint64_t, HISTOGRAM_BUCKETS> buckets = {};
+			uint64_t count = 0;
+			uint64_t totalNs = 0;
+			uint64_t maxNs = 0;
+
+			void add(uint64_t ns);
+		};
+
+		LuaGcGovernor() = default;
+
+		// non-copyable
+		LuaGcGovernor(const LuaGcGovernor&) = delete;
+		LuaGcGovernor& operator=(const LuaGcGovernor&) = delete;
+
+		/**
+		 * Applies the configured collector mode and parameters to a new state
+		 * if the governor is enabled, nullptr detaches before the state is
+		 * closed.
+		 */
+		void attach(lua_State* L);
+
+		/**
+		 * Runs one collection step, called by the dispatcher while its queue is empty.
+		 *
+		 * @return true if the current cycle needs more steps
+		 */
+		bool idleStep();
+
+		/**
+		 * Runs a full collection, timed separately from the idle steps.
+		 */
+		void fullCollect();
+
+		/**
+		 * Called by the dispatcher around every task to find the collection
+		 * the allocator ran inside it.
+		 */
+		void beginTask();
+		void endTask();
+
+		const Histogram& getIdleSteps() const {
+			return idleSteps;
+		}
+		const Histogram& getFullCollections() const {
+			return fullCollections;
+		}
+		const Histogram& getInTaskCollections() const {
+			return inTaskCollections;
+		}
+		uint64_t getIdleCycles() const {
+			return idleCycles;
+		}
+		uint64_t getInTaskFreedKb() const {
+			return inTaskFreedKb;
+		}
+
+	private:
+		lua_State* L = nullptr;
+
+		// heap size in KB that starts the next idle cycle
+		int nextCycleKb = 0;
+		bool cycleRunning = false;
+
+		// heap size in KB and start of the running task
+		int taskStartKb = 0;
+		std::chrono::steady_clock::time_point taskStart;
+
+		Histogram idleSteps;
+		Histogram fullCollections;
+		Histogram inTaskCollections;
+		uint64_t idleCycles = 0;
+		uint64_t inTaskFreedKb = 0;
+};
+
+extern LuaGcGovernor g_luaGcGovernor;
+
+#endif // FS_LUAGC_H
@@ -0,0 +1,229 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaprofiler.h"
+
+#include "configmanager.h"
+#include "luascript.h"
+
+#include <fmt/chrono.h>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+LuaProfiler g_luaProfiler;
+
+namespace {
+
+constexpr int MAX_SAMPLED_FRAMES = 64;
+
+std::string describeFrame(const lua_Debug& ar) {
+	if (*ar.what == 'C') {
+		return ar.name ? fmt::format("[C] {:s}", ar.name) : "[C]";
+	}
+
+	if (*ar.what == 'm') {
+		return fmt::format("{:s}:main", ar.short_src);
+	}
+
+	return fmt::format("{:s}:{:d} {:s}", ar.short_src, ar.linedefined, ar.name ? ar.name : "?");
+}
+
+template <typename Map>
+auto sortedByWallTime(const Map& stats) {
+	std::vector<typename Map::const_pointer> sorted;
+	sorted.reserve(stats.size());
+	for (const auto& entry : stats) {
+		sorted.push_back(&entry);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](auto lhs, auto rhs) { return lhs->second.wallNs > rhs->second.wallNs; });
+	return sorted;
+}
+
+template <typename Map>
+void writeTable(std::ostream& os, std::string_view title, const Map& stats) {
+	os << fmt::format("{:s}\n{:>10s} {:>12s} {:>12s} {:>12s} {:>10s} {:>10s}  name\n", title, "calls", "wall ms", "self ms", "cpu ms", "avg us", "max us");
+	for (auto entry : sortedByWallTime(stats)) {
+		const auto& s = entry->second;
+		os << fmt::format("{:>10d} {:>12.3f} {:>12.3f} {:>12.3f} {:>10d} {:>10d}  {:s}\n", s.calls, s.wallNs / 1e6, s.selfNs / 1e6, s.cpuNs / 1e6,
+		                  s.wallNs / s.calls / 1000, s.maxWallNs / 1000, entry->first);
+	}
+	os << '\n';
+}
+
+bool writeFolded(const std::string& path, const std::unordered_map<std::string, uint64_t>& stacks) {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+
+	for (const auto& [stack, weight] : stacks) {
+		if (weight != 0) {
+			file << stack << ' ' << weight << '\n';
+		}
+	}
+	return file.good();
+}
+
+} // namespace
+
+void LuaProfiler::start(uint32_t sampleInterval) {
+	scripts.clear();
+	events.clear();
+	callbackStacks.clear();
+	sampledStacks.clear();
+
+	this->sampleInterval = sampleInterval;
+	sessionStart = wallTime();
+	sessionEnd = 0;
+	enabled = true;
+}
+
+void LuaProfiler::stop() {
+	if (enabled) {
+		sessionEnd = wallTime();
+		enabled = false;
+	}
+}
+
+void LuaProfiler::enter(lua_State* L, ScriptEnvironment* env) {
+	Frame& frame = frames.emplace_back();
+	if (env && env->getScriptInterface()) {
+		auto [scriptId, scriptInterface, callbackId, timerEvent] = env->getEventInfo();
+		frame.eventType = timerEvent ? "addEvent" : scriptInterface->getInterfaceName();
+		frame.label = scriptInterface->getFileById(callbackId ? callbackId : scriptId);
+	} else {
+		frame.eventType = "(unknown)";
+		frame.label = "(unknown)";
+	}
+
+	if (frames.size() > 1) {
+		frame.path = fmt::format("{:s};{:s}", frames[frames.size() - 2].path, frame.label);
+	} else {
+		frame.path = fmt::format("{:s};{:s}", frame.eventType, frame.label);
+	}
+
+	if (sampleInterval != 0 && lua_gethook(L) != &LuaProfiler::hook) {
+		lua_sethook(L, &LuaProfiler::hook, LUA_MASKCOUNT, sampleInterval);
+	}
+
+	frame.cpuStart = cpuTime();
+	frame.wallStart = wallTime();
+}
+
+void LuaProfiler::leave() {
+	if (frames.empty()) {
+		return;
+	}
+
+	int64_t wallNs = wallTime() - frames.back().wallStart;
+	int64_t cpuNs = cpuTime() - frames.back().cpuStart;
+
+	Frame frame = std::move(frames.back());
+	frames.pop_back();
+	if (!frames.empty()) {
+		frames.back().childNs += wallNs;
+	}
+
+	uint64_t selfNs = std::max<int64_t>(0, wallNs - frame.childNs);
+	for (Stats* stats : {&scripts[frame.label], &events[frame.eventType]}) {
+		++stats->calls;
+		stats->wallNs += wallNs;
+		stats->selfNs += selfNs;
+		stats->cpuNs += std::max<int64_t>(0, cpuNs);
+		stats->maxWallNs = std::max<uint64_t>(stats->maxWallNs, wallNs);
+	}
+	callbackStacks[frame.path] += selfNs / 1000;
+}
+
+void LuaProfiler::hook(lua_State* L, lua_Debug*) {
+	LuaProfiler& profiler = g_luaProfiler;
+	if (!profiler.enabled || profiler.sampleInterval == 0) {
+		// sampling was turned off since the hook was installed
+		lua_sethook(L, nullptr, 0, 0);
+		return;
+	}
+
+	std::vector<std::string> stack;
+	lua_Debug ar;
+	for (int level = 0; level < MAX_SAMPLED_FRAMES && lua_getstack(L, level, &ar) != 0; ++level) {
+		lua_getinfo(L, "Sn", &ar);
+		stack.push_back(describeFrame(ar));
+	}
+
+	std::string folded;
+	if (!profiler.frames.empty()) {
+		folded = fmt::format("{:s};{:s}", profiler.frames.front().eventType, profiler.frames.front().label);
+	} else {
+		folded = "(no callback)";
+	}
+
+	for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+		folded.push_back(';');
+		folded.append(*it);
+	}
+	++profiler.sampledStacks[folded];
+}
+
+int64_t LuaProfiler::wallTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t LuaProfiler::cpuTime() {
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+		return 0;
+	}
+
+	auto toNs = [](const FILETIME& time) {
+		return ((static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+	};
+	return toNs(kernelTime) + toNs(userTime);
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		return 0;
+	}
+	return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+std::string LuaProfiler::dump() const {
+	std::string prefix = fmt::format("{:s}-{:%Y%m%d-%H%M%S}", ConfigManager::getString(ConfigManager::LUA_PROFILER_OUTPUT), fmt::localtime(time(nullptr)));
+
+	std::filesystem::path parent = std::filesystem::path(prefix).parent_path();
+	if (!parent.empty()) {
+		std::error_code ec;
+		std::filesystem::create_directories(parent, ec);
+	}
+
+	std::ofstream summary(prefix + ".txt", std::ios::trunc);
+	if (!summary) {
+		std::cout << "[Error - LuaProfiler::dump] Unable to write " << prefix << ".txt" << std::endl;
+		return {};
+	}
+
+	int64_t duration = sessionStart != 0 ? (enabled ? wallTime() : sessionEnd) - sessionStart : 0;
+	summary << fmt::format("Lua profile, {:.3f} s{:s}\n\n", duration / 1e9, enabled ? " (still running)" : "");
+	writeTable(summary, "By event type:", events);
+	writeTable(summary, "By script:", scripts);
+
+	if (!summary.good() || !writeFolded(prefix + ".callbacks.folded", callbackStacks)) {
+		std::cout << "[Error - LuaProfiler::dump] Unable to write " << prefix << std::endl;
+		return {};
+	}
+
+	if (!sampledStacks.empty() && !writeFolded(prefix + ".samples.folded", sampledStacks)) {
+		std::cout << "[Error - LuaProfiler::dump] Unable to write " << prefix << ".samples.folded" << std::endl;
+		return {};
+	}
+
+	std::cout << ">> Lua profile written to " << prefix << ".*" << std::endl;
+	return prefix;
+}
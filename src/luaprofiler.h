@@ -0,0 +1,117 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAPROFILER_H
+#define FS_LUAPROFILER_H
+
+class ScriptEnvironment;
+struct lua_Debug;
+struct lua_State;
+
+/**
+ * Attributes the time spent inside Lua to the script that was called.
+ *
+ * Every protected call into Lua is measured (wall and thread CPU time) and
+ * accounted to the script file/event it belongs to and to the kind of event
+ * that triggered it (interface name, or addEvent for timer callbacks).
+ * Optionally a count hook samples the Lua call stack every N instructions.
+ * Both the callback stacks and the sampled stacks are written in the
+ * collapsed ("folded") format understood by flamegraph tools.
+ *
+ * All calls happen on the dispatcher thread. While the profiler is stopped
+ * the only cost is a single branch per call.
+ */
+class LuaProfiler {
+	public:
+		LuaProfiler() = default;
+
+		// non-copyable
+		LuaProfiler(const LuaProfiler&) = delete;
+		LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+		class Scope {
+			public:
+				Scope(lua_State* L, ScriptEnvironment* env);
+				~Scope();
+
+				// non-copyable
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+			private:
+				bool active = false;
+		};
+
+		/**
+		 * Discards the previous results and starts a new session.
+		 *
+		 * @param sampleInterval Lua instructions between two stack samples, 0 disables sampling
+		 */
+		void start(uint32_t sampleInterval);
+		void stop();
+
+		bool isEnabled() const {
+			return enabled;
+		}
+
+		/**
+		 * Writes the summary and the folded stacks of the current session.
+		 *
+		 * @return the common path prefix of the written files, empty on failure
+		 */
+		std::string dump() const;
+
+	private:
+		struct Stats {
+			uint64_t calls = 0;
+			uint64_t wallNs = 0;
+			uint64_t selfNs = 0;
+			uint64_t cpuNs = 0;
+			uint64_t maxWallNs = 0;
+		};
+
+		struct Frame {
+			std::string eventType;
+			std::string label;
+			std::string path;
+			int64_t wallStart;
+			int64_t cpuStart;
+			int64_t childNs = 0;
+		};
+
+		void enter(lua_State* L, ScriptEnvironment* env);
+		void leave();
+
+		static void hook(lua_State* L, lua_Debug* ar);
+		static int64_t wallTime();
+		static int64_t cpuTime();
+
+		std::vector<Frame> frames;
+
+		std::unordered_map<std::string, Stats> scripts;
+		std::map<std::string, Stats> events;
+		std::unordered_map<std::string, uint64_t> callbackStacks;
+		std::unordered_map<std::string, uint64_t> sampledStacks;
+
+		int64_t sessionStart = 0;
+		int64_t sessionEnd = 0;
+		uint32_t sampleInterval = 0;
+		bool enabled = false;
+};
+
+extern LuaProfiler g_luaProfiler;
+
+inline LuaProfiler::Scope::Scope(lua_State* L, ScriptEnvironment* env) {
+	if (g_luaProfiler.enabled) {
+		g_luaProfiler.enter(L, env);
+		active = true;
+	}
+}
+
+inline LuaProfiler::Scope::~Scope() {
+	if (active) {
+		g_luaProfiler.leave();
+	}
+}
+
+#endif // FS_LUAPROFILER_H
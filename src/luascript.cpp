@@ -18,6 +18,10 @@
 #include "inbox.h"
 #include "iologindata.h"
 #include "iomapserialize.h"
+#include "luachunkcache.h"
+#include "luaffi.h"
+#include "luagc.h"
+#include "luaprofiler.h"
 #include "luavariant.h"
 #include "matrixarea.h"
 #include "monster.h"
@@ -453,6 +457,9 @@ std::string lua::getErrorDesc(ErrorCode_t code) {
 }
 
 static std::array<ScriptEnvironment, 16> scriptEnv = {};
+
+// finished coroutine threads kept around for the next async call
+static constexpr size_t MAX_IDLE_COROUTINES = 32;
 static int32_t scriptEnvIndex = -1;
 
 LuaScriptInterface::LuaScriptInterface(std::string interfaceName) : interfaceName(std::move(interfaceName)) {
@@ -475,6 +482,8 @@ bool LuaScriptInterface::reInitState() {
 
 /// Same as lua_pcall, but adds stack trace to error strings in called function.
 int lua::protectedCall(lua_State* L, int nargs, int nresults) {
+        LuaProfiler::Scope profilerScope(L, scriptEnvIndex >= 0 ? &scriptEnv[scriptEnvIndex] : nullptr);
+
         int base = lua_gettop(L) - nargs;
         pushTraceback(L);
         lua_insert(L, base);
@@ -486,7 +495,7 @@ int lua::protectedCall(lua_State* L, int nargs, int nresults) {
 
 int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = nullptr*/) {
 	//loads file as a chunk at stack top
-	int ret = luaL_loadfile(L, file.data());
+	int ret = g_luaChunkCache.load(L, file);
 	if (ret != 0) {
 		lastLuaError = lua::popString(L);
 		return -1;
@@ -498,6 +507,11 @@ int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = null
 		return -1;
 	}
 
+	return runChunk(file, npc);
+}
+
+int32_t LuaScriptInterface::runChunk(const std::string& file, Npc* npc /* = nullptr*/) {
+	//executes the chunk at stack top as the given file
         loadingFile = file;
         lastLuaError.clear();
 
@@ -602,6 +616,32 @@ int32_t LuaScriptInterface::getMetaEvent(const std::string& globalName, const st
 	return runningEventId++;
 }
 
+std::set<int32_t> LuaScriptInterface::getEventIdsByFile(const std::string& file) const {
+	// entries are "<file>:<event name>"
+	std::set<int32_t> eventIds;
+	for (const auto& [eventId, name] : cacheFiles) {
+		if (name.size() > file.size() && name[file.size()] == ':' && name.compare(0, file.size(), file) == 0) {
+			eventIds.insert(eventId);
+		}
+	}
+	return eventIds;
+}
+
+void LuaScriptInterface::releaseEvent(int32_t eventId) {
+	if (eventId == -1 || !L) {
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, eventTableRef);
+	if (lua_istable(L, -1)) {
+		lua_pushnil(L);
+		lua_rawseti(L, -2, eventId);
+	}
+	lua_pop(L, 1);
+
+	cacheFiles.erase(eventId);
+}
+
 const std::string& LuaScriptInterface::getFileById(int32_t scriptId) {
 	if (scriptId == EVENT_ID_LOADING) {
 		return loadingFile;
@@ -752,11 +792,9 @@ void lua::pushThing(lua_State* L, Thing* thing) {
 	}
 
 	if (Item* item = thing->getItem()) {
-		pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		pushItem(L, item);
 	} else if (Creature* creature = thing->getCreature()) {
-		pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -764,11 +802,9 @@ void lua::pushThing(lua_State* L, Thing* thing) {
 
 void lua::pushCylinder(lua_State* L, Cylinder* cylinder) {
 	if (Creature* creature = cylinder->getCreature()) {
-		pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 	} else if (Item* parentItem = cylinder->getItem()) {
-		pushUserdata(L, parentItem);
-		lua::setItemMetatable(L, -1, parentItem);
+		pushItem(L, parentItem);
 	} else if (Tile* tile = cylinder->getTile()) {
 		pushUserdata(L, tile);
 		setMetatable(L, -1, "Tile");
@@ -841,6 +877,36 @@ static void setWeakMetatable(lua_State* L, int32_t index, const std::string& nam
 	lua_setmetatable(L, index - 1);
 }
 
+void lua::pushCreature(lua_State* L, const Creature* creature) {
+	const char* metatable;
+	if (creature->getPlayer()) {
+		metatable = "Player";
+	} else if (creature->getMonster()) {
+		metatable = "Monster";
+	} else {
+		metatable = "Npc";
+	}
+
+	g_luaEnvironment.getUserdataCache().push(L, const_cast<Creature*>(creature), metatable);
+}
+
+void lua::pushItem(lua_State* L, const Item* item) {
+	const char* metatable;
+	if (item->getContainer()) {
+		metatable = "Container";
+	} else if (item->getTeleport()) {
+		metatable = "Teleport";
+	} else {
+		metatable = "Item";
+	}
+
+	g_luaEnvironment.getUserdataCache().push(L, const_cast<Item*>(item), metatable);
+}
+
+void lua::releaseUserdata(const void* object) {
+	g_luaEnvironment.getUserdataCache().release(object);
+}
+
 void lua::setItemMetatable(lua_State* L, int32_t index, const Item* item) {
 	if (item->getContainer()) {
 		luaL_getmetatable(L, "Container");
@@ -1188,6 +1254,15 @@ void LuaScriptInterface::registerFunctions() {
 	//stopEvent(eventid)
 	lua_register(L, "stopEvent", LuaScriptInterface::luaStopEvent);
 
+	//async(callback, ...)
+	lua_register(L, "async", LuaScriptInterface::luaAsync);
+
+	//wait(delay)
+	lua_register(L, "wait", LuaScriptInterface::luaWait);
+
+	//dofile(filename), served from the chunk cache
+	lua_register(L, "dofile", LuaScriptInterface::luaDoFile);
+
 	//saveServer()
 	lua_register(L, "saveServer", LuaScriptInterface::luaSaveServer);
 
@@ -1904,6 +1979,7 @@ void LuaScriptInterface::registerFunctions() {
 	registerEnum(L, TILESTATE_FLOORCHANGE_SOUTH_ALT)
 	registerEnum(L, TILESTATE_FLOORCHANGE_EAST_ALT)
 	registerEnum(L, TILESTATE_SUPPORTS_HANGABLE)
+	registerEnum(L, TILESTATE_BLOCKPROJECTILE)
 
 	registerEnum(L, WEAPON_NONE)
 	registerEnum(L, WEAPON_SWORD)
@@ -2057,6 +2133,8 @@ void LuaScriptInterface::registerFunctions() {
 
 	registerEnum(L, RELOAD_TYPE_ALL)
 	registerEnum(L, RELOAD_TYPE_ACTIONS)
+	registerEnum(L, RELOAD_TYPE_BANS)
+	registerEnum(L, RELOAD_TYPE_CHANGED_SCRIPTS)
 	registerEnum(L, RELOAD_TYPE_CHAT)
 	registerEnum(L, RELOAD_TYPE_CONFIG)
 	registerEnum(L, RELOAD_TYPE_CREATURESCRIPTS)
@@ -2191,6 +2269,26 @@ void LuaScriptInterface::registerFunctions() {
         registerEnumIn(L, "configKeys", ConfigManager::ENABLE_REPUTATION_SYSTEM);
         registerEnumIn(L, "configKeys", ConfigManager::ENABLE_ECONOMY_SYSTEM);
         registerEnumIn(L, "configKeys", ConfigManager::ENABLE_MONSTER_RANK_SYSTEM);
+	registerEnumIn(L, "configKeys", ConfigManager::STATE_JOURNAL);
+	registerEnumIn(L, "configKeys", ConfigManager::STATE_JOURNAL_FILE);
+	registerEnumIn(L, "configKeys", ConfigManager::STATE_JOURNAL_FLUSH_INTERVAL);
+	registerEnumIn(L, "configKeys", ConfigManager::STATE_JOURNAL_MAX_SIZE);
+	registerEnumIn(L, "configKeys", ConfigManager::BAN_REFRESH_INTERVAL);
+	registerEnumIn(L, "configKeys", ConfigManager::SCRIPTS_HOT_RELOAD_INTERVAL);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_PROFILER);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_PROFILER_OUTPUT);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_PROFILER_SAMPLE_INTERVAL);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_BYTECODE_CACHE);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_BYTECODE_CACHE_PATH);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_GC_GOVERNOR);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_GC_MODE);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_GC_PAUSE);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_GC_STEP_MULTIPLIER);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_GC_STEP_SIZE);
+	registerEnumIn(L, "configKeys", ConfigManager::LUA_FFI_BINDINGS);
+	registerEnumIn(L, "configKeys", ConfigManager::MAX_SPAWNS_PER_TICK);
+	registerEnumIn(L, "configKeys", ConfigManager::LOAD_LAG_HIGH);
+	registerEnumIn(L, "configKeys", ConfigManager::LOAD_LAG_CRITICAL);
 
 	// os
 	registerMethod(L, "os", "mtime", LuaScriptInterface::luaSystemTime);
@@ -2262,6 +2360,12 @@ void LuaScriptInterface::registerFunctions() {
 
 	registerMethod(L, "Game", "reload", LuaScriptInterface::luaGameReload);
 
+	registerMethod(L, "Game", "startLuaProfiler", LuaScriptInterface::luaGameStartLuaProfiler);
+	registerMethod(L, "Game", "stopLuaProfiler", LuaScriptInterface::luaGameStopLuaProfiler);
+	registerMethod(L, "Game", "dumpLuaProfile", LuaScriptInterface::luaGameDumpLuaProfile);
+	registerMethod(L, "Game", "getLuaGcStats", LuaScriptInterface::luaGameGetLuaGcStats);
+	registerMethod(L, "Game", "getEventDispatchStats", LuaScriptInterface::luaGameGetEventDispatchStats);
+
 	registerMethod(L, "Game", "getAccountStorageValue", LuaScriptInterface::luaGameGetAccountStorageValue);
 	registerMethod(L, "Game", "setAccountStorageValue", LuaScriptInterface::luaGameSetAccountStorageValue);
 	registerMethod(L, "Game", "saveAccountStorageValues", LuaScriptInterface::luaGameSaveAccountStorageValues);
@@ -3842,6 +3946,48 @@ int LuaScriptInterface::luaStopEvent(lua_State* L) {
 	return 1;
 }
 
+int LuaScriptInterface::luaDoFile(lua_State* L) {
+	//dofile(filename)
+	std::string file = luaL_checkstring(L, 1);
+	lua_settop(L, 1);
+	if (g_luaChunkCache.load(L, file) != 0) {
+		return lua_error(L);
+	}
+
+	lua_call(L, 0, LUA_MULTRET);
+	return lua_gettop(L) - 1;
+}
+
+int LuaScriptInterface::luaAsync(lua_State* L) {
+	//async(callback, ...)
+	if (!lua_isfunction(L, 1)) {
+		reportErrorFunc(L, "callback parameter should be a function.");
+		lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	lua_pushnumber(L, g_luaEnvironment.startCoroutine(L, lua_gettop(L) - 1));
+	return 1;
+}
+
+int LuaScriptInterface::luaWait(lua_State* L) {
+	//wait(delay)
+	auto it = g_luaEnvironment.coroutineIds.find(L);
+	if (it == g_luaEnvironment.coroutineIds.end()) {
+		reportErrorFunc(L, "wait can only be used in a function started with async.");
+		lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	uint32_t id = it->second;
+	uint32_t delay = std::max<uint32_t>(SCHEDULER_MINTICKS, lua::getNumber<uint32_t>(L, 1));
+
+	LuaCoroutine& coroutine = g_luaEnvironment.coroutines[id];
+	uint32_t waitToken = ++coroutine.waitToken;
+	coroutine.eventId = g_scheduler.addEvent(createSchedulerTask(delay, [=]() { g_luaEnvironment.resumeCoroutine(id, waitToken); }));
+	return lua_yield(L, 0);
+}
+
 int LuaScriptInterface::luaSaveServer(lua_State* L) {
 	g_globalEvents->save();
 	g_game.saveGameState();
@@ -4361,8 +4507,7 @@ int LuaScriptInterface::luaGameGetSpectators(lua_State* L) {
 
 	int index = 0;
 	for (Creature* creature : spectators) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4374,8 +4519,7 @@ int LuaScriptInterface::luaGameGetPlayers(lua_State* L) {
 
 	int index = 0;
 	for (const auto& playerEntry : g_game.getPlayers()) {
-		lua::pushUserdata(L, playerEntry.second);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, playerEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4387,8 +4531,7 @@ int LuaScriptInterface::luaGameGetNpcs(lua_State* L) {
 
 	int index = 0;
 	for (const auto& npcEntry : g_game.getNpcs()) {
-		lua::pushUserdata(L, npcEntry.second);
-		lua::setMetatable(L, -1, "Npc");
+		lua::pushCreature(L, npcEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4400,8 +4543,7 @@ int LuaScriptInterface::luaGameGetMonsters(lua_State* L) {
 
 	int index = 0;
 	for (const auto& monsterEntry : g_game.getMonsters()) {
-		lua::pushUserdata(L, monsterEntry.second);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, monsterEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4631,8 +4773,7 @@ int LuaScriptInterface::luaGameCreateItem(lua_State* L) {
 		item->setParent(VirtualCylinder::virtualCylinder);
 	}
 
-	lua::pushUserdata(L, item);
-	lua::setItemMetatable(L, -1, item);
+	lua::pushItem(L, item);
 	return 1;
 }
 
@@ -4671,8 +4812,7 @@ int LuaScriptInterface::luaGameCreateContainer(lua_State* L) {
 		container->setParent(VirtualCylinder::virtualCylinder);
 	}
 
-	lua::pushUserdata(L, container);
-	lua::setMetatable(L, -1, "Container");
+	lua::pushItem(L, container);
 	return 1;
 }
 
@@ -4690,8 +4830,7 @@ int LuaScriptInterface::luaGameCreateMonster(lua_State* L) {
 	MagicEffectClasses magicEffect = lua::getNumber<MagicEffectClasses>(L, 5, CONST_ME_TELEPORT);
 	if (events::monster::onSpawn(monster, position, false, true) || force) {
 		if (g_game.placeCreature(monster, position, extended, force, magicEffect)) {
-			lua::pushUserdata(L, monster);
-			lua::setMetatable(L, -1, "Monster");
+			lua::pushCreature(L, monster);
 		} else {
 			delete monster;
 			lua_pushnil(L);
@@ -4716,8 +4855,7 @@ int LuaScriptInterface::luaGameCreateNpc(lua_State* L) {
 	bool force = lua::getBoolean(L, 4, false);
 	MagicEffectClasses magicEffect = lua::getNumber<MagicEffectClasses>(L, 5, CONST_ME_TELEPORT);
 	if (g_game.placeCreature(npc, position, extended, force, magicEffect)) {
-		lua::pushUserdata(L, npc);
-		lua::setMetatable(L, -1, "Npc");
+		lua::pushCreature(L, npc);
 	} else {
 		delete npc;
 		lua_pushnil(L);
@@ -4821,12 +4959,96 @@ int LuaScriptInterface::luaGameReload(lua_State* L) {
 	if (reloadType == RELOAD_TYPE_GLOBAL) {
 		lua::pushBoolean(L, g_luaEnvironment.loadFile("data/global.lua") == 0);
 		lua::pushBoolean(L, g_scripts->loadScripts("scripts/lib", true, true));
-		lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+		g_luaGcGovernor.fullCollect();
 		return 2;
 	}
 
 	lua::pushBoolean(L, g_game.reload(reloadType));
-	lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+	g_luaGcGovernor.fullCollect();
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStartLuaProfiler(lua_State* L) {
+	// Game.startLuaProfiler([sampleInterval = luaProfilerSampleInterval])
+	g_luaProfiler.start(lua::getNumber<uint32_t>(L, 1, ConfigManager::getNumber(ConfigManager::LUA_PROFILER_SAMPLE_INTERVAL)));
+	lua::pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStopLuaProfiler(lua_State* L) {
+	// Game.stopLuaProfiler()
+	lua::pushBoolean(L, g_luaProfiler.isEnabled());
+	g_luaProfiler.stop();
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpLuaProfile(lua_State* L) {
+	// Game.dumpLuaProfile()
+	std::string path = g_luaProfiler.dump();
+	if (path.empty()) {
+		lua_pushnil(L);
+	} else {
+		lua::pushString(L, path);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLuaGcStats(lua_State* L) {
+	// Game.getLuaGcStats()
+	auto pushHistogram = [L](const LuaGcGovernor::Histogram& histogram) {
+		lua_createtable(L, 0, 4);
+		setField(L, "count", histogram.count);
+		setField(L, "totalMs", histogram.totalNs / 1e6);
+		setField(L, "maxUs", histogram.maxNs / 1000);
+
+		// buckets[i] = {limitUs = upper bound, 0 for the last one, count = n}
+		lua_createtable(L, LuaGcGovernor::HISTOGRAM_BUCKETS, 0);
+		for (size_t i = 0; i < LuaGcGovernor::HISTOGRAM_BUCKETS; ++i) {
+			lua_createtable(L, 0, 2);
+			setField(L, "limitUs", i < LuaGcGovernor::BUCKET_LIMITS.size() ? LuaGcGovernor::BUCKET_LIMITS[i] : 0);
+			setField(L, "count", histogram.buckets[i]);
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_setfield(L, -2, "buckets");
+	};
+
+	lua_createtable(L, 0, 6);
+	setField(L, "memoryKb", lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOUNT, 0));
+	setField(L, "idleCycles", g_luaGcGovernor.getIdleCycles());
+	setField(L, "inTaskFreedKb", g_luaGcGovernor.getInTaskFreedKb());
+
+	pushHistogram(g_luaGcGovernor.getIdleSteps());
+	lua_setfield(L, -2, "idleSteps");
+
+	pushHistogram(g_luaGcGovernor.getFullCollections());
+	lua_setfield(L, -2, "fullCollections");
+
+	pushHistogram(g_luaGcGovernor.getInTaskCollections());
+	lua_setfield(L, -2, "inTaskCollections");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetEventDispatchStats(lua_State* L) {
+	// Game.getEventDispatchStats()
+	constexpr size_t count = static_cast<size_t>(BatchedEventId::LAST);
+
+	lua_createtable(L, 0, 2);
+	setField(L, "seconds", (OTSYS_TIME() - events::getDispatchStatsStart()) / 1000.);
+
+	// events[i] = {name = method, batched = bool, events = n, luaCalls = n}
+	lua_createtable(L, count, 0);
+	for (size_t i = 0; i < count; ++i) {
+		const auto id = static_cast<BatchedEventId>(i);
+		const events::DispatchStats& stats = events::getDispatchStats(id);
+		lua_createtable(L, 0, 4);
+		setField(L, "name", events::getBatchedEventName(id));
+		lua::pushBoolean(L, events::isBatched(id));
+		lua_setfield(L, -2, "batched");
+		setField(L, "events", stats.events);
+		setField(L, "luaCalls", stats.luaCalls);
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "events");
 	return 1;
 }
 
@@ -5107,8 +5329,7 @@ int LuaScriptInterface::luaTileGetGround(lua_State* L) {
 	// tile:getGround()
 	Tile* tile = lua::getUserdata<Tile>(L, 1);
 	if (tile && tile->getGround()) {
-		lua::pushUserdata(L, tile->getGround());
-		lua::setItemMetatable(L, -1, tile->getGround());
+		lua::pushItem(L, tile->getGround());
 	} else {
 		lua_pushnil(L);
 	}
@@ -5131,11 +5352,9 @@ int LuaScriptInterface::luaTileGetThing(lua_State* L) {
 	}
 
 	if (Creature* creature = thing->getCreature()) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 	} else if (Item* item = thing->getItem()) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5169,11 +5388,9 @@ int LuaScriptInterface::luaTileGetTopVisibleThing(lua_State* L) {
 	}
 
 	if (Creature* visibleCreature = thing->getCreature()) {
-		lua::pushUserdata(L, visibleCreature);
-		lua::setCreatureMetatable(L, -1, visibleCreature);
+		lua::pushCreature(L, visibleCreature);
 	} else if (Item* visibleItem = thing->getItem()) {
-		lua::pushUserdata(L, visibleItem);
-		lua::setItemMetatable(L, -1, visibleItem);
+		lua::pushItem(L, visibleItem);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5190,8 +5407,7 @@ int LuaScriptInterface::luaTileGetTopTopItem(lua_State* L) {
 
 	Item* item = tile->getTopTopItem();
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5208,8 +5424,7 @@ int LuaScriptInterface::luaTileGetTopDownItem(lua_State* L) {
 
 	Item* item = tile->getTopDownItem();
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5226,8 +5441,7 @@ int LuaScriptInterface::luaTileGetFieldItem(lua_State* L) {
 
 	Item* item = tile->getFieldItem();
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5256,8 +5470,7 @@ int LuaScriptInterface::luaTileGetItemById(lua_State* L) {
 
 	Item* item = g_game.findItemOfType(tile, itemId, false, subType);
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5307,8 +5520,7 @@ int LuaScriptInterface::luaTileGetItemByType(lua_State* L) {
 	if (Item* item = tile->getGround()) {
 		const ItemType& it = Item::items[item->getID()];
 		if (it.type == itemType) {
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 			return 1;
 		}
 	}
@@ -5317,8 +5529,7 @@ int LuaScriptInterface::luaTileGetItemByType(lua_State* L) {
 		for (Item* item : *items) {
 			const ItemType& it = Item::items[item->getID()];
 			if (it.type == itemType) {
-				lua::pushUserdata(L, item);
-				lua::setItemMetatable(L, -1, item);
+				lua::pushItem(L, item);
 				return 1;
 			}
 		}
@@ -5344,8 +5555,7 @@ int LuaScriptInterface::luaTileGetItemByTopOrder(lua_State* L) {
 		return 1;
 	}
 
-	lua::pushUserdata(L, item);
-	lua::setItemMetatable(L, -1, item);
+	lua::pushItem(L, item);
 	return 1;
 }
 
@@ -5388,8 +5598,7 @@ int LuaScriptInterface::luaTileGetBottomCreature(lua_State* L) {
 		return 1;
 	}
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	return 1;
 }
 
@@ -5407,8 +5616,7 @@ int LuaScriptInterface::luaTileGetTopCreature(lua_State* L) {
 		return 1;
 	}
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	return 1;
 }
 
@@ -5428,8 +5636,7 @@ int LuaScriptInterface::luaTileGetBottomVisibleCreature(lua_State* L) {
 
 	const Creature* visibleCreature = tile->getBottomVisibleCreature(creature);
 	if (visibleCreature) {
-		lua::pushUserdata(L, visibleCreature);
-		lua::setCreatureMetatable(L, -1, visibleCreature);
+		lua::pushCreature(L, visibleCreature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5452,8 +5659,7 @@ int LuaScriptInterface::luaTileGetTopVisibleCreature(lua_State* L) {
 
 	Creature* visibleCreature = tile->getTopVisibleCreature(creature);
 	if (visibleCreature) {
-		lua::pushUserdata(L, visibleCreature);
-		lua::setCreatureMetatable(L, -1, visibleCreature);
+		lua::pushCreature(L, visibleCreature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5478,8 +5684,7 @@ int LuaScriptInterface::luaTileGetItems(lua_State* L) {
 
 	int index = 0;
 	for (Item* item : *itemVector) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -5538,8 +5743,7 @@ int LuaScriptInterface::luaTileGetCreatures(lua_State* L) {
 
 	int index = 0;
 	for (Creature* creature : *creatureVector) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -5659,8 +5863,7 @@ int LuaScriptInterface::luaTileAddItem(lua_State* L) {
 
 	ReturnValue ret = g_game.internalAddItem(tile, item, INDEX_WHEREEVER, flags);
 	if (ret == RETURNVALUE_NOERROR) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		delete item;
 		lua_pushnil(L);
@@ -6234,8 +6437,7 @@ int LuaScriptInterface::luaItemCreate(lua_State* L) {
 
 	Item* item = lua::getScriptEnv()->getItemByUID(id);
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -6324,8 +6526,7 @@ int LuaScriptInterface::luaItemClone(lua_State* L) {
 	addTempItem(clone);
 	clone->setParent(VirtualCylinder::virtualCylinder);
 
-	lua::pushUserdata(L, clone);
-	lua::setItemMetatable(L, -1, clone);
+	lua::pushItem(L, clone);
 	return 1;
 }
 
@@ -6371,8 +6572,7 @@ int LuaScriptInterface::luaItemSplit(lua_State* L) {
 	splitItem->setParent(VirtualCylinder::virtualCylinder);
 	addTempItem(splitItem);
 
-	lua::pushUserdata(L, splitItem);
-	lua::setItemMetatable(L, -1, splitItem);
+	lua::pushItem(L, splitItem);
 	return 1;
 }
 
@@ -6420,6 +6620,7 @@ int LuaScriptInterface::luaItemSetActionId(lua_State* L) {
 	Item* item = lua::getUserdata<Item>(L, 1);
 	if (item) {
 		item->setActionId(actionId);
+		item->markHouseItemsDirty();
 		lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6593,7 +6794,9 @@ int LuaScriptInterface::luaItemGetAttribute(lua_State* L) {
 		attribute = ITEM_ATTRIBUTE_NONE;
 	}
 
-	if (ItemAttributes::isIntAttrType(attribute)) {
+	if (attribute == ITEM_ATTRIBUTE_DURATION) {
+		lua_pushnumber(L, item->getDuration());
+	} else if (ItemAttributes::isIntAttrType(attribute)) {
 		lua_pushnumber(L, item->getIntAttr(attribute));
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		lua::pushString(L, item->getStrAttr(attribute));
@@ -6627,10 +6830,16 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L) {
 			return 1;
 		}
 
-		item->setIntAttr(attribute, lua::getNumber<int32_t>(L, 3));
+		if (attribute == ITEM_ATTRIBUTE_DURATION) {
+			g_game.setItemDuration(item, lua::getNumber<int32_t>(L, 3));
+		} else {
+			item->setIntAttr(attribute, lua::getNumber<int32_t>(L, 3));
+			item->markHouseItemsDirty();
+		}
 		lua::pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, lua::getString(L, 3));
+		item->markHouseItemsDirty();
 		lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6658,6 +6867,7 @@ int LuaScriptInterface::luaItemRemoveAttribute(lua_State* L) {
 	bool ret = attribute != ITEM_ATTRIBUTE_UNIQUEID;
 	if (ret) {
 		item->removeAttribute(attribute);
+		item->markHouseItemsDirty();
 	} else {
 		reportErrorFunc(L, "Attempt to erase protected key \"uid\"");
 	}
@@ -6727,6 +6937,7 @@ int LuaScriptInterface::luaItemSetCustomAttribute(lua_State* L) {
 	}
 
 	item->setCustomAttribute(key, val);
+	item->markHouseItemsDirty();
 	lua::pushBoolean(L, true);
 	return 1;
 }
@@ -6739,13 +6950,20 @@ int LuaScriptInterface::luaItemRemoveCustomAttribute(lua_State* L) {
 		return 1;
 	}
 
+	bool removed;
 	if (isNumber(L, 2)) {
-		lua::pushBoolean(L, item->removeCustomAttribute(lua::getNumber<int64_t>(L, 2)));
+		removed = item->removeCustomAttribute(lua::getNumber<int64_t>(L, 2));
 	} else if (lua_isstring(L, 2)) {
-		lua::pushBoolean(L, item->removeCustomAttribute(lua::getString(L, 2)));
+		removed = item->removeCustomAttribute(lua::getString(L, 2));
 	} else {
 		lua_pushnil(L);
+		return 1;
+	}
+
+	if (removed) {
+		item->markHouseItemsDirty();
 	}
+	lua::pushBoolean(L, removed);
 	return 1;
 }
 
@@ -6933,6 +7151,7 @@ int LuaScriptInterface::luaItemSetStoreItem(lua_State* L) {
 	}
 
 	item->setStoreItem(lua::getBoolean(L, 2, false));
+	item->markHouseItemsDirty();
 	return 1;
 }
 
@@ -6954,8 +7173,7 @@ int LuaScriptInterface::luaContainerCreate(lua_State* L) {
 
 	Container* container = lua::getScriptEnv()->getContainerByUID(id);
 	if (container) {
-		lua::pushUserdata(L, container);
-		lua::setMetatable(L, -1, "Container");
+		lua::pushItem(L, container);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7027,8 +7245,7 @@ int LuaScriptInterface::luaContainerGetItem(lua_State* L) {
 	uint32_t index = lua::getNumber<uint32_t>(L, 2);
 	Item* item = container->getItemByIndex(index);
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7118,12 +7335,10 @@ int LuaScriptInterface::luaContainerAddItem(lua_State* L) {
 
 		if (hasTable) {
 			lua_pushnumber(L, i);
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 			lua_settable(L, -3);
 		} else {
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 		}
 	}
 	return 1;
@@ -7220,8 +7435,7 @@ int LuaScriptInterface::luaContainerGetItems(lua_State* L) {
 
 	int index = 0;
 	for (Item* item : items) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -7234,8 +7448,7 @@ int LuaScriptInterface::luaTeleportCreate(lua_State* L) {
 
 	Item* item = lua::getScriptEnv()->getItemByUID(id);
 	if (item && item->getTeleport()) {
-		lua::pushUserdata(L, item);
-		lua::setMetatable(L, -1, "Teleport");
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7258,6 +7471,7 @@ int LuaScriptInterface::luaTeleportSetDestination(lua_State* L) {
 	Teleport* teleport = lua::getUserdata<Teleport>(L, 1);
 	if (teleport) {
 		teleport->setDestPos(lua::getPosition(L, 2));
+		teleport->markHouseItemsDirty();
 		lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -7285,8 +7499,7 @@ int LuaScriptInterface::luaCreatureCreate(lua_State* L) {
 	}
 
 	if (creature) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7508,8 +7721,7 @@ int LuaScriptInterface::luaCreatureGetTarget(lua_State* L) {
 
 	Creature* target = creature->getAttackedCreature();
 	if (target) {
-		lua::pushUserdata(L, target);
-		lua::setCreatureMetatable(L, -1, target);
+		lua::pushCreature(L, target);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7545,8 +7757,7 @@ int LuaScriptInterface::luaCreatureGetFollowCreature(lua_State* L) {
 
 	Creature* followCreature = creature->getFollowCreature();
 	if (followCreature) {
-		lua::pushUserdata(L, followCreature);
-		lua::setCreatureMetatable(L, -1, followCreature);
+		lua::pushCreature(L, followCreature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7586,8 +7797,7 @@ int LuaScriptInterface::luaCreatureGetMaster(lua_State* L) {
 		return 1;
 	}
 
-	lua::pushUserdata(L, master);
-	lua::setCreatureMetatable(L, -1, master);
+	lua::pushCreature(L, master);
 	return 1;
 }
 
@@ -8139,8 +8349,7 @@ int LuaScriptInterface::luaCreatureGetSummons(lua_State* L) {
 
 	int index = 0;
 	for (Creature* summon : creature->getSummons()) {
-		lua::pushUserdata(L, summon);
-		lua::setCreatureMetatable(L, -1, summon);
+		lua::pushCreature(L, summon);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -8295,8 +8504,7 @@ int LuaScriptInterface::luaPlayerCreate(lua_State* L) {
 	}
 
 	if (player) {
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 	} else {
 		lua_pushnil(L);
 	}
@@ -8914,8 +9122,7 @@ int LuaScriptInterface::luaPlayerGetItemById(lua_State* L) {
 
 	Item* item = g_game.findItemOfType(player, itemId, deepSearch, subType);
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -9305,12 +9512,10 @@ int LuaScriptInterface::luaPlayerAddItem(lua_State* L) {
 
 		if (hasTable) {
 			lua_pushnumber(L, i);
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 			lua_settable(L, -3);
 		} else {
-			lua::pushUserdata(L, item);
-			lua::setItemMetatable(L, -1, item);
+			lua::pushItem(L, item);
 		}
 	}
 	return 1;
@@ -9608,8 +9813,7 @@ int LuaScriptInterface::luaPlayerGetSlotItem(lua_State* L) {
 
 	Item* item = thing->getItem();
 	if (item) {
-		lua::pushUserdata(L, item);
-		lua::setItemMetatable(L, -1, item);
+		lua::pushItem(L, item);
 	} else {
 		lua_pushnil(L);
 	}
@@ -10163,8 +10367,7 @@ int LuaScriptInterface::luaPlayerGetContainerById(lua_State* L) {
 
 	Container* container = player->getContainerByID(lua::getNumber<uint8_t>(L, 2));
 	if (container) {
-		lua::pushUserdata(L, container);
-		lua::setMetatable(L, -1, "Container");
+		lua::pushItem(L, container);
 	} else {
 		lua_pushnil(L);
 	}
@@ -10266,8 +10469,7 @@ int LuaScriptInterface::luaPlayerGetStoreInbox(lua_State* L) {
 		return 1;
 	}
 
-	lua::pushUserdata(L, storeInbox);
-	lua::setMetatable(L, -1, "Container");
+	lua::pushItem(L, storeInbox);
 	return 1;
 }
 
@@ -10453,8 +10655,7 @@ int LuaScriptInterface::luaMonsterCreate(lua_State* L) {
 	}
 
 	if (monster) {
-		lua::pushUserdata(L, monster);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, monster);
 	} else {
 		lua_pushnil(L);
 	}
@@ -10663,8 +10864,7 @@ int LuaScriptInterface::luaMonsterGetFriendList(lua_State* L) {
 
 	int index = 0;
 	for (Creature* creature : friendList) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -10824,8 +11024,7 @@ int LuaScriptInterface::luaMonsterGetTargetList(lua_State* L) {
 
 	int index = 0;
 	for (Creature* creature : targetList) {
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -10917,8 +11116,7 @@ int LuaScriptInterface::luaNpcCreate(lua_State* L) {
 	}
 
 	if (npc) {
-		lua::pushUserdata(L, npc);
-		lua::setMetatable(L, -1, "Npc");
+		lua::pushCreature(L, npc);
 	} else {
 		lua_pushnil(L);
 	}
@@ -10994,8 +11192,7 @@ int LuaScriptInterface::luaNpcGetSpectators(lua_State* L) {
 
 	int index = 0;
 	for (const auto& spectatorPlayer : npc->getSpectators()) {
-		lua::pushUserdata(L, spectatorPlayer);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, spectatorPlayer);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11051,8 +11248,7 @@ int LuaScriptInterface::luaGuildGetMembersOnline(lua_State* L) {
 
 	int index = 0;
 	for (Player* player : members) {
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11786,8 +11982,7 @@ int LuaScriptInterface::luaHouseGetBeds(lua_State* L) {
 
 	int index = 0;
 	for (BedItem* bedItem : beds) {
-		lua::pushUserdata<Item>(L, bedItem);
-		lua::setItemMetatable(L, -1, bedItem);
+		lua::pushItem(L, bedItem);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11817,8 +12012,7 @@ int LuaScriptInterface::luaHouseGetDoors(lua_State* L) {
 
 	int index = 0;
 	for (Door* door : doors) {
-		lua::pushUserdata<Item>(L, door);
-		lua::setItemMetatable(L, -1, door);
+		lua::pushItem(L, door);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11888,8 +12082,7 @@ int LuaScriptInterface::luaHouseGetItems(lua_State* L) {
 		TileItemVector* itemVector = tile->getItemList();
 		if (itemVector) {
 			for (Item* item : *itemVector) {
-				lua::pushUserdata(L, item);
-				lua::setItemMetatable(L, -1, item);
+				lua::pushItem(L, item);
 				lua_rawseti(L, -2, ++index);
 			}
 		}
@@ -14766,8 +14959,7 @@ int LuaScriptInterface::luaPartyGetLeader(lua_State* L) {
 
 	Player* leader = party->getLeader();
 	if (leader) {
-		lua::pushUserdata(L, leader);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, leader);
 	} else {
 		lua_pushnil(L);
 	}
@@ -14797,8 +14989,7 @@ int LuaScriptInterface::luaPartyGetMembers(lua_State* L) {
 	int index = 0;
 	lua_createtable(L, party->getMemberCount(), 0);
 	for (Player* player : party->getMembers()) {
-		lua::pushUserdata(L, player);
-		lua::setMetatable(L, -1, "Player");
+		lua::pushCreature(L, player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -14823,8 +15014,7 @@ int LuaScriptInterface::luaPartyGetInvitees(lua_State* L) {
 
 		int index = 0;
 		for (Player* player : party->getInvitees()) {
-			lua::pushUserdata(L, player);
-			lua::setMetatable(L, -1, "Player");
+			lua::pushCreature(L, player);
 			lua_rawseti(L, -2, ++index);
 		}
 	} else {
@@ -17316,6 +17506,9 @@ bool LuaEnvironment::initState() {
         lua_atpanic(L, luaPanic);
         luaL_openlibs(L);
         registerFunctions();
+        registerLuaFfiBindings(L);
+        userdataCache.attach(L);
+        g_luaGcGovernor.attach(L);
 
 	runningEventId = EVENT_ID_USER;
 	return true;
@@ -17348,11 +17541,20 @@ bool LuaEnvironment::closeState() {
 		luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
 	}
 
+	for (const auto& coroutineEntry : coroutines) {
+		g_scheduler.stopEvent(coroutineEntry.second.eventId);
+	}
+
 	combatIdMap.clear();
 	areaIdMap.clear();
 	timerEvents.clear();
+	coroutines.clear();
+	coroutineIds.clear();
+	idleCoroutines.clear();
 	cacheFiles.clear();
 
+	g_luaGcGovernor.attach(nullptr);
+	userdataCache.attach(nullptr);
 	lua_close(L);
 	L = nullptr;
 	return true;
@@ -17458,4 +17660,83 @@ void LuaEnvironment::executeTimerEvent(uint32_t eventIndex) {
 	for (auto parameter : timerEventDesc.parameters) {
 		luaL_unref(L, LUA_REGISTRYINDEX, parameter);
 	}
-}
\ No newline at end of file
+}
+
+uint32_t LuaEnvironment::startCoroutine(lua_State* L, int nargs) {
+	LuaCoroutine coroutine;
+	if (!idleCoroutines.empty()) {
+		std::tie(coroutine.thread, coroutine.threadRef) = idleCoroutines.back();
+		idleCoroutines.pop_back();
+	} else {
+		coroutine.thread = lua_newthread(this->L);
+		coroutine.threadRef = luaL_ref(this->L, LUA_REGISTRYINDEX);
+	}
+
+	coroutine.scriptId = lua::getScriptEnv()->getScriptId();
+	lua_xmove(L, coroutine.thread, nargs + 1);
+
+	uint32_t id = lastCoroutineId++;
+	coroutineIds[coroutine.thread] = id;
+	coroutines.emplace(id, coroutine);
+
+	runCoroutine(id, nargs);
+	return coroutines.contains(id) ? id : 0;
+}
+
+void LuaEnvironment::resumeCoroutine(uint32_t id, uint32_t waitToken) {
+	auto it = coroutines.find(id);
+	if (it == coroutines.end() || it->second.waitToken != waitToken || lua_status(it->second.thread) != LUA_YIELD) {
+		return;
+	}
+
+	it->second.eventId = 0;
+	runCoroutine(id, 0);
+}
+
+void LuaEnvironment::runCoroutine(uint32_t id, int nargs) {
+	// the coroutine may start others, so nothing refers into the map while it runs
+	const LuaCoroutine coroutine = coroutines[id];
+	lua_State* thread = coroutine.thread;
+
+	int status = LUA_ERRRUN;
+	if (lua::reserveScriptEnv()) {
+		ScriptEnvironment* env = lua::getScriptEnv();
+		env->setTimerEvent();
+		env->setScriptId(coroutine.scriptId, this);
+
+		{
+			LuaProfiler::Scope profilerScope(thread, env);
+#if LUA_VERSION_NUM >= 504
+			int nresults;
+			status = lua_resume(thread, L, nargs, &nresults);
+#elif LUA_VERSION_NUM >= 502
+			status = lua_resume(thread, L, nargs);
+#else
+			status = lua_resume(thread, nargs);
+#endif
+		}
+
+		if (status == LUA_YIELD) {
+			lua_settop(thread, 0);
+			lua::resetScriptEnv();
+			return;
+		}
+
+		if (status != 0) {
+			reportErrorFunc(nullptr, lua::popString(thread));
+		}
+		lua::resetScriptEnv();
+	} else {
+		std::cout << "[Error - LuaEnvironment::runCoroutine] Call stack overflow" << std::endl;
+	}
+
+	coroutineIds.erase(thread);
+	if (status == 0 && idleCoroutines.size() < MAX_IDLE_COROUTINES) {
+		// a coroutine that returned normally can run another function
+		lua_settop(thread, 0);
+		idleCoroutines.emplace_back(thread, coroutine.threadRef);
+	} else {
+		luaL_unref(L, LUA_REGISTRYINDEX, coroutine.threadRef);
+	}
+	coroutines.erase(id);
+}
@@ -7,6 +7,7 @@
 #include "database.h"
 #include "enums.h"
 #include "position.h"
+#include "scripting/LuaUserdataCache.h"
 
 #if LUA_VERSION_NUM >= 502
 #ifndef LUA_COMPAT_ALL
@@ -48,6 +49,14 @@ struct LuaTimerEventDesc {
 	LuaTimerEventDesc(LuaTimerEventDesc&& other) = default;
 };
 
+struct LuaCoroutine {
+	lua_State* thread = nullptr;
+	int32_t threadRef = -1;
+	int32_t scriptId = -1;
+	uint32_t eventId = 0;
+	uint32_t waitToken = 0;
+};
+
 class ScriptEnvironment {
 	public:
 		ScriptEnvironment();
@@ -144,11 +153,24 @@ class LuaScriptInterface {
 
 		int32_t loadFile(const std::string& file, Npc* npc = nullptr);
 
+		/**
+		 * Executes the chunk at the top of the stack as if it was loaded from the given file.
+		 *
+		 * @return 0 on success, -1 otherwise
+		 */
+		int32_t runChunk(const std::string& file, Npc* npc = nullptr);
+
 		const std::string& getFileById(int32_t scriptId);
 		int32_t getEvent(std::string_view eventName);
 		int32_t getEvent();
 		int32_t getMetaEvent(const std::string& globalName, const std::string& eventName);
 
+		/**
+		 * @return the ids of every event function the file registered while it was loaded
+		 */
+		std::set<int32_t> getEventIdsByFile(const std::string& file) const;
+		void releaseEvent(int32_t eventId);
+
 		const std::string& getInterfaceName() const {
 			return interfaceName;
 		}
@@ -220,6 +242,11 @@ class LuaScriptInterface {
 		static int luaAddEvent(lua_State* L);
 		static int luaStopEvent(lua_State* L);
 
+		static int luaAsync(lua_State* L);
+		static int luaWait(lua_State* L);
+
+		static int luaDoFile(lua_State* L);
+
 		static int luaSaveServer(lua_State* L);
 		static int luaCleanMap(lua_State* L);
 
@@ -334,6 +361,12 @@ class LuaScriptInterface {
 
 		static int luaGameReload(lua_State* L);
 
+		static int luaGameStartLuaProfiler(lua_State* L);
+		static int luaGameStopLuaProfiler(lua_State* L);
+		static int luaGameDumpLuaProfile(lua_State* L);
+		static int luaGameGetLuaGcStats(lua_State* L);
+		static int luaGameGetEventDispatchStats(lua_State* L);
+
 		static int luaGameGetAccountStorageValue(lua_State* L);
 		static int luaGameSetAccountStorageValue(lua_State* L);
 		static int luaGameSaveAccountStorageValues(lua_State* L);
@@ -1401,10 +1434,27 @@ class LuaEnvironment : public LuaScriptInterface {
 		uint32_t createAreaObject(LuaScriptInterface* interface);
 		void clearAreaObjects(LuaScriptInterface* interface);
 
+		LuaUserdataCache& getUserdataCache() {
+			return userdataCache;
+		}
+
 	private:
 		void executeTimerEvent(uint32_t eventIndex);
 
+		/**
+		 * Runs the function and arguments on top of L in a pooled coroutine
+		 * until it returns or yields through wait().
+		 *
+		 * @return the coroutine id, 0 if it already finished
+		 */
+		uint32_t startCoroutine(lua_State* L, int nargs);
+		void resumeCoroutine(uint32_t id, uint32_t waitToken);
+		void runCoroutine(uint32_t id, int nargs);
+
 		std::unordered_map<uint32_t, LuaTimerEventDesc> timerEvents;
+		std::unordered_map<uint32_t, LuaCoroutine> coroutines;
+		std::unordered_map<lua_State*, uint32_t> coroutineIds;
+		std::vector<std::pair<lua_State*, int32_t>> idleCoroutines;
 		std::unordered_map<uint32_t, Combat_ptr> combatMap;
 		std::unordered_map<uint32_t, AreaCombat*> areaMap;
 
@@ -1414,9 +1464,12 @@ class LuaEnvironment : public LuaScriptInterface {
 		LuaScriptInterface* testInterface = nullptr;
 
 		uint32_t lastEventTimerId = 1;
+		uint32_t lastCoroutineId = 1;
 		uint32_t lastCombatId = 0;
 		uint32_t lastAreaId = 0;
 
+		LuaUserdataCache userdataCache;
+
 		friend class LuaScriptInterface;
 		friend class CombatSpell;
 };
@@ -1450,6 +1503,11 @@ namespace lua {
 		*userdata = value;
 	}
 
+	// Creatures and items reuse one userdata per object while it is referenced from Lua
+	void pushCreature(lua_State* L, const Creature* creature);
+	void pushItem(lua_State* L, const Item* item);
+	void releaseUserdata(const void* object);
+
 
 	// Metatables
 	void setMetatable(lua_State* L, int32_t index, std::string_view name);
@@ -12,6 +12,8 @@
 #include "iomapserialize.h"
 #include "monster.h"
 #include "spectators.h"
+#include "tasks.h"
+#include "utils/StartupProbe.h"
 
 extern Game g_game;
 
@@ -32,6 +34,8 @@ bool Map::loadMap(const std::string& identifier, bool loadHouses, bool isCalledB
 		}
 
 		IOMapSerialize::loadHouseInfo();
+		StartupProbe::mark("map");
+
 		IOMapSerialize::loadHouseItems(this);
 	}
 	return true;
@@ -135,6 +139,7 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile) {
 	} else {
 		tile = newTile;
 	}
+	SightCache::invalidateAll();
 }
 
 void Map::removeTile(uint16_t x, uint16_t y, uint8_t z) {
@@ -328,7 +333,8 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	newTile.postAddNotification(&creature, &oldTile, 0);
 }
 
-void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const {
+template <typename Spectators>
+void Map::getSpectatorsInternal(Spectators& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, CreatureVector QTreeLeafNode::* nodeList) const {
 	auto min_y = centerPos.y + minRangeY;
 	auto min_x = centerPos.x + minRangeX;
 	auto max_y = centerPos.y + maxRangeY;
@@ -355,7 +361,7 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 		leafE = leafS;
 		for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
 			if (leafE) {
-				const CreatureVector& node_list = (onlyPlayers ? leafE->player_list : leafE->creature_list);
+				const CreatureVector& node_list = leafE->*nodeList;
 				for (Creature* creature : node_list) {
 					const Position& cpos = creature->getPosition();
 					if (minRangeZ > cpos.z || maxRangeZ < cpos.z) {
@@ -437,30 +443,9 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	}
 
 	if (!foundCache) {
-		int32_t minRangeZ;
-		int32_t maxRangeZ;
-
-		if (multifloor) {
-			if (centerPos.z > 7) {
-				//underground (8->15)
-				minRangeZ = std::max(centerPos.getZ() - 2, 0);
-				maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == 6) {
-				minRangeZ = 0;
-				maxRangeZ = 8;
-			} else if (centerPos.z == 7) {
-				minRangeZ = 0;
-				maxRangeZ = 9;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = 7;
-			}
-		} else {
-			minRangeZ = centerPos.z;
-			maxRangeZ = centerPos.z;
-		}
-
-		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		const auto [minRangeZ, maxRangeZ] = getSpectatorFloors(centerPos, multifloor);
+		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
+		                      onlyPlayers ? &QTreeLeafNode::player_list : &QTreeLeafNode::creature_list);
 
 		if (cacheResult) {
 			if (onlyPlayers) {
@@ -472,6 +457,59 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
         }
 }
 
+std::pair<int32_t, int32_t> Map::getSpectatorFloors(const Position& centerPos, bool multifloor) {
+	if (!multifloor) {
+		return {centerPos.z, centerPos.z};
+	}
+
+	if (centerPos.z > 7) {
+		//underground (8->15)
+		return {std::max(centerPos.getZ() - 2, 0), std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1)};
+	} else if (centerPos.z == 6) {
+		return {0, 8};
+	} else if (centerPos.z == 7) {
+		return {0, 9};
+	}
+	return {0, 7};
+}
+
+bool Map::isInSpectatorRange(const Position& centerPos, const Position& pos, bool multifloor) {
+	const auto [minRangeZ, maxRangeZ] = getSpectatorFloors(centerPos, multifloor);
+	if (minRangeZ > pos.z || maxRangeZ < pos.z) {
+		return false;
+	}
+
+	// same bounds as getSpectatorsInternal
+	const int32_t offsetZ = centerPos.getOffsetZ(pos);
+	return (centerPos.x - maxViewportX + offsetZ) <= pos.x && (centerPos.x + maxViewportX + offsetZ) >= pos.x
+		&& (centerPos.y - maxViewportY + offsetZ) <= pos.y && (centerPos.y + maxViewportY + offsetZ) >= pos.y;
+}
+
+void Map::getNearestPlayerSide(CreatureVector& creatures, const Position& centerPos, bool multifloor /*= false*/, size_t maxCount /*= std::numeric_limits<size_t>::max()*/) const {
+	if (centerPos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	const size_t first = creatures.size();
+	const auto [minRangeZ, maxRangeZ] = getSpectatorFloors(centerPos, multifloor);
+	getSpectatorsInternal(creatures, centerPos, -maxViewportX, maxViewportX, -maxViewportY, maxViewportY, minRangeZ, maxRangeZ, &QTreeLeafNode::player_side_list);
+
+	// the distance Monster::searchTarget looks for the nearest target with
+	auto nearer = [&centerPos](const Creature* lhs, const Creature* rhs) {
+		const Position& lhsPos = lhs->getPosition();
+		const Position& rhsPos = rhs->getPosition();
+		return centerPos.getDistanceX(lhsPos) + centerPos.getDistanceY(lhsPos) < centerPos.getDistanceX(rhsPos) + centerPos.getDistanceY(rhsPos);
+	};
+
+	auto begin = creatures.begin() + first;
+	if (maxCount < static_cast<size_t>(creatures.end() - begin)) {
+		std::partial_sort(begin, begin + maxCount, creatures.end(), nearer);
+		creatures.resize(first + maxCount);
+	} else {
+		std::sort(begin, creatures.end(), nearer);
+	}
+}
+
 #if ENABLE_INSTANCING
 void Map::getSpectatorsByInstance(SpectatorVec& spectators, const Position& centerPos, uint32_t instanceId, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/) {
         getSpectators(spectators, centerPos, multifloor, onlyPlayers, minRangeX, maxRangeX, minRangeY, maxRangeY);
@@ -521,24 +559,57 @@ bool Map::isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor /*= fal
 	}
 
 	if (pathfinding) {
-		return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !tile->hasProperty(CONST_PROP_BLOCKPATH) &&
+		return !tile->hasFlag(TILESTATE_BLOCKPROJECTILE) && !tile->hasProperty(CONST_PROP_BLOCKPATH) &&
 		       !tile->hasProperty(CONST_PROP_BLOCKSOLID) && !tile->hasProperty(CONST_PROP_IMMOVABLEBLOCKPATH) &&
 		       !tile->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID) && !tile->getTopCreature();
 	}
 
-	return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
+	return !tile->hasFlag(TILESTATE_BLOCKPROJECTILE);
 }
 
 namespace {
 
-	bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) {
+	// Looks up the tiles along a line on one floor, descending the quadtree only when the line enters another leaf
+	class SightLineTiles {
+		public:
+			SightLineTiles(const QTreeNode& root, uint8_t z) : root(root), z(z) {}
+
+			bool blocksProjectile(uint16_t x, uint16_t y) {
+				const uint32_t leafX = x & ~FLOOR_MASK;
+				const uint32_t leafY = y & ~FLOOR_MASK;
+				if (leafX != lastLeafX || leafY != lastLeafY) {
+					lastLeafX = leafX;
+					lastLeafY = leafY;
+
+					const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
+					floor = leaf ? leaf->getFloor(z) : nullptr;
+				}
+
+				if (!floor) {
+					return false;
+				}
+
+				const Tile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+				return tile && tile->hasFlag(TILESTATE_BLOCKPROJECTILE);
+			}
+
+		private:
+			const QTreeNode& root;
+			const Floor* floor = nullptr;
+			uint32_t lastLeafX = std::numeric_limits<uint32_t>::max();
+			uint32_t lastLeafY = std::numeric_limits<uint32_t>::max();
+			uint8_t z;
+	};
+
+	template <typename IsClear>
+	bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, IsClear&& isClear) {
 		float dx = x1 - x0;
 		float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
 		float yi = y0 + slope;
 
 		for (uint16_t x = x0 + 1; x < x1; ++x) {
 			//0.1 is necessary to avoid loss of precision during calculation
-			if (!g_game.map.isTileClear(std::floor(yi + 0.1), x, z, false, pathfinding)) {
+			if (!isClear(std::floor(yi + 0.1), x)) {
 				return false;
 			}
 			yi += slope;
@@ -547,14 +618,15 @@ namespace {
 		return true;
 	}
 
-	bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) {
+	template <typename IsClear>
+	bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, IsClear&& isClear) {
 		float dx = x1 - x0;
 		float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
 		float yi = y0 + slope;
 
 		for (uint16_t x = x0 + 1; x < x1; ++x) {
 			//0.1 is necessary to avoid loss of precision during calculation
-			if (!g_game.map.isTileClear(x, std::floor(yi + 0.1), z, false, pathfinding)) {
+			if (!isClear(x, std::floor(yi + 0.1))) {
 				return false;
 			}
 			yi += slope;
@@ -563,29 +635,67 @@ namespace {
 		return true;
 	}
 
+	// isClear(x, y) is called for the tiles strictly between both ends
+	template <typename IsClear>
+	bool checkLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, IsClear&& isClear) {
+		if (x0 == x1 && y0 == y1) {
+			return true;
+		}
+
+		if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
+			if (y1 > y0) {
+				return checkSteepLine(y0, x0, y1, x1, isClear);
+			}
+
+			return checkSteepLine(y1, x1, y0, x0, isClear);
+		}
+
+		if (x0 > x1) {
+			return checkSlightLine(x1, y1, x0, y0, isClear);
+		}
+
+		return checkSlightLine(x0, y0, x1, y1, isClear);
+	}
+
 }
 
 bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, bool pathfinding /*= false*/) const {
-	if (x0 == x1 && y0 == y1) {
+	if (pathfinding) {
+		return checkLine(x0, y0, x1, y1, [this, z](uint16_t x, uint16_t y) {
+			return isTileClear(x, y, z, false, true);
+		});
+	}
+
+	if (z >= MAP_MAX_LAYERS) {
 		return true;
 	}
 
-	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
-		if (y1 > y0) {
-			return checkSteepLine(y0, x0, y1, x1, z, pathfinding);
-		}
+	SightLineTiles tiles(root, z);
+	return checkLine(x0, y0, x1, y1, [&tiles](uint16_t x, uint16_t y) {
+		return !tiles.blocksProjectile(x, y);
+	});
+}
 
-		return checkSteepLine(y1, x1, y0, x0, z, pathfinding);
+bool Map::isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor /*= false*/, bool pathfinding /*= false*/) const {
+	// pathfinding also checks for creatures, which move too often to remember the result
+	if (pathfinding) {
+		return isSightLineClear(fromPos, toPos, sameFloor, true);
 	}
 
-	if (x0 > x1) {
-		return checkSlightLine(x1, y1, x0, y0, z, pathfinding);
+	uint64_t key;
+	if (!SightCache::makeKey(fromPos, toPos, sameFloor, key)) {
+		return isSightLineClear(fromPos, toPos, sameFloor, false);
 	}
 
-	return checkSlightLine(x0, y0, x1, y1, z, pathfinding);
+	bool sightClear;
+	if (!sightCache.find(key, g_dispatcher.getDispatcherCycle(), sightClear)) {
+		sightClear = isSightLineClear(fromPos, toPos, sameFloor, false);
+		sightCache.insert(key, sightClear);
+	}
+	return sightClear;
 }
 
-bool Map::isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor /*= false*/, bool pathfinding /*= false*/) const {
+bool Map::isSightLineClear(const Position& fromPos, const Position& toPos, bool sameFloor, bool pathfinding) const {
 	//target is on the same floor
 	if (fromPos.z == toPos.z) {
 		//skip checks if toPos is next to us
@@ -1000,6 +1110,10 @@ void QTreeLeafNode::addCreature(Creature* c) {
 	if (c->getPlayer()) {
 		player_list.push_back(c);
 	}
+
+	if (isPlayerSide(c)) {
+		player_side_list.push_back(c);
+	}
 }
 
 void QTreeLeafNode::removeCreature(Creature* c) {
@@ -1014,6 +1128,37 @@ void QTreeLeafNode::removeCreature(Creature* c) {
 		*iter = player_list.back();
 		player_list.pop_back();
 	}
+
+	iter = std::find(player_side_list.begin(), player_side_list.end(), c);
+	if (iter != player_side_list.end()) {
+		*iter = player_side_list.back();
+		player_side_list.pop_back();
+	}
+}
+
+void QTreeLeafNode::updateCreature(Creature* c) {
+	if (std::find(creature_list.begin(), creature_list.end(), c) == creature_list.end()) {
+		return;
+	}
+
+	auto iter = std::find(player_side_list.begin(), player_side_list.end(), c);
+	if (iter != player_side_list.end()) {
+		if (!isPlayerSide(c)) {
+			*iter = player_side_list.back();
+			player_side_list.pop_back();
+		}
+	} else if (isPlayerSide(c)) {
+		player_side_list.push_back(c);
+	}
+}
+
+bool QTreeLeafNode::isPlayerSide(const Creature* c) {
+	if (c->getPlayer()) {
+		return true;
+	}
+
+	const Creature* master = c->getMaster();
+	return master && master->getPlayer();
 }
 
 uint32_t Map::clean() const {
@@ -7,6 +7,7 @@
 #include "definitions.h"
 #include "house.h"
 #include "position.h"
+#include "sightcache.h"
 #include "spawn.h"
 #include "spectators.h"
 #include "town.h"
@@ -131,6 +132,11 @@ class QTreeLeafNode final : public QTreeNode {
 
 		void addCreature(Creature* c);
 		void removeCreature(Creature* c);
+		// files c again after it got or lost a master
+		void updateCreature(Creature* c);
+
+		// players and the summons of players, whom monsters without a player master attack
+		static bool isPlayerSide(const Creature* c);
 
 	private:
 		static bool newLeaf;
@@ -139,6 +145,7 @@ class QTreeLeafNode final : public QTreeNode {
 		Floor* array[MAP_MAX_LAYERS] = {};
 		CreatureVector creature_list;
 		CreatureVector player_list;
+		CreatureVector player_side_list;
 
 		friend class Map;
 		friend class QTreeNode;
@@ -220,6 +227,24 @@ class Map {
                                              int32_t minRangeY = 0, int32_t maxRangeY = 0);
 #endif
 
+		/**
+		  * Checks if getSpectators around centerPos with the default range finds a creature standing at pos
+		  * \param centerPos the center of the spectators lookup
+		  * \param pos position of the creature
+		  * \param multifloor as in getSpectators
+		  */
+		static bool isInSpectatorRange(const Position& centerPos, const Position& pos, bool multifloor);
+
+		/**
+		  * Gets the players and the summons of players getSpectators would find around centerPos, nearest first
+		  * \param creatures receives the creatures found
+		  * \param centerPos the center of the lookup
+		  * \param multifloor as in getSpectators
+		  * \param maxCount keeps only the maxCount nearest ones
+		  */
+		void getNearestPlayerSide(CreatureVector& creatures, const Position& centerPos, bool multifloor = false,
+		                          size_t maxCount = std::numeric_limits<size_t>::max()) const;
+
                 void clearSpectatorCache();
                 void clearPlayersSpectatorCache();
 
@@ -271,6 +296,7 @@ class Map {
 	private:
 		SpectatorCache spectatorCache;
 		SpectatorCache playersSpectatorCache;
+		mutable SightCache sightCache;
 
 		QTreeNode root;
 
@@ -282,8 +308,15 @@ class Map {
 		uint32_t width = 0;
 		uint32_t height = 0;
 
+		// isSightClear without the cache
+		bool isSightLineClear(const Position& fromPos, const Position& toPos, bool sameFloor, bool pathfinding) const;
+
+		// Floors getSpectators looks at from centerPos
+		static std::pair<int32_t, int32_t> getSpectatorFloors(const Position& centerPos, bool multifloor);
+
 		// Actually scans the map for spectators
-		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
+		template <typename Spectators>
+		void getSpectatorsInternal(Spectators& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, CreatureVector QTreeLeafNode::* nodeList) const;
 
 		friend class Game;
 		friend class IOMap;
@@ -59,4 +59,22 @@ MatrixArea createArea(const std::vector<uint32_t> &vec, uint32_t rows) {
 		}
 	}
 	return area;
-}
\ No newline at end of file
+}
+AreaOffsets createAreaOffsets(const MatrixArea& area) {
+	AreaOffsets result;
+	auto &&[centerX, centerY] = area.getCenter();
+	for (uint32_t row = 0; row < area.getRows(); ++row) {
+		for (uint32_t col = 0; col < area.getCols(); ++col) {
+			if (!area(row, col)) {
+				continue;
+			}
+
+			const int32_t x = static_cast<int32_t>(col) - static_cast<int32_t>(centerX);
+			const int32_t y = static_cast<int32_t>(row) - static_cast<int32_t>(centerY);
+			result.offsets.emplace_back(x, y);
+			result.maxX = std::max(result.maxX, std::abs(x));
+			result.maxY = std::max(result.maxY, std::abs(y));
+		}
+	}
+	return result;
+}
@@ -36,4 +36,16 @@ class MatrixArea {
 
 MatrixArea createArea(const std::vector<uint32_t>& vec, uint32_t rows);
 
+/**
+ * Cells of an area as offsets from its center, row by row.
+ */
+struct AreaOffsets {
+	std::vector<std::pair<int16_t, int16_t>> offsets;
+	// largest distance of a cell from the center
+	int32_t maxX = 0;
+	int32_t maxY = 0;
+};
+
+AreaOffsets createAreaOffsets(const MatrixArea& area);
+
 #endif // FS_MATRIXAREA_H
\ No newline at end of file
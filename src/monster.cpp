@@ -132,11 +132,9 @@ void Monster::onCreatureAppear(Creature* creature, bool isLogin) {
 		lua_State* L = scriptInterface->getLuaState();
 		scriptInterface->pushFunction(mType->info.creatureAppearEvent);
 
-		lua::pushUserdata(L, this);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, this);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		if (scriptInterface->callFunction(2)) {
 			return;
@@ -175,11 +173,9 @@ void Monster::onRemoveCreature(Creature* creature, bool isLogout) {
 		lua_State* L = scriptInterface->getLuaState();
 		scriptInterface->pushFunction(mType->info.creatureDisappearEvent);
 
-		lua::pushUserdata(L, this);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, this);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		if (scriptInterface->callFunction(2)) {
 			return;
@@ -215,11 +211,9 @@ void Monster::onCreatureMove(Creature* creature, const Tile* newTile, const Posi
 		lua_State* L = scriptInterface->getLuaState();
 		scriptInterface->pushFunction(mType->info.creatureMoveEvent);
 
-		lua::pushUserdata(L, this);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, this);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		lua::pushPosition(L, oldPos);
 		lua::pushPosition(L, newPos);
@@ -296,11 +290,9 @@ void Monster::onCreatureSay(Creature* creature, SpeakClasses type, const std::st
 		lua_State* L = scriptInterface->getLuaState();
 		scriptInterface->pushFunction(mType->info.creatureSayEvent);
 
-		lua::pushUserdata(L, this);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, this);
 
-		lua::pushUserdata(L, creature);
-		lua::setCreatureMetatable(L, -1, creature);
+		lua::pushCreature(L, creature);
 
 		lua_pushnumber(L, type);
 		lua::pushString(L, text);
@@ -380,12 +372,34 @@ void Monster::updateTargetList() {
 		}
 	}
 
+	if (isSummon() && getMaster()->getPlayer()) {
+		SpectatorVec spectators;
+		g_game.map.getSpectators(spectators, position, true);
+		spectators.erase(this);
+		for (Creature* spectator : spectators) {
+			onCreatureFound(spectator);
+		}
+		return;
+	}
+
+	// friends are only looked for when a script asks for them, see getFriendList;
+	// opponents are only players and their summons, which the map keeps apart and hands out nearest first
+	CreatureVector opponents;
+	g_game.map.getNearestPlayerSide(opponents, position, true);
+	for (Creature* opponent : opponents) {
+		onCreatureFound(opponent);
+	}
+}
+
+const CreatureHashSet& Monster::getFriendList() {
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, position, true);
-	spectators.erase(this);
 	for (Creature* spectator : spectators) {
-		onCreatureFound(spectator);
+		if (spectator != this && isFriend(spectator) && canSee(spectator->getPosition())) {
+			addFriend(spectator);
+		}
 	}
+	return friendList;
 }
 
 void Monster::clearTargetList() {
@@ -711,7 +725,7 @@ void Monster::setIdle(bool idle) {
 		onIdleStatus();
 		clearTargetList();
 		clearFriendList();
-		Game::removeCreatureCheck(this);
+		g_game.removeCreatureCheck(this);
 	}
 }
 
@@ -756,8 +770,7 @@ void Monster::onThink(uint32_t interval) {
 		lua_State* L = scriptInterface->getLuaState();
 		scriptInterface->pushFunction(mType->info.thinkEvent);
 
-		lua::pushUserdata(L, this);
-		lua::setMetatable(L, -1, "Monster");
+		lua::pushCreature(L, this);
 
 		lua_pushnumber(L, interval);
 
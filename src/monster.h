@@ -156,9 +156,8 @@ class Monster final : public Creature {
 		const CreatureList& getTargetList() const {
 			return targetList;
 		}
-		const CreatureHashSet& getFriendList() const {
-			return friendList;
-		}
+		// wild monsters do not track the monsters around them, the list is filled on read
+		const CreatureHashSet& getFriendList();
 
 		bool isTarget(const Creature* creature) const;
 		bool isFleeing() const {
@@ -294,6 +293,9 @@ class Monster final : public Creature {
 		bool getIdleStatus() const {
 			return isIdle;
 		}
+		bool isSleeping() const override {
+			return isIdle;
+		}
 
 		void onAddCondition(ConditionType_t type) override;
 		void onEndCondition(ConditionType_t type) override;
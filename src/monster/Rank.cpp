@@ -2,7 +2,7 @@
 #include "monster/Rank.hpp"
 #include "monster/monster.h"
 #include "condition.h"
-#include "game.h"
+#include "game/game.h"
 
 #include <algorithm>
 #include <cmath>
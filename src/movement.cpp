@@ -60,6 +60,21 @@ void MoveEvents::clear(bool fromLua) {
 	reInitState(fromLua);
 }
 
+void MoveEvents::removeScriptEvents(ScriptEventSet& events) {
+	auto removeFrom = [&events](auto& map) {
+		for (auto& it : map) {
+			for (auto& moveEvents : it.second.moveEvent) {
+				moveEvents.remove_if([&events](const MoveEvent& moveEvent) { return events.claim(moveEvent); });
+			}
+		}
+	};
+
+	removeFrom(itemIdMap);
+	removeFrom(actionIdMap);
+	removeFrom(uniqueIdMap);
+	removeFrom(positionMap);
+}
+
 LuaScriptInterface& MoveEvents::getScriptInterface() {
 	return scriptInterface;
 }
@@ -887,8 +902,7 @@ bool MoveEvent::executeStep(Creature* creature, Item* item, const Position& pos)
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	lua::pushThing(L, item);
 	lua::pushPosition(L, pos);
 	lua::pushPosition(L, creature->getLastPosition());
@@ -922,8 +936,7 @@ bool MoveEvent::executeEquip(Player* player, Item* item, slots_t slot, bool isCh
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	lua::pushThing(L, item);
 	lua_pushnumber(L, slot);
 	lua::pushBoolean(L, isCheck);
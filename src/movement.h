@@ -52,6 +52,7 @@ class MoveEvents final : public BaseEvents {
 		bool registerLuaEvent(MoveEvent* event);
 		bool registerLuaFunction(MoveEvent* event);
 		void clear(bool fromLua) override final;
+		void removeScriptEvents(ScriptEventSet& events);
 
 		bool isValid(std::map<MoveEvent*, std::vector<uint32_t>> map, MoveEvent* event) {
 			return map.find(event) != map.end();
@@ -6,6 +6,7 @@
 #include "npc.h"
 
 #include "game/game.h"
+#include "luachunkcache.h"
 #include "pugicast.h"
 #include "spectators.h"
 
@@ -20,11 +21,19 @@ void Npcs::reload() {
 		it.second->closeAllShopWindows();
 	}
 
+	getScriptInterface()->clearScriptCache();
+
 	for (const auto& it : npcs) {
 		it.second->reload();
 	}
 }
 
+NpcScriptInterface* Npcs::getScriptInterface() {
+	// never destroyed, NPCs may still be released during static destruction
+	static NpcScriptInterface* scriptInterface = new NpcScriptInterface();
+	return scriptInterface;
+}
+
 Npc* Npc::createNpc(const std::string& name) {
 	std::unique_ptr<Npc> npc(new Npc(name));
 	if (!npc->load()) {
@@ -404,6 +413,18 @@ void Npc::setIdle(const bool idle) {
 
 	if (isIdle) {
 		onIdleStatus();
+
+		// the last think lets the script say goodbye to the players that just walked away,
+		// it is queued so the script does not run inside the notification that put us to sleep
+		g_dispatcher.addTask([id = getID()]() {
+			Npc* npc = g_game.getNpcByID(id);
+			if (npc && npc->isIdle && npc->npcEventHandler) {
+				npc->npcEventHandler->onThink();
+			}
+		});
+		g_game.removeCreatureCheck(this);
+	} else {
+		g_game.addCreatureCheck(this);
 	}
 }
 
@@ -533,11 +554,38 @@ bool NpcScriptInterface::initState() {
 }
 
 bool NpcScriptInterface::closeState() {
-	libLoaded = false;
+	clearScriptCache();
 	LuaScriptInterface::closeState();
 	return true;
 }
 
+int32_t NpcScriptInterface::loadNpcScript(const std::string& file, Npc* npc) {
+	auto it = scriptChunks.find(file);
+	if (it == scriptChunks.end()) {
+		if (g_luaChunkCache.load(L, file) != 0) {
+			std::string error = lua::popString(L);
+			std::cout << "[Warning - NpcScriptInterface::loadNpcScript] " << error << std::endl;
+			return -1;
+		}
+
+		it = scriptChunks.emplace(file, luaL_ref(L, LUA_REGISTRYINDEX)).first;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, it->second);
+	return runChunk(file, npc);
+}
+
+void NpcScriptInterface::clearScriptCache() {
+	if (L) {
+		for (const auto& it : scriptChunks) {
+			luaL_unref(L, LUA_REGISTRYINDEX, it.second);
+		}
+	}
+
+	scriptChunks.clear();
+	libLoaded = false;
+}
+
 bool NpcScriptInterface::loadNpcLib(const std::string& file) {
 	if (libLoaded) {
 		return true;
@@ -1042,14 +1090,14 @@ int NpcScriptInterface::luaNpcCloseShopWindow(lua_State* L) {
 	return 1;
 }
 
-NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) : scriptInterface(std::make_unique<NpcScriptInterface>()), npc(npc) {
+NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) : scriptInterface(Npcs::getScriptInterface()), npc(npc) {
 	if (!scriptInterface->loadNpcLib("data/npc/lib/npc.lua")) {
 		std::cout << "[Warning - NpcLib::NpcLib] Can not load lib: " << file << std::endl;
 		std::cout << scriptInterface->getLastLuaError() << std::endl;
 		return;
 	}
 
-	loaded = scriptInterface->loadFile("data/npc/scripts/" + file, npc) == 0;
+	loaded = scriptInterface->loadNpcScript("data/npc/scripts/" + file, npc) == 0;
 	if (!loaded) {
 		std::cout << "[Warning - NpcScript::NpcScript] Can not load script: " << file << std::endl;
 		std::cout << scriptInterface->getLastLuaError() << std::endl;
@@ -1064,6 +1112,13 @@ NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) : scriptIn
 	}
 }
 
+NpcEventsHandler::~NpcEventsHandler() {
+	for (int32_t eventId : {creatureAppearEvent, creatureDisappearEvent, creatureMoveEvent, creatureSayEvent,
+	                        playerCloseChannelEvent, playerEndTradeEvent, thinkEvent}) {
+		scriptInterface->releaseEvent(eventId);
+	}
+}
+
 bool NpcEventsHandler::isLoaded() const {
 	return loaded;
 }
@@ -1080,13 +1135,12 @@ void NpcEventsHandler::onCreatureAppear(Creature* creature) {
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(creatureAppearEvent, scriptInterface.get());
+	env->setScriptId(creatureAppearEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(creatureAppearEvent);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	scriptInterface->callFunction(1);
 }
 
@@ -1102,13 +1156,12 @@ void NpcEventsHandler::onCreatureDisappear(Creature* creature) {
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(creatureDisappearEvent, scriptInterface.get());
+	env->setScriptId(creatureDisappearEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(creatureDisappearEvent);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	scriptInterface->callFunction(1);
 }
 
@@ -1124,13 +1177,12 @@ void NpcEventsHandler::onCreatureMove(Creature* creature, const Position& oldPos
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(creatureMoveEvent, scriptInterface.get());
+	env->setScriptId(creatureMoveEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(creatureMoveEvent);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	lua::pushPosition(L, oldPos);
 	lua::pushPosition(L, newPos);
 	scriptInterface->callFunction(3);
@@ -1148,13 +1200,12 @@ void NpcEventsHandler::onCreatureSay(Creature* creature, SpeakClasses type, cons
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(creatureSayEvent, scriptInterface.get());
+	env->setScriptId(creatureSayEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(creatureSayEvent);
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 	lua_pushnumber(L, type);
 	lua::pushString(L, text);
 	scriptInterface->callFunction(3);
@@ -1173,13 +1224,12 @@ void NpcEventsHandler::onPlayerTrade(Player* player, int32_t callback, uint16_t
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(-1, scriptInterface.get());
+	env->setScriptId(-1, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	lua::pushCallback(L, callback);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	lua_pushnumber(L, itemId);
 	lua_pushnumber(L, count);
 	lua_pushnumber(L, amount);
@@ -1200,13 +1250,12 @@ void NpcEventsHandler::onPlayerCloseChannel(Player* player) {
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(playerCloseChannelEvent, scriptInterface.get());
+	env->setScriptId(playerCloseChannelEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(playerCloseChannelEvent);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	scriptInterface->callFunction(1);
 }
 
@@ -1222,13 +1271,12 @@ void NpcEventsHandler::onPlayerEndTrade(Player* player) {
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(playerEndTradeEvent, scriptInterface.get());
+	env->setScriptId(playerEndTradeEvent, scriptInterface);
 	env->setNpc(npc);
 
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(playerEndTradeEvent);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	scriptInterface->callFunction(1);
 }
 
@@ -1244,7 +1292,7 @@ void NpcEventsHandler::onThink() {
 	}
 
 	ScriptEnvironment* env = lua::getScriptEnv();
-	env->setScriptId(thinkEvent, scriptInterface.get());
+	env->setScriptId(thinkEvent, scriptInterface);
 	env->setNpc(npc);
 
 	scriptInterface->pushFunction(thinkEvent);
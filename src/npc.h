@@ -10,9 +10,17 @@
 class Npc;
 class Player;
 
+class NpcScriptInterface;
+
 class Npcs {
 	public:
 		static void reload();
+
+		/**
+		 * All NPCs share one script interface; every script file is compiled
+		 * once and executed per NPC, so each NPC keeps its own script locals.
+		 */
+		static NpcScriptInterface* getScriptInterface();
 };
 
 class NpcScriptInterface final : public LuaScriptInterface {
@@ -21,6 +29,15 @@ class NpcScriptInterface final : public LuaScriptInterface {
 
 		bool loadNpcLib(const std::string& file);
 
+		/**
+		 * Runs the compiled chunk of a NPC script for the given NPC, compiling
+		 * the file on first use.
+		 *
+		 * @return 0 on success, -1 otherwise
+		 */
+		int32_t loadNpcScript(const std::string& file, Npc* npc);
+		void clearScriptCache();
+
 	private:
 		void registerFunctions();
 
@@ -48,12 +65,18 @@ class NpcScriptInterface final : public LuaScriptInterface {
 		bool initState() override;
 		bool closeState() override;
 
+		std::unordered_map<std::string, int32_t> scriptChunks;
 		bool libLoaded;
 };
 
 class NpcEventsHandler {
 	public:
 		NpcEventsHandler(const std::string& file, Npc* npc);
+		~NpcEventsHandler();
+
+		// non-copyable
+		NpcEventsHandler(const NpcEventsHandler&) = delete;
+		NpcEventsHandler& operator=(const NpcEventsHandler&) = delete;
 
 		void onCreatureAppear(Creature* creature);
 		void onCreatureDisappear(Creature* creature);
@@ -65,7 +88,7 @@ class NpcEventsHandler {
 		void onThink();
 
 		bool isLoaded() const;
-		std::unique_ptr<NpcScriptInterface> scriptInterface;
+		NpcScriptInterface* scriptInterface;
 
 	private:
 		Npc* npc;
@@ -196,6 +219,9 @@ class Npc final : public Creature {
 		bool getNextStep(Direction& dir, uint32_t& flags) override;
 
 		void setIdle(const bool idle);
+		bool isSleeping() const override {
+			return isIdle;
+		}
 
 		bool canWalkTo(const Position& fromPos, Direction dir) const;
 		bool getRandomStep(Direction& direction) const;
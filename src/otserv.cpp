@@ -5,11 +5,15 @@
 
 #include "otserv.h"
 
+#include "ban.h"
 #include "configmanager.h"
 #include "databasemanager.h"
 #include "databasetasks.h"
 #include "game/game.h"
 #include "iomarket.h"
+#include "luachunkcache.h"
+#include "luagc.h"
+#include "luaprofiler.h"
 #include "monsters.h"
 #include "monster/Rank.hpp"
 #include "outfit.h"
@@ -21,6 +25,7 @@
 #include "script.h"
 #include "scriptmanager.h"
 #include "server.h"
+#include "statejournal.h"
 #include "utils/Logger.h"
 #include "utils/StartupProbe.h"
 #include "world/WorldPressureManager.hpp"
@@ -45,6 +50,7 @@
 DatabaseTasks g_databaseTasks;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
+StateJournal g_stateJournal;
 
 Game g_game;
 Monsters g_monsters;
@@ -622,6 +628,13 @@ namespace {
                 }
                 StartupProbe::mark("migrations");
 
+                logger.info("Replaying state journal");
+                if (!g_stateJournal.replay()) {
+                        startupErrorMessage("Failed to replay the state journal!");
+                        return;
+                }
+                StartupProbe::mark("journal");
+
                 //load vocations
                 logger.info("Loading vocations");
                 if (!g_vocations.loadFromXml()) {
@@ -658,6 +671,7 @@ namespace {
                         startupErrorMessage("Failed to load lua scripts");
                         return;
                 }
+                g_scripts->watchChangedScripts();
 
                 StartupProbe::mark("scripts_core");
 
@@ -681,6 +695,9 @@ namespace {
                         return;
                 }
 
+                g_luaChunkCache.logStats("scripts");
+                StartupProbe::mark("scripts_monsters");
+
                 logger.info("Loading outfits");
                 if (!Outfits::getInstance().loadFromXml()) {
                         startupErrorMessage("Unable to load outfits!");
@@ -737,9 +754,12 @@ namespace {
 
 		g_game.map.houses.payHouses(rentPeriod);
 
+		IOBan::loadBans();
+		IOMarket::getInstance().loadOffers();
 		IOMarket::checkExpiredOffers();
 		IOMarket::getInstance().updateStatistics();
 
+                g_luaChunkCache.logStats("npcs");
                 StartupProbe::mark("ready");
                 logger.info("Loaded all modules, server starting up...");
 
@@ -749,6 +769,11 @@ namespace {
                 }
         #endif
 
+                if (ConfigManager::getBoolean(ConfigManager::LUA_PROFILER)) {
+                        g_luaProfiler.start(ConfigManager::getNumber(ConfigManager::LUA_PROFILER_SAMPLE_INTERVAL));
+                }
+
+                g_stateJournal.start();
                 g_game.start(services);
                 g_game.setGameState(GAME_STATE_NORMAL);
                 StartupProbe::mark(nullptr);
@@ -770,6 +795,7 @@ bool startServer() {
 
         ServiceManager serviceManager;
 
+	g_dispatcher.setIdleHandler([]() { return g_luaGcGovernor.idleStep(); });
 	g_dispatcher.start();
 	g_scheduler.start();
 
@@ -784,11 +810,13 @@ bool startServer() {
         } else {
                 Logger::instance().error("No services running. The server is NOT online.");
                 g_scheduler.shutdown();
+                g_stateJournal.shutdown();
                 g_databaseTasks.shutdown();
                 g_dispatcher.shutdown();
         }
 
         g_scheduler.join();
+        g_stateJournal.join();
         g_databaseTasks.join();
         g_dispatcher.join();
 
@@ -21,6 +21,7 @@
 #include "party.h"
 #include "scheduler.h"
 #include "spectators.h"
+#include "statejournal.h"
 #include "storeinbox.h"
 #include "weapons.h"
 
@@ -629,6 +630,15 @@ void Player::setStorageValue(uint32_t key, std::optional<int32_t> value, bool is
 	}
 
 	Creature::setStorageValue(key, value, isSpawn);
+
+	if (!isSpawn) {
+		g_stateJournal.playerStorage(getGUID(), key, value);
+	}
+}
+
+void Player::setBankBalance(uint64_t balance) {
+	bankBalance = balance;
+	g_stateJournal.playerBalance(getGUID(), balance);
 }
 
 bool Player::canSee(const Position& pos) const {
@@ -732,6 +742,7 @@ bool Player::isNearDepotBox() const {
 Inbox_ptr Player::getInbox() {
 	if (!inbox) {
 		inbox = std::make_shared<Inbox>(ITEM_INBOX);
+		inbox->setOwnerId(getGUID());
 	}
 
 	return inbox;
@@ -749,6 +760,7 @@ DepotChest_ptr Player::getDepotChest(uint32_t depotId, bool autoCreate) {
 
 	const DepotChest_ptr& depotChest = depotChests.emplace(depotId, std::make_shared<DepotChest>(ITEM_DEPOT)).first->second;
 	depotChest->setMaxDepotItems(getMaxDepotItems());
+	depotChest->setOwnerId(getGUID());
 	return depotChest;
 }
 
@@ -1971,35 +1983,27 @@ void Player::death(Creature* lastHitCreature) {
 			mana = manaMax;
 		}
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		conditions.walk([this](Condition* condition) {
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.remove(condition);
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
-			} else {
-				++it;
 			}
-		}
+		});
 	} else {
 		setSkillLoss(true);
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		conditions.walk([this](Condition* condition) {
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.remove(condition);
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
-			} else {
-				++it;
 			}
-		}
+		});
 
 		health = healthMax;
 		g_game.internalTeleport(this, getTemplePosition(), true);
@@ -2872,6 +2876,10 @@ void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_
 		events::player::onInventoryUpdate(this, thing->getItem(), static_cast<slots_t>(index), true);
 	}
 
+	if (link != LINK_NEAR && thing->getItem()) {
+		g_stateJournal.playerItemsChanged(getGUID());
+	}
+
 	bool requireListUpdate = false;
 
 	if (link == LINK_OWNER || link == LINK_TOPPARENT) {
@@ -2926,6 +2934,10 @@ void Player::postRemoveNotification(Thing* thing, const Cylinder* newParent, int
 		events::player::onInventoryUpdate(this, thing->getItem(), static_cast<slots_t>(index), false);
 	}
 
+	if (link != LINK_NEAR && thing->getItem()) {
+		g_stateJournal.playerItemsChanged(getGUID());
+	}
+
 	bool requireListUpdate = false;
 
 	if (link == LINK_OWNER || link == LINK_TOPPARENT) {
@@ -8,6 +8,7 @@
 #include "configmanager.h"
 #include "game/game.h"
 #include "outputmessage.h"
+#include "tickbudget.h"
 
 extern Game g_game;
 
@@ -112,6 +113,11 @@ void ProtocolStatus::sendStatusString() {
 	pugi::xml_node npcs = tsqp.append_child("npcs");
 	npcs.append_attribute("total") = std::to_string(g_game.getNpcsOnline()).c_str();
 
+	pugi::xml_node load = tsqp.append_child("load");
+	load.append_attribute("level") = TickBudget::getLoadLevelName(g_tickBudget.getLoadLevel());
+	load.append_attribute("lag") = std::to_string(g_tickBudget.getLag()).c_str();
+	load.append_attribute("degraded") = g_tickBudget.getDegradedSystemNames().c_str();
+
 	pugi::xml_node rates = tsqp.append_child("rates");
 	rates.append_attribute("experience") = std::to_string(getNumber(ConfigManager::RATE_EXPERIENCE)).c_str();
 	rates.append_attribute("skill") = std::to_string(getNumber(ConfigManager::RATE_SKILL)).c_str();
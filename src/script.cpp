@@ -5,12 +5,28 @@
 
 #include "script.h"
 
+#include "actions.h"
 #include "configmanager.h"
+#include "creatureevent.h"
+#include "globalevent.h"
+#include "luachunkcache.h"
+#include "movement.h"
+#include "scheduler.h"
+#include "spells.h"
+#include "talkaction.h"
 #include "utils/Logger.h"
+#include "weapons.h"
 
 #include <fmt/format.h>
 
 extern LuaEnvironment g_luaEnvironment;
+extern Actions* g_actions;
+extern CreatureEvents* g_creatureEvents;
+extern GlobalEvents* g_globalEvents;
+extern MoveEvents* g_moveEvents;
+extern Spells* g_spells;
+extern TalkActions* g_talkActions;
+extern Weapons* g_weapons;
 
 Scripts::Scripts() :
 	scriptInterface("Scripts Interface") {
@@ -21,7 +37,7 @@ Scripts::~Scripts() {
 	scriptInterface.reInitState();
 }
 
-bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
+bool Scripts::findScripts(const std::string& folderName, bool isLib, std::vector<std::filesystem::path>& v, bool logDisabled) const {
 	namespace fs = std::filesystem;
 
         const auto dir = fs::current_path() / "data" / folderName;
@@ -31,7 +47,6 @@ bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
         }
 
 	fs::recursive_directory_iterator endit;
-	std::vector<fs::path> v;
 	std::string disable = ("#");
 	for (fs::recursive_directory_iterator it(dir); it != endit; ++it) {
 		auto fn = it->path().parent_path().filename();
@@ -41,7 +56,7 @@ bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
 		if (fs::is_regular_file(*it) && it->path().extension() == ".lua") {
 			size_t found = it->path().filename().string().find(disable);
 			if (found != std::string::npos) {
-                                if (getBoolean(ConfigManager::SCRIPTS_CONSOLE_LOGS)) {
+                                if (logDisabled && getBoolean(ConfigManager::SCRIPTS_CONSOLE_LOGS)) {
                                         Logger::instance().info(fmt::format("{} [disabled]", it->path().filename().string()));
                                 }
                                 continue;
@@ -50,6 +65,27 @@ bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
 		}
 	}
 	sort(v.begin(), v.end());
+	return true;
+}
+
+bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
+	namespace fs = std::filesystem;
+
+	std::vector<fs::path> v;
+	if (!findScripts(folderName, isLib, v, true)) {
+		return false;
+	}
+
+	if (!isLib) {
+		// remember what was loaded for reloadChangedScripts
+		auto& files = loadedFiles[folderName];
+		files.clear();
+		for (const auto& path : v) {
+			std::error_code ec;
+			files[path.string()] = fs::last_write_time(path, ec);
+		}
+	}
+
 	std::string redir;
 	for (auto it = v.begin(); it != v.end(); ++it) {
 		const std::string scriptFile = it->string();
@@ -80,4 +116,116 @@ bool Scripts::loadScripts(std::string folderName, bool isLib, bool reload) {
         }
 
         return true;
-}
\ No newline at end of file
+}
+
+uint32_t Scripts::reloadChangedScripts(const std::string& folderName) {
+	namespace fs = std::filesystem;
+
+	auto it = loadedFiles.find(folderName);
+	if (it == loadedFiles.end()) {
+		return 0;
+	}
+
+	std::vector<fs::path> v;
+	if (!findScripts(folderName, false, v, false)) {
+		return 0;
+	}
+
+	auto& files = it->second;
+	std::set<std::string> present;
+	uint32_t reloaded = 0;
+	for (const auto& path : v) {
+		std::string scriptFile = path.string();
+		present.insert(scriptFile);
+
+		std::error_code ec;
+		auto mtime = fs::last_write_time(path, ec);
+		auto file = files.find(scriptFile);
+		if (file != files.end() && file->second == mtime) {
+			continue;
+		}
+
+		// remembered even on failure, the file is retried once it changes again
+		files[scriptFile] = mtime;
+		if (reloadScript(scriptFile)) {
+			++reloaded;
+		}
+	}
+
+	for (auto file = files.begin(); file != files.end();) {
+		if (present.find(file->first) != present.end()) {
+			++file;
+			continue;
+		}
+
+		removeScriptEvents(file->first);
+		Logger::instance().info(fmt::format("{} [unloaded]", fs::path(file->first).filename().string()));
+		file = files.erase(file);
+		++reloaded;
+	}
+	return reloaded;
+}
+
+bool Scripts::reloadScript(const std::string& scriptFile) {
+	// compile first, a file with syntax errors keeps its current events
+	lua_State* L = scriptInterface.getLuaState();
+	if (g_luaChunkCache.load(L, scriptFile) != 0) {
+		Logger::instance().error(fmt::format("Lua error while reloading {}: {}", scriptFile, lua::popString(L)));
+		return false;
+	}
+
+	removeScriptEvents(scriptFile);
+
+	if (scriptInterface.runChunk(scriptFile) == -1) {
+		Logger::instance().error(fmt::format("Lua error while reloading {}: {}", scriptFile, scriptInterface.getLastLuaError()));
+		return false;
+	}
+
+	Logger::instance().info(fmt::format("{} [reloaded]", std::filesystem::path(scriptFile).filename().string()));
+	return true;
+}
+
+void Scripts::removeScriptEvents(const std::string& scriptFile) {
+	ScriptEventSet events(&scriptInterface, scriptInterface.getEventIdsByFile(scriptFile));
+	g_actions->removeScriptEvents(events);
+	g_creatureEvents->removeScriptEvents(events);
+	g_globalEvents->removeScriptEvents(events);
+	g_moveEvents->removeScriptEvents(events);
+	g_spells->removeScriptEvents(events);
+	g_talkActions->removeScriptEvents(events);
+	g_weapons->removeScriptEvents(events);
+
+	// event callbacks are kept on the Lua side, data/scripts/lib/event_callbacks.lua
+	lua_State* L = scriptInterface.getLuaState();
+	lua_getglobal(L, "Event");
+	if (lua_istable(L, -1)) {
+		lua_getfield(L, -1, "unregisterFile");
+		if (lua_isfunction(L, -1)) {
+			lua_pushvalue(L, -2);
+			lua::pushString(L, scriptFile);
+			if (lua_pcall(L, 2, 0, 0) != 0) {
+				Logger::instance().error(fmt::format("Lua error while unregistering the callbacks of {}: {}", scriptFile, lua::popString(L)));
+			}
+		} else {
+			lua_pop(L, 1);
+		}
+	}
+	lua_pop(L, 1);
+
+	// pending addEvent callbacks hold their own references and keep working
+	for (int32_t eventId : events.getRemovedIds()) {
+		scriptInterface.releaseEvent(eventId);
+	}
+}
+
+void Scripts::watchChangedScripts() {
+	int32_t interval = getNumber(ConfigManager::SCRIPTS_HOT_RELOAD_INTERVAL);
+	if (interval <= 0) {
+		return;
+	}
+
+	g_scheduler.addEvent(createSchedulerTask(interval * 1000, [this]() {
+		reloadChangedScripts("scripts");
+		watchChangedScripts();
+	}));
+}
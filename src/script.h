@@ -12,11 +12,34 @@ class Scripts {
 		~Scripts();
 
 		bool loadScripts(std::string folderName, bool isLib, bool reload);
+
+		/**
+		 * Reloads only the files of a folder that changed since they were
+		 * loaded. The events a file registered are taken out of the registries
+		 * and the file is run again; files that fail to compile keep their
+		 * current events and removed files are unloaded.
+		 *
+		 * @return the number of files reloaded or unloaded
+		 */
+		uint32_t reloadChangedScripts(const std::string& folderName);
+
+		/**
+		 * Polls data/scripts for changes every scriptsHotReloadInterval seconds.
+		 */
+		void watchChangedScripts();
+
 		LuaScriptInterface& getScriptInterface() {
 			return scriptInterface;
 		}
 	private:
+		bool findScripts(const std::string& folderName, bool isLib, std::vector<std::filesystem::path>& v, bool logDisabled) const;
+		bool reloadScript(const std::string& scriptFile);
+		void removeScriptEvents(const std::string& scriptFile);
+
 		LuaScriptInterface scriptInterface;
+
+		// modification time of every file loaded per folder
+		std::map<std::string, std::map<std::string, std::filesystem::file_time_type>> loadedFiles;
 };
 
 #endif // FS_SCRIPT_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "scripting/LuaUserdataCache.h"
+
+void LuaUserdataCache::attach(lua_State* L) {
+	this->L = L;
+	objects.clear();
+	if (!L) {
+		cacheRef = LUA_NOREF;
+		return;
+	}
+
+	lua_newtable(L);
+	lua_createtable(L, 0, 1);
+	lua_pushliteral(L, "v");
+	lua_setfield(L, -2, "__mode");
+	lua_setmetatable(L, -2);
+	cacheRef = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+void LuaUserdataCache::push(lua_State* L, void* object, const char* metatable) {
+	lua_rawgeti(L, LUA_REGISTRYINDEX, cacheRef);
+	lua_pushlightuserdata(L, object);
+	lua_rawget(L, -2);
+	if (lua_isuserdata(L, -1) && lua_getmetatable(L, -1)) {
+		luaL_getmetatable(L, metatable);
+		bool sameType = lua_rawequal(L, -1, -2) != 0;
+		lua_pop(L, 2);
+		if (sameType) {
+			lua_remove(L, -2);
+			return;
+		}
+	}
+	lua_pop(L, 1);
+
+	void** userdata = static_cast<void**>(lua_newuserdata(L, sizeof(void*)));
+	*userdata = object;
+	luaL_getmetatable(L, metatable);
+	lua_setmetatable(L, -2);
+
+	lua_pushlightuserdata(L, object);
+	lua_pushvalue(L, -2);
+	lua_rawset(L, -4);
+	lua_remove(L, -2);
+
+	objects.insert(object);
+}
+
+void LuaUserdataCache::release(const void* object) {
+	if (!L || objects.erase(object) == 0) {
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, cacheRef);
+	lua_pushlightuserdata(L, const_cast<void*>(object));
+	lua_rawget(L, -2);
+	if (lua_isuserdata(L, -1)) {
+		*static_cast<void**>(lua_touserdata(L, -1)) = nullptr;
+
+		lua_pushlightuserdata(L, const_cast<void*>(object));
+		lua_pushnil(L);
+		lua_rawset(L, -4);
+	}
+	lua_pop(L, 2);
+}
@@ -0,0 +1,53 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAUSERDATACACHE_H
+#define FS_LUAUSERDATACACHE_H
+
+#include <lua.hpp>
+
+/**
+ * Keeps one userdata per game object pushed to Lua.
+ *
+ * Creatures and items are pushed thousands of times per second. Instead of
+ * allocating a new userdata on every push, a weak-valued registry table maps
+ * the object address to its userdata, so repeated pushes of a live object
+ * return the same userdata. The cache also remembers which objects it handed
+ * out, so releasing an object that was never pushed does not touch Lua.
+ */
+class LuaUserdataCache {
+	public:
+		LuaUserdataCache() = default;
+
+		// non-copyable
+		LuaUserdataCache(const LuaUserdataCache&) = delete;
+		LuaUserdataCache& operator=(const LuaUserdataCache&) = delete;
+
+		/**
+		 * Creates the cache table in a new state, nullptr detaches before the
+		 * state is closed.
+		 */
+		void attach(lua_State* L);
+
+		/**
+		 * Pushes the userdata for object, creating it with the given metatable
+		 * if the object has no cached userdata yet or it was cached with
+		 * another metatable.
+		 */
+		void push(lua_State* L, void* object, const char* metatable);
+
+		/**
+		 * Drops the cached userdata of a released object and clears the
+		 * pointer it holds, so scripts still referencing it see a nil object.
+		 */
+		void release(const void* object);
+
+	private:
+		lua_State* L = nullptr;
+		int cacheRef = LUA_NOREF;
+
+		// objects a userdata was created for, it may since have been collected
+		std::unordered_set<const void*> objects;
+};
+
+#endif // FS_LUAUSERDATACACHE_H
@@ -0,0 +1,117 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SIGHTCACHE_H
+#define FS_SIGHTCACHE_H
+
+#include "position.h"
+
+/**
+ * Results of Map::isSightClear remembered for one dispatcher cycle.
+ *
+ * Monsters looking for targets, spells and thrown items ask for the same
+ * lines over and over within a cycle. The results live in a small open
+ * addressing table keyed by both positions packed into one integer. An entry
+ * is only valid while its stamp matches the current one, so starting a new
+ * cycle or dropping every result is a single increment.
+ *
+ * Tiles call invalidateAll whenever they start or stop blocking projectiles
+ * or gain or lose their ground, which drops the results of every map.
+ */
+class SightCache {
+	public:
+		static constexpr size_t SLOTS = 4096;
+		static constexpr size_t MAX_PROBES = 8;
+		// lines longer than this on either axis are not remembered
+		static constexpr int32_t MAX_DELTA = 127;
+
+		static void invalidateAll() {
+			++generation;
+		}
+
+		/**
+		 * @return false if the line is too long to be remembered
+		 */
+		static bool makeKey(const Position& fromPos, const Position& toPos, bool sameFloor, uint64_t& key) {
+			const int32_t dx = toPos.x - fromPos.x;
+			const int32_t dy = toPos.y - fromPos.y;
+			if (std::abs(dx) > MAX_DELTA || std::abs(dy) > MAX_DELTA) {
+				return false;
+			}
+
+			key = static_cast<uint64_t>(fromPos.x)
+				| (static_cast<uint64_t>(fromPos.y) << 16)
+				| (static_cast<uint64_t>(fromPos.z & 0x0F) << 32)
+				| (static_cast<uint64_t>(toPos.z & 0x0F) << 36)
+				| (static_cast<uint64_t>(dx + MAX_DELTA + 1) << 40)
+				| (static_cast<uint64_t>(dy + MAX_DELTA + 1) << 48)
+				| (static_cast<uint64_t>(sameFloor) << 56);
+			return true;
+		}
+
+		/**
+		 * @return false if there is no result for the key in this cycle
+		 */
+		bool find(uint64_t key, uint64_t cycle, bool& sightClear) {
+			refresh(cycle);
+
+			size_t index = hash(key);
+			for (size_t probe = 0; probe < MAX_PROBES; ++probe, index = (index + 1) % SLOTS) {
+				const Entry& entry = entries[index];
+				if (entry.stamp != stamp) {
+					return false;
+				}
+
+				if (entry.key == key) {
+					sightClear = entry.sightClear;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// must follow a find for the same key in the same cycle
+		void insert(uint64_t key, bool sightClear) {
+			// the first free slot of the probes, or the last one probed if there is none
+			size_t index = hash(key);
+			for (size_t probe = 1; probe < MAX_PROBES && entries[index].stamp == stamp; ++probe) {
+				index = (index + 1) % SLOTS;
+			}
+			entries[index] = {key, stamp, sightClear};
+		}
+
+	private:
+		struct Entry {
+			uint64_t key = 0;
+			uint32_t stamp = 0;
+			bool sightClear = false;
+		};
+
+		static size_t hash(uint64_t key) {
+			return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 52) % SLOTS;
+		}
+
+		void refresh(uint64_t cycle) {
+			if (cycle == this->cycle && seenGeneration == generation) {
+				return;
+			}
+
+			this->cycle = cycle;
+			seenGeneration = generation;
+			if (++stamp == 0) {
+				// the stamps wrapped around, forget the entries of the last round
+				entries.fill({});
+				stamp = 1;
+			}
+		}
+
+		std::array<Entry, SLOTS> entries{};
+		uint64_t cycle = 0;
+		uint32_t seenGeneration = 0;
+		// entries start with stamp 0, which is never current
+		uint32_t stamp = 1;
+
+		static inline uint32_t generation = 0;
+};
+
+#endif // FS_SIGHTCACHE_H
@@ -11,6 +11,7 @@
 #include "events.h"
 #include "game/game.h"
 #include "globalevent.h"
+#include "luagc.h"
 #include "monsters.h"
 #include "mounts.h"
 #include "movement.h"
@@ -18,6 +19,7 @@
 #include "quests.h"
 #include "scheduler.h"
 #include "spells.h"
+#include "statejournal.h"
 #include "talkaction.h"
 #include "tasks.h"
 #include "weapons.h"
@@ -103,7 +105,7 @@ namespace {
 		g_luaEnvironment.loadFile("data/global.lua");
 		std::cout << "Reloaded global.lua." << std::endl;
 
-		lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+		g_luaGcGovernor.fullCollect();
 	}
 	#else
 	void sigbreakHandler() {
@@ -148,6 +150,7 @@ namespace {
 				g_dispatcher.addTask(sigbreakHandler);
 				// hold the thread until other threads end
 				g_scheduler.join();
+				g_stateJournal.join();
 				g_databaseTasks.join();
 				g_dispatcher.join();
 				break;
@@ -12,7 +12,7 @@
 #include "npc.h"
 #include "pugicast.h"
 #include "scheduler.h"
-#include "spectators.h"
+#include "tickbudget.h"
 
 extern Monsters g_monsters;
 extern Game g_game;
@@ -55,7 +55,7 @@ bool Spawns::loadFromXml(const std::string& filename, bool isCalledByLua) {
 			continue;
 		}
 
-		spawnList.emplace_front(centerPos, radius);
+		spawnList.emplace_front(*this, centerPos, radius);
 		Spawn& spawn = spawnList.front();
 
 		for (auto childNode : spawnNode.children()) {
@@ -212,9 +212,15 @@ void Spawns::startup() {
 }
 
 void Spawns::clear() {
+	if (checkSpawnsEvent != 0) {
+		g_scheduler.stopEvent(checkSpawnsEvent);
+		checkSpawnsEvent = 0;
+	}
+
 	for (Spawn& spawn : spawnList) {
-		spawn.stopEvent();
+		spawnWheel.unschedule(&spawn);
 	}
+	dueSpawns.clear();
 	spawnList.clear();
 
 	loaded = false;
@@ -231,9 +237,92 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 			(pos.getY() >= centerPos.getY() - radius) && (pos.getY() <= centerPos.getY() + radius));
 }
 
+void Spawns::scheduleCheck(Spawn* spawn) {
+	spawnWheel.schedule(spawn, OTSYS_TIME() + spawn->getInterval());
+
+	if (checkSpawnsEvent == 0) {
+		checkSpawnsEvent = g_scheduler.addEvent(createSchedulerTask(CHECK_INTERVAL, [this]() { checkSpawns(); }));
+	}
+}
+
+void Spawns::checkSpawns() {
+	checkSpawnsEvent = 0;
+
+	spawnWheel.advance(OTSYS_TIME(), [this](Spawn* spawn) {
+		spawn->due = true;
+		dueSpawns.push_back(spawn);
+	});
+
+	if (!dueSpawns.empty()) {
+		updatePlayerCells();
+
+		// after a server save every spawn comes due at once, the rest waits for the next ticks
+		int32_t budget = g_tickBudget.scaleSpawnBudget(getNumber(ConfigManager::MAX_SPAWNS_PER_TICK));
+		if (budget <= 0) {
+			budget = std::numeric_limits<int32_t>::max();
+		}
+
+		while (!dueSpawns.empty()) {
+			Spawn* spawn = dueSpawns.front();
+			if (!spawn->checkSpawn(budget)) {
+				break;
+			}
+
+			spawn->due = false;
+			dueSpawns.pop_front();
+			if (spawn->spawnedMap.size() < spawn->spawnMap.size()) {
+				scheduleCheck(spawn);
+			}
+		}
+	}
+
+	if (checkSpawnsEvent == 0 && (!dueSpawns.empty() || spawnWheel.size() != 0)) {
+		checkSpawnsEvent = g_scheduler.addEvent(createSchedulerTask(CHECK_INTERVAL, [this]() { checkSpawns(); }));
+	}
+}
+
+void Spawns::updatePlayerCells() {
+	// only the cells players stand in now, the map would keep every cell ever visited
+	playerCells.clear();
+
+	for (const auto& it : g_game.getPlayers()) {
+		const Player* player = it.second;
+		if (player->isRemoved() || player->hasFlag(PlayerFlag_IgnoredByMonsters)) {
+			continue;
+		}
+
+		const Position& pos = player->getPosition();
+		playerCells[(pos.z << 24) | ((pos.x >> 4) << 12) | (pos.y >> 4)].push_back(pos);
+	}
+}
+
+bool Spawns::findPlayer(const Position& pos) const {
+	// the range of Map::getSpectators on a single floor
+	const int32_t minX = std::max<int32_t>(0, pos.x - Map::maxViewportX);
+	const int32_t maxX = std::min<int32_t>(0xFFFF, pos.x + Map::maxViewportX);
+	const int32_t minY = std::max<int32_t>(0, pos.y - Map::maxViewportY);
+	const int32_t maxY = std::min<int32_t>(0xFFFF, pos.y + Map::maxViewportY);
+
+	for (int32_t cellY = minY >> 4; cellY <= (maxY >> 4); ++cellY) {
+		for (int32_t cellX = minX >> 4; cellX <= (maxX >> 4); ++cellX) {
+			auto it = playerCells.find((pos.z << 24) | (cellX << 12) | cellY);
+			if (it == playerCells.end()) {
+				continue;
+			}
+
+			for (const Position& playerPos : it->second) {
+				if (playerPos.x >= minX && playerPos.x <= maxX && playerPos.y >= minY && playerPos.y <= maxY) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
 void Spawn::startSpawnCheck() {
-	if (checkSpawnEvent == 0) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
+	if (!due && !timerHandle.isScheduled()) {
+		spawns.scheduleCheck(this);
 	}
 }
 
@@ -245,21 +334,8 @@ Spawn::~Spawn() {
 	}
 }
 
-bool Spawn::findPlayer(const Position& pos) {
-	SpectatorVec spectators;
-	g_game.map.getSpectators(spectators, pos, false, true);
-	for (Creature* spectator : spectators) {
-		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		Player* spectatorPlayer = static_cast<Player*>(spectator);
-		if (!spectatorPlayer->hasFlag(PlayerFlag_IgnoredByMonsters)) {
-			return true;
-		}
-	}
-	return false;
-}
-
 bool Spawn::spawnMonster(uint32_t spawnId, spawnBlock_t sb, bool startup/* = false*/) {
-	bool isBlocked = !startup && findPlayer(sb.pos);
+	bool isBlocked = !startup && spawns.findPlayer(sb.pos);
 	size_t monstersCount = sb.mTypes.size(), blockedMonsters = 0;
 
 	const auto spawnFunc = [&](bool roll) {
@@ -332,9 +408,7 @@ void Spawn::startup() {
 	}
 }
 
-void Spawn::checkSpawn() {
-	checkSpawnEvent = 0;
-
+bool Spawn::checkSpawn(int32_t& budget) {
 	cleanup();
 
 	uint32_t spawnCount = 0;
@@ -347,6 +421,11 @@ void Spawn::checkSpawn() {
 
 		spawnBlock_t& sb = it.second;
 		if (OTSYS_TIME() >= sb.lastSpawn + sb.interval) {
+			if (budget == 0) {
+				return false;
+			}
+
+			--budget;
 			if (!spawnMonster(spawnId, sb)) {
 				sb.lastSpawn = OTSYS_TIME();
 				continue;
@@ -358,9 +437,7 @@ void Spawn::checkSpawn() {
 		}
 	}
 
-	if (spawnedMap.size() < spawnMap.size()) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
-	}
+	return true;
 }
 
 void Spawn::cleanup() {
@@ -409,10 +486,3 @@ void Spawn::removeMonster(Monster* monster) {
 		}
 	}
 }
-
-void Spawn::stopEvent() {
-	if (checkSpawnEvent != 0) {
-		g_scheduler.stopEvent(checkSpawnEvent);
-		checkSpawnEvent = 0;
-	}
-}
\ No newline at end of file
@@ -5,10 +5,13 @@
 #define FS_SPAWN_H
 
 #include "position.h"
+#include "timingwheel.h"
+#include "tools.h"
 
 class Monster;
 class MonsterType;
 class Npc;
+class Spawns;
 
 struct spawnBlock_t {
 	Position pos;
@@ -20,7 +23,7 @@ struct spawnBlock_t {
 
 class Spawn {
 	public:
-		Spawn(Position pos, int32_t radius) : centerPos(std::move(pos)), radius(radius) {}
+		Spawn(Spawns& spawns, Position pos, int32_t radius) : spawns(spawns), centerPos(std::move(pos)), radius(radius) {}
 		~Spawn();
 
 		// non-copyable
@@ -37,11 +40,14 @@ class Spawn {
 		void startup();
 
 		void startSpawnCheck();
-		void stopEvent();
 
 		bool isInSpawnZone(const Position& pos);
 		void cleanup();
 
+		TimerHandle& getTimerHandle() {
+			return timerHandle;
+		}
+
 	private:
 		//map of the spawned creatures
 		using SpawnedMap = std::multimap<uint32_t, Monster*>;
@@ -50,16 +56,21 @@ class Spawn {
 		//map of creatures in the spawn
 		std::map<uint32_t, spawnBlock_t> spawnMap;
 
+		Spawns& spawns;
 		Position centerPos;
 		int32_t radius;
 
 		uint32_t interval = 60000;
-		uint32_t checkSpawnEvent = 0;
+		TimerHandle timerHandle;
+		// waiting in Spawns::dueSpawns for a tick with budget left
+		bool due = false;
 
-		static bool findPlayer(const Position& pos);
 		bool spawnMonster(uint32_t spawnId, spawnBlock_t sb, bool startup = false);
 		bool spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& pos, Direction dir, bool startup = false);
-		void checkSpawn();
+		// returns false if the budget ran out before every due block was tried
+		bool checkSpawn(int32_t& budget);
+
+		friend class Spawns;
 };
 
 class Spawns {
@@ -74,12 +85,35 @@ class Spawns {
 			return started;
 		}
 
+		static constexpr int64_t CHECK_INTERVAL = 1000;
+
+		// respawns in the due spawns as far as the budget of the tick goes, every CHECK_INTERVAL while any spawn waits
+		void checkSpawns();
+
 	private:
+		// schedules the next check of the spawn one interval from now
+		void scheduleCheck(Spawn* spawn);
+
+		// whether a player the monsters do not ignore would see a monster spawning at pos
+		bool findPlayer(const Position& pos) const;
+		void updatePlayerCells();
+
 		std::forward_list<Npc*> npcList;
 		std::forward_list<Spawn> spawnList;
 		std::string filename;
+
+		// the next check of every spawn missing monsters, in one scheduler event for all of them
+		TimingWheel<Spawn> spawnWheel{CHECK_INTERVAL, OTSYS_TIME()};
+		std::deque<Spawn*> dueSpawns;
+		uint32_t checkSpawnsEvent = 0;
+
+		// positions of the players blocking spawns, by floor and 16x16 cell
+		std::unordered_map<uint32_t, std::vector<Position>> playerCells;
+
 		bool loaded = false;
 		bool started = false;
+
+		friend class Spawn;
 };
 
 #endif // FS_SPAWN_H
\ No newline at end of file
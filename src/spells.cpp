@@ -26,28 +26,30 @@ Spells::~Spells() {
 	clear(false);
 }
 
-TalkActionResult_t Spells::playerSaySpell(Player* player, std::string& words) {
-	std::string str_words = words;
-
-	//strip trailing spaces
-	boost::algorithm::trim(str_words);
+TalkActionResult_t Spells::playerSaySpell(Player* player, std::string_view text, std::string& words) {
+	//strip surrounding spaces
+	auto isSpace = [](char ch) { return isspace(static_cast<unsigned char>(ch)) != 0; };
+	while (!text.empty() && isSpace(text.front())) {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && isSpace(text.back())) {
+		text.remove_suffix(1);
+	}
 
-	InstantSpell* instantSpell = getInstantSpell(str_words);
+	InstantSpell* instantSpell = getInstantSpell(text);
 	if (!instantSpell) {
 		return TALKACTION_CONTINUE;
 	}
 
-	std::string param;
+	std::string_view param;
 
 	if (instantSpell->getHasParam()) {
-		size_t spellLen = instantSpell->getWords().length();
-		size_t paramLen = str_words.length() - spellLen;
-		std::string paramText = str_words.substr(spellLen, paramLen);
+		std::string_view paramText = text.substr(instantSpell->getWords().length());
 		if (!paramText.empty() && paramText.front() == ' ') {
 			size_t loc1 = paramText.find('"', 1);
-			if (loc1 != std::string::npos) {
+			if (loc1 != std::string_view::npos) {
 				size_t loc2 = paramText.find('"', loc1 + 1);
-				if (loc2 == std::string::npos) {
+				if (loc2 == std::string_view::npos) {
 					loc2 = paramText.length();
 				} else if (paramText.find_last_not_of(' ') != loc2) {
 					return TALKACTION_CONTINUE;
@@ -55,9 +57,11 @@ TalkActionResult_t Spells::playerSaySpell(Player* player, std::string& words) {
 
 				param = paramText.substr(loc1 + 1, loc2 - loc1 - 1);
 			} else {
-				boost::algorithm::trim(paramText);
-				loc1 = paramText.find(' ', 0);
-				if (loc1 == std::string::npos) {
+				while (!paramText.empty() && isSpace(paramText.front())) {
+					paramText.remove_prefix(1);
+				}
+
+				if (paramText.find(' ') == std::string_view::npos) {
 					param = paramText;
 				} else {
 					return TALKACTION_CONTINUE;
@@ -66,11 +70,13 @@ TalkActionResult_t Spells::playerSaySpell(Player* player, std::string& words) {
 		}
 	}
 
-	if (instantSpell->playerCastInstant(player, param)) {
+	// the spell may replace a partial player name with the full one
+	std::string castParam{param};
+	if (instantSpell->playerCastInstant(player, castParam)) {
 		words = instantSpell->getWords();
 
-		if (instantSpell->getHasParam() && !param.empty()) {
-			words += " \"" + param + "\"";
+		if (instantSpell->getHasParam() && !castParam.empty()) {
+			words += " \"" + castParam + "\"";
 		}
 
 		return TALKACTION_BREAK;
@@ -95,6 +101,34 @@ void Spells::clearMaps(bool fromLua) {
 			++rune;
 		}
 	}
+	rebuildInstantWords();
+}
+
+void Spells::removeScriptEvents(ScriptEventSet& events) {
+	for (auto it = instants.begin(); it != instants.end();) {
+		if (events.claim(it->second)) {
+			it = instants.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for (auto it = runes.begin(); it != runes.end();) {
+		if (events.claim(it->second)) {
+			it = runes.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	rebuildInstantWords();
+}
+
+void Spells::rebuildInstantWords() {
+	instantWords.clear();
+	for (auto& it : instants) {
+		instantWords.insert(it.first, &it.second);
+	}
 }
 
 void Spells::clear(bool fromLua) {
@@ -120,7 +154,9 @@ bool Spells::registerEvent(Event_ptr event, const pugi::xml_node&) {
 	InstantSpell* instant = dynamic_cast<InstantSpell*>(event.get());
 	if (instant) {
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
-		if (!result.second) {
+		if (result.second) {
+			instantWords.insert(result.first->first, &result.first->second);
+		} else {
 			std::cout << "[Warning - Spells::registerEvent] Duplicate registered instant spell with words: " << instant->getWords() << std::endl;
 		}
 		return result.second;
@@ -143,7 +179,9 @@ bool Spells::registerInstantLuaEvent(InstantSpell* event) {
 	if (instant) {
 		std::string words = instant->getWords();
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
-		if (!result.second) {
+		if (result.second) {
+			instantWords.insert(result.first->first, &result.first->second);
+		} else {
 			std::cout << "[Warning - Spells::registerInstantLuaEvent] Duplicate registered instant spell with words: " << words << std::endl;
 		}
 		return result.second;
@@ -196,38 +234,23 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name) {
 	return nullptr;
 }
 
-InstantSpell* Spells::getInstantSpell(const std::string& words) {
-	InstantSpell* result = nullptr;
-
-	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
-			if (!result || spellLen > result->getWords().size()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
-		}
+InstantSpell* Spells::getInstantSpell(std::string_view words) {
+	auto [result, spellLen] = instantWords.findLongest(words);
+	if (!result) {
+		return nullptr;
 	}
 
-	if (result) {
-		const std::string& resultWords = result->getWords();
-		if (words.length() > resultWords.length()) {
-			if (!result->getHasParam()) {
-				return nullptr;
-			}
+	if (words.length() > spellLen) {
+		if (!result->getHasParam()) {
+			return nullptr;
+		}
 
-			size_t spellLen = resultWords.length();
-			size_t paramLen = words.length() - spellLen;
-			if (paramLen < 2 || words[spellLen] != ' ') {
-				return nullptr;
-			}
+		size_t paramLen = words.length() - spellLen;
+		if (paramLen < 2 || words[spellLen] != ' ') {
+			return nullptr;
 		}
-		return result;
 	}
-	return nullptr;
+	return result;
 }
 
 InstantSpell* Spells::getInstantSpellByName(const std::string& name) {
@@ -323,8 +346,7 @@ bool CombatSpell::executeCastSpell(Creature* creature, const LuaVariant& var) {
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 
 	lua::pushVariant(L, var);
 
@@ -1012,8 +1034,7 @@ bool InstantSpell::executeCastSpell(Creature* creature, const LuaVariant& var) {
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 
 	lua::pushVariant(L, var);
 
@@ -1183,8 +1204,7 @@ bool RuneSpell::executeCastSpell(Creature* creature, const LuaVariant& var, bool
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, creature);
-	lua::setCreatureMetatable(L, -1, creature);
+	lua::pushCreature(L, creature);
 
 	lua::pushVariant(L, var);
 
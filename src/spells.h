@@ -10,6 +10,7 @@
 #include "luascript.h"
 #include "talkaction.h"
 #include "vocation.h"
+#include "wordtrie.h"
 
 class InstantSpell;
 class RuneSpell;
@@ -33,10 +34,15 @@ class Spells final : public BaseEvents {
 		RuneSpell* getRuneSpell(uint32_t id);
 		RuneSpell* getRuneSpellByName(const std::string& name);
 
-		InstantSpell* getInstantSpell(const std::string& words);
+		InstantSpell* getInstantSpell(std::string_view words);
 		InstantSpell* getInstantSpellByName(const std::string& name);
 
-		TalkActionResult_t playerSaySpell(Player* player, std::string& words);
+		/**
+		 * Casts the instant spell the text starts with.
+		 *
+		 * @param words receives the words to say on success
+		 */
+		TalkActionResult_t playerSaySpell(Player* player, std::string_view text, std::string& words);
 
 		static Position getCasterPosition(Creature* creature, Direction dir);
 		std::string_view getScriptBaseName() const override {
@@ -49,6 +55,7 @@ class Spells final : public BaseEvents {
 
 		void clearMaps(bool fromLua);
 		void clear(bool fromLua) override final;
+		void removeScriptEvents(ScriptEventSet& events);
 		bool registerInstantLuaEvent(InstantSpell* event);
 		bool registerRuneLuaEvent(RuneSpell* event);
 
@@ -56,9 +63,11 @@ class Spells final : public BaseEvents {
 		LuaScriptInterface& getScriptInterface() override;
 		Event_ptr getEvent(const std::string& nodeName) override;
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
+		void rebuildInstantWords();
 
 		std::map<uint16_t, RuneSpell> runes;
 		std::map<std::string, InstantSpell> instants;
+		WordTrie<InstantSpell> instantWords;
 
 		friend class CombatSpell;
 		LuaScriptInterface scriptInterface { "Spell Interface" };
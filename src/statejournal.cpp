@@ -0,0 +1,578 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "statejournal.h"
+
+#include "configmanager.h"
+#include "game/game.h"
+#include "house.h"
+#include "iologindata.h"
+#include "iomapserialize.h"
+#include "scheduler.h"
+
+#include <boost/crc.hpp>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+extern Game g_game;
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+constexpr std::array<char, 4> JOURNAL_MAGIC = {'T', 'F', 'S', 'J'};
+constexpr uint32_t JOURNAL_VERSION = 2;
+constexpr size_t JOURNAL_HEADER_SIZE = JOURNAL_MAGIC.size() + sizeof(uint32_t);
+constexpr size_t RECORD_KEY_SIZE = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+uint32_t checksum(std::string_view data) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data.data(), data.size());
+	return crc.checksum();
+}
+
+void writeFrame(std::string& out, std::string_view data) {
+	uint32_t length = static_cast<uint32_t>(data.size());
+	uint32_t crc = checksum(data);
+	out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+	out.append(data);
+	out.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+}
+
+void writeCommit(std::string& out, uint32_t records) {
+	PropWriteStream stream;
+	stream.write<uint8_t>(JOURNAL_BATCH_COMMIT);
+	stream.write<uint32_t>(records);
+	stream.write<uint32_t>(0);
+	writeFrame(out, stream.getStream());
+}
+
+std::string header() {
+	std::string out(JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size());
+	out.append(reinterpret_cast<const char*>(&JOURNAL_VERSION), sizeof(JOURNAL_VERSION));
+	return out;
+}
+
+PropWriteStream& beginRecord(PropWriteStream& stream, JournalRecord_t type, uint32_t id, uint32_t sub = 0) {
+	stream.clear();
+	stream.write<uint8_t>(type);
+	stream.write<uint32_t>(id);
+	stream.write<uint32_t>(sub);
+	return stream;
+}
+
+bool isSaveEnabled(uint32_t guid) {
+	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", guid));
+	return result && result->getNumber<uint16_t>("save") != 0;
+}
+
+}
+
+bool StateJournal::replay() {
+	const std::string& journalPath = getString(ConfigManager::STATE_JOURNAL_FILE);
+	if (!std::filesystem::exists(journalPath)) {
+		return true;
+	}
+
+	std::map<RecordKey, std::string> records;
+	if (!loadRecords(journalPath, records)) {
+		return false;
+	}
+
+	if (!records.empty()) {
+		std::cout << ">> Replaying " << records.size() << " journaled state changes from " << journalPath << std::endl;
+		if (!applyToDatabase(records)) {
+			std::cout << "[Error - StateJournal::replay] Failed to apply the journal, it has been kept for inspection." << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::remove(journalPath, ec);
+	if (ec) {
+		std::cout << "[Error - StateJournal::replay] Unable to remove " << journalPath << ": " << ec.message() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void StateJournal::start() {
+	enabled = getBoolean(ConfigManager::STATE_JOURNAL);
+	if (!enabled) {
+		return;
+	}
+
+	path = getString(ConfigManager::STATE_JOURNAL_FILE);
+	maxFileSize = static_cast<uint64_t>(std::max<int32_t>(1, getNumber(ConfigManager::STATE_JOURNAL_MAX_SIZE))) * 1024 * 1024;
+
+	std::error_code ec;
+	std::filesystem::path parent = std::filesystem::path(path).parent_path();
+	if (!parent.empty()) {
+		std::filesystem::create_directories(parent, ec);
+	}
+
+	file = fopen(path.c_str(), "wb");
+	if (!file) {
+		std::cout << "[Error - StateJournal::start] Unable to open " << path << ", state journal disabled." << std::endl;
+		enabled = false;
+		return;
+	}
+
+	std::string head = header();
+	fwrite(head.data(), 1, head.size(), file);
+	fileSize = head.size();
+	sync();
+
+	ThreadHolder::start();
+	scheduleFlush();
+}
+
+void StateJournal::threadMain() {
+	std::unique_lock<std::mutex> batchLockUnique(batchLock, std::defer_lock);
+	while (true) {
+		batchLockUnique.lock();
+		if (batches.empty()) {
+			// keep draining after shutdown so the final batch reaches the disk
+			if (getState() == THREAD_STATE_TERMINATED) {
+				batchLockUnique.unlock();
+				break;
+			}
+			batchSignal.wait(batchLockUnique);
+		}
+
+		if (!batches.empty()) {
+			Batch batch = std::move(batches.front());
+			batches.pop_front();
+			batchLockUnique.unlock();
+			writeBatch(batch);
+		} else {
+			batchLockUnique.unlock();
+		}
+	}
+
+	if (file) {
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+void StateJournal::shutdown() {
+	if (!enabled) {
+		return;
+	}
+
+	if (flushEventId != 0) {
+		g_scheduler.stopEvent(flushEventId);
+		flushEventId = 0;
+	}
+
+	flush();
+
+	enabled = false;
+
+	batchLock.lock();
+	setState(THREAD_STATE_TERMINATED);
+	batchLock.unlock();
+	batchSignal.notify_one();
+}
+
+void StateJournal::playerStorage(uint32_t guid, uint32_t key, std::optional<int32_t> value) {
+	if (!enabled) {
+		return;
+	}
+
+	PropWriteStream stream;
+	beginRecord(stream, JOURNAL_PLAYER_STORAGE, guid, key);
+	stream.write<uint8_t>(value ? 1 : 0);
+	stream.write<int32_t>(value.value_or(0));
+	append({JOURNAL_PLAYER_STORAGE, guid, key}, std::string(stream.getStream()));
+}
+
+void StateJournal::playerBalance(uint32_t guid, uint64_t balance) {
+	if (!enabled) {
+		return;
+	}
+
+	PropWriteStream stream;
+	beginRecord(stream, JOURNAL_PLAYER_BALANCE, guid);
+	stream.write<uint64_t>(balance);
+	append({JOURNAL_PLAYER_BALANCE, guid, 0}, std::string(stream.getStream()));
+}
+
+void StateJournal::playerItemsChanged(uint32_t guid) {
+	if (enabled && guid != 0) {
+		dirtyPlayers.insert(guid);
+	}
+}
+
+void StateJournal::playerSaved(uint32_t guid) {
+	if (!enabled) {
+		return;
+	}
+
+	dirtyPlayers.erase(guid);
+
+	PropWriteStream stream;
+	beginRecord(stream, JOURNAL_PLAYER_SAVED, guid);
+	append({JOURNAL_PLAYER_SAVED, guid, 0}, std::string(stream.getStream()));
+}
+
+void StateJournal::houseItemsChanged(const House* house) {
+	if (enabled) {
+		dirtyHouses.insert(house->getId());
+	}
+}
+
+void StateJournal::houseSaved(uint32_t houseId) {
+	if (!enabled) {
+		return;
+	}
+
+	dirtyHouses.erase(houseId);
+
+	PropWriteStream stream;
+	beginRecord(stream, JOURNAL_HOUSE_SAVED, houseId);
+	append({JOURNAL_HOUSE_SAVED, houseId, 0}, std::string(stream.getStream()));
+}
+
+void StateJournal::append(RecordKey key, std::string data) {
+	pending.push_back({key, std::move(data)});
+}
+
+void StateJournal::scheduleFlush() {
+	uint32_t interval = static_cast<uint32_t>(std::max<int32_t>(SCHEDULER_MINTICKS, getNumber(ConfigManager::STATE_JOURNAL_FLUSH_INTERVAL)));
+	flushEventId = g_scheduler.addEvent(createSchedulerTask(interval, [this]() {
+		flush();
+		scheduleFlush();
+	}));
+}
+
+void StateJournal::flush() {
+	if (!enabled) {
+		return;
+	}
+
+	PropWriteStream stream;
+	for (uint32_t guid : dirtyPlayers) {
+		Player* player = g_game.getPlayerByGUID(guid);
+		if (!player) {
+			continue;
+		}
+
+		beginRecord(stream, JOURNAL_PLAYER_ITEMS, guid);
+		IOLoginData::serializePlayerItems(player, stream);
+		append({JOURNAL_PLAYER_ITEMS, guid, 0}, std::string(stream.getStream()));
+	}
+	dirtyPlayers.clear();
+
+	for (uint32_t houseId : dirtyHouses) {
+		House* house = g_game.map.houses.getHouse(houseId);
+		if (!house) {
+			continue;
+		}
+
+		beginRecord(stream, JOURNAL_HOUSE_ITEMS, houseId);
+		IOMapSerialize::serializeHouseItems(house, stream);
+		append({JOURNAL_HOUSE_ITEMS, houseId, 0}, std::string(stream.getStream()));
+	}
+	dirtyHouses.clear();
+
+	if (pending.empty()) {
+		return;
+	}
+
+	Batch batch;
+	batch.records = std::move(pending);
+	pending.clear();
+
+	batchLock.lock();
+	batches.push_back(std::move(batch));
+	batchLock.unlock();
+	batchSignal.notify_one();
+}
+
+void StateJournal::compact() {
+	if (!enabled) {
+		return;
+	}
+
+	pending.clear();
+	dirtyPlayers.clear();
+	dirtyHouses.clear();
+
+	Batch batch;
+	batch.truncate = true;
+
+	batchLock.lock();
+	batches.clear();
+	batches.push_back(std::move(batch));
+	batchLock.unlock();
+	batchSignal.notify_one();
+}
+
+void StateJournal::writeBatch(Batch& batch) {
+	if (!file) {
+		return;
+	}
+
+	if (batch.truncate) {
+		live.clear();
+		rewrite();
+		saveRequested = false;
+		return;
+	}
+
+	std::string buffer;
+	for (Record& record : batch.records) {
+		writeFrame(buffer, record.data);
+		applyRecord(live, record.key, std::move(record.data));
+	}
+	writeCommit(buffer, static_cast<uint32_t>(batch.records.size()));
+
+	if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+		std::cout << "[Error - StateJournal::writeBatch] Failed to append to " << path << std::endl;
+	}
+	fileSize += buffer.size();
+	sync();
+
+	if (fileSize <= maxFileSize) {
+		return;
+	}
+
+	// the journal only ever needs the latest record of every key
+	rewrite();
+	if (fileSize > maxFileSize && !saveRequested.exchange(true)) {
+		std::cout << "[Warning - StateJournal] " << path << " exceeds " << (maxFileSize / 1024 / 1024) << " MB after compaction, saving the game state." << std::endl;
+		g_dispatcher.addTask([]() {
+			g_game.saveGameState();
+		});
+	}
+}
+
+bool StateJournal::rewrite() {
+	std::string buffer = header();
+	for (const auto& it : live) {
+		writeFrame(buffer, it.second);
+	}
+	writeCommit(buffer, static_cast<uint32_t>(live.size()));
+
+	const std::string tmpPath = path + ".tmp";
+	FILE* tmp = fopen(tmpPath.c_str(), "wb");
+	if (!tmp) {
+		std::cout << "[Error - StateJournal::rewrite] Unable to open " << tmpPath << std::endl;
+		return false;
+	}
+
+	bool written = fwrite(buffer.data(), 1, buffer.size(), tmp) == buffer.size() && fflush(tmp) == 0;
+#ifdef _WIN32
+	written = written && _commit(_fileno(tmp)) == 0;
+#else
+	written = written && fsync(fileno(tmp)) == 0;
+#endif
+	fclose(tmp);
+
+	if (!written) {
+		std::cout << "[Error - StateJournal::rewrite] Unable to write " << tmpPath << std::endl;
+		return false;
+	}
+
+	fclose(file);
+	file = nullptr;
+
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::cout << "[Error - StateJournal::rewrite] Unable to replace " << path << ": " << ec.message() << std::endl;
+	}
+
+	file = fopen(path.c_str(), "ab");
+	fileSize = buffer.size();
+	return !ec && file;
+}
+
+bool StateJournal::sync() {
+	if (fflush(file) != 0) {
+		return false;
+	}
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+void StateJournal::applyRecord(std::map<RecordKey, std::string>& records, RecordKey key, std::string data) {
+	auto [type, id, sub] = key;
+	switch (type) {
+		case JOURNAL_PLAYER_SAVED: {
+			for (uint8_t playerType : {JOURNAL_PLAYER_STORAGE, JOURNAL_PLAYER_BALANCE, JOURNAL_PLAYER_ITEMS}) {
+				records.erase(records.lower_bound({playerType, id, 0}), records.upper_bound({playerType, id, std::numeric_limits<uint32_t>::max()}));
+			}
+			break;
+		}
+
+		case JOURNAL_HOUSE_SAVED:
+			records.erase({JOURNAL_HOUSE_ITEMS, id, 0});
+			break;
+
+		default:
+			records.insert_or_assign(key, std::move(data));
+			break;
+	}
+}
+
+bool StateJournal::loadRecords(const std::string& journalPath, std::map<RecordKey, std::string>& records) {
+	std::ifstream input(journalPath, std::ios::binary);
+	if (!input) {
+		std::cout << "[Error - StateJournal::loadRecords] Unable to open " << journalPath << std::endl;
+		return false;
+	}
+
+	std::string contents{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+	if (contents.empty()) {
+		return true;
+	}
+
+	if (contents.compare(0, JOURNAL_HEADER_SIZE, header()) != 0) {
+		std::cout << "[Error - StateJournal::loadRecords] " << journalPath << " is not a state journal of this server version." << std::endl;
+		return false;
+	}
+
+	// the records of the current batch, applied once its commit record is read
+	std::vector<Record> batch;
+
+	PropStream stream;
+	stream.init(contents.data() + JOURNAL_HEADER_SIZE, contents.size() - JOURNAL_HEADER_SIZE);
+	while (stream.size() > 0) {
+		uint32_t length;
+		if (!stream.read<uint32_t>(length) || length < RECORD_KEY_SIZE || stream.size() < length + sizeof(uint32_t)) {
+			// the last batch was torn by the crash
+			std::cout << "[Warning - StateJournal::loadRecords] Ignoring an incomplete record at the end of " << journalPath << std::endl;
+			break;
+		}
+
+		const char* begin = contents.data() + (contents.size() - stream.size());
+		std::string_view data{begin, length};
+		stream.skip(length);
+
+		uint32_t crc = 0;
+		stream.read<uint32_t>(crc);
+		if (crc != checksum(data)) {
+			std::cout << "[Warning - StateJournal::loadRecords] Checksum mismatch in " << journalPath << ", ignoring the remaining records." << std::endl;
+			break;
+		}
+
+		PropStream recordStream;
+		recordStream.init(data.data(), data.size());
+
+		uint8_t type;
+		uint32_t id, sub;
+		recordStream.read<uint8_t>(type);
+		recordStream.read<uint32_t>(id);
+		recordStream.read<uint32_t>(sub);
+		if (type != JOURNAL_BATCH_COMMIT) {
+			batch.push_back({{type, id, sub}, std::string(data)});
+			continue;
+		}
+
+		if (id != batch.size()) {
+			std::cout << "[Warning - StateJournal::loadRecords] Batch size mismatch in " << journalPath << ", ignoring the remaining records." << std::endl;
+			batch.clear();
+			break;
+		}
+
+		for (Record& record : batch) {
+			applyRecord(records, record.key, std::move(record.data));
+		}
+		batch.clear();
+	}
+
+	if (!batch.empty()) {
+		std::cout << "[Warning - StateJournal::loadRecords] Ignoring " << batch.size() << " records of an uncommitted batch at the end of " << journalPath << std::endl;
+	}
+	return true;
+}
+
+bool StateJournal::applyToDatabase(const std::map<RecordKey, std::string>& records) {
+	Database& db = Database::getInstance();
+
+	DBTransaction transaction;
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	std::map<uint32_t, bool> saveEnabled;
+	for (const auto& [key, data] : records) {
+		auto [type, id, sub] = key;
+		if (type != JOURNAL_HOUSE_ITEMS) {
+			auto it = saveEnabled.find(id);
+			if (it == saveEnabled.end()) {
+				it = saveEnabled.emplace(id, isSaveEnabled(id)).first;
+			}
+
+			if (!it->second) {
+				continue;
+			}
+		}
+
+		PropStream stream;
+		stream.init(data.data() + RECORD_KEY_SIZE, data.size() - RECORD_KEY_SIZE);
+
+		switch (type) {
+			case JOURNAL_PLAYER_STORAGE: {
+				uint8_t present;
+				int32_t value;
+				if (!stream.read<uint8_t>(present) || !stream.read<int32_t>(value)) {
+					return false;
+				}
+
+				std::string query;
+				if (present != 0) {
+					query = fmt::format("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ({:d}, {:d}, {:d}) ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)", id, sub, value);
+				} else {
+					query = fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d} AND `key` = {:d}", id, sub);
+				}
+
+				if (!db.executeQuery(query)) {
+					return false;
+				}
+				break;
+			}
+
+			case JOURNAL_PLAYER_BALANCE: {
+				uint64_t balance;
+				if (!stream.read<uint64_t>(balance) || !db.executeQuery(fmt::format("UPDATE `players` SET `balance` = {:d} WHERE `id` = {:d}", balance, id))) {
+					return false;
+				}
+				break;
+			}
+
+			case JOURNAL_PLAYER_ITEMS: {
+				if (!IOLoginData::restorePlayerItems(id, stream)) {
+					return false;
+				}
+				break;
+			}
+
+			case JOURNAL_HOUSE_ITEMS: {
+				if (!IOMapSerialize::restoreHouseItems(id, stream)) {
+					return false;
+				}
+				break;
+			}
+
+			default:
+				std::cout << "[Warning - StateJournal::applyToDatabase] Unknown record type " << static_cast<uint32_t>(type) << std::endl;
+				break;
+		}
+	}
+
+	return transaction.commit();
+}
@@ -0,0 +1,134 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_STATEJOURNAL_H
+#define FS_STATEJOURNAL_H
+
+#include "thread_holder_base.h"
+
+class House;
+class Item;
+
+enum JournalRecord_t : uint8_t {
+	JOURNAL_PLAYER_STORAGE = 1,
+	JOURNAL_PLAYER_BALANCE = 2,
+	JOURNAL_PLAYER_ITEMS = 3,
+	JOURNAL_PLAYER_SAVED = 4,
+	JOURNAL_HOUSE_ITEMS = 5,
+	JOURNAL_HOUSE_SAVED = 6,
+	// closes a batch, id holds the number of records in it
+	JOURNAL_BATCH_COMMIT = 7,
+};
+
+/**
+ * Append-only local journal of state that changed since the last save.
+ *
+ * Mutations are recorded on the dispatcher as compact records (storage
+ * values and bank balance as they change, player and house items as a
+ * snapshot of every owner that became dirty during the last flush interval).
+ * A writer thread appends each batch followed by a commit record and fsyncs
+ * it once. On startup the leftover records of every committed batch are
+ * applied to the database before houses and players are loaded, a batch torn
+ * by a crash is dropped as a whole, and the journal is truncated after every
+ * successful full save.
+ */
+class StateJournal : public ThreadHolder<StateJournal> {
+	public:
+		using RecordKey = std::tuple<uint8_t, uint32_t, uint32_t>;
+
+		StateJournal() = default;
+
+		// non-copyable
+		StateJournal(const StateJournal&) = delete;
+		StateJournal& operator=(const StateJournal&) = delete;
+
+		/**
+		 * Applies the records left behind by an unclean shutdown to the
+		 * database and truncates the journal afterwards.
+		 *
+		 * @return false if the journal could not be applied
+		 */
+		bool replay();
+
+		void start();
+		void shutdown();
+		void threadMain();
+
+		bool isEnabled() const {
+			return enabled;
+		}
+
+		void playerStorage(uint32_t guid, uint32_t key, std::optional<int32_t> value);
+		void playerBalance(uint32_t guid, uint64_t balance);
+		void playerItemsChanged(uint32_t guid);
+		void playerSaved(uint32_t guid);
+
+		void houseItemsChanged(const House* house);
+		void houseSaved(uint32_t houseId);
+
+		/**
+		 * Serializes every dirty player and house and hands the batch to the
+		 * writer thread. Runs periodically on the dispatcher.
+		 */
+		void flush();
+
+		/**
+		 * Drops everything journaled so far. Must only be called after a full
+		 * save persisted all online players and houses.
+		 */
+		void compact();
+
+		/**
+		 * Reads the records of a journal file the way replay does: a later
+		 * record replaces an earlier one of the same key, a save drops
+		 * everything journaled for its owner before it and the records of a
+		 * batch without its commit record are ignored.
+		 *
+		 * @return false if the file is missing or not a journal
+		 */
+		static bool loadRecords(const std::string& path, std::map<RecordKey, std::string>& records);
+
+	private:
+		struct Record {
+			RecordKey key;
+			std::string data;
+		};
+
+		struct Batch {
+			std::vector<Record> records;
+			bool truncate = false;
+		};
+
+		void append(RecordKey key, std::string data);
+		void scheduleFlush();
+
+		void writeBatch(Batch& batch);
+		bool rewrite();
+		bool sync();
+
+		static void applyRecord(std::map<RecordKey, std::string>& records, RecordKey key, std::string data);
+		static bool applyToDatabase(const std::map<RecordKey, std::string>& records);
+
+		// dispatcher side
+		std::vector<Record> pending;
+		std::set<uint32_t> dirtyPlayers;
+		std::set<uint32_t> dirtyHouses;
+		uint32_t flushEventId = 0;
+		bool enabled = false;
+
+		// writer side
+		std::map<RecordKey, std::string> live;
+		std::string path;
+		FILE* file = nullptr;
+		uint64_t fileSize = 0;
+		uint64_t maxFileSize = 0;
+		std::atomic_bool saveRequested{false};
+
+		std::list<Batch> batches;
+		std::mutex batchLock;
+		std::condition_variable batchSignal;
+};
+
+extern StateJournal g_stateJournal;
+
+#endif // FS_STATEJOURNAL_H
@@ -24,9 +24,29 @@ void TalkActions::clear(bool fromLua) {
 		}
 	}
 
+	rebuildTalkActionWords();
 	reInitState(fromLua);
 }
 
+void TalkActions::removeScriptEvents(ScriptEventSet& events) {
+	for (auto it = talkActions.begin(); it != talkActions.end();) {
+		if (events.claim(it->second)) {
+			it = talkActions.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	rebuildTalkActionWords();
+}
+
+void TalkActions::rebuildTalkActionWords() {
+	talkActionWords.clear();
+	for (const auto& entry : talkActions) {
+		talkActionWords.insert(entry.first, &entry);
+	}
+}
+
 LuaScriptInterface& TalkActions::getScriptInterface() {
 	return scriptInterface;
 }
@@ -39,83 +59,73 @@ Event_ptr TalkActions::getEvent(const std::string& nodeName) {
 }
 
 bool TalkActions::registerEvent(Event_ptr event, const pugi::xml_node&) {
-	TalkAction_ptr talkAction{static_cast<TalkAction*>(event.release())}; // event is guaranteed to be a TalkAction
-	std::vector<std::string> words = talkAction->getWordsMap();
-
-	for (size_t i = 0; i < words.size(); i++) {
-		if (i == words.size() - 1) {
-			talkActions.emplace(words[i], std::move(*talkAction));
-		} else {
-			talkActions.emplace(words[i], *talkAction);
-		}
-	}
-
+	registerTalkAction(TalkAction_ptr{static_cast<TalkAction*>(event.release())}); // event is guaranteed to be a TalkAction
 	return true;
 }
 
 bool TalkActions::registerLuaEvent(TalkAction* event) {
-	TalkAction_ptr talkAction{ event };
+	registerTalkAction(TalkAction_ptr{event});
+	return true;
+}
+
+void TalkActions::registerTalkAction(TalkAction_ptr talkAction) {
 	std::vector<std::string> words = talkAction->getWordsMap();
 
 	for (size_t i = 0; i < words.size(); i++) {
+		std::pair<TalkActionMap::iterator, bool> result;
 		if (i == words.size() - 1) {
-			talkActions.emplace(words[i], std::move(*talkAction));
+			result = talkActions.emplace(words[i], std::move(*talkAction));
 		} else {
-			talkActions.emplace(words[i], *talkAction);
+			result = talkActions.emplace(words[i], *talkAction);
 		}
-	}
 
-	return true;
+		if (result.second) {
+			talkActionWords.insert(words[i], &*result.first);
+		}
+	}
 }
 
-TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type, const std::string& words) const {
-	size_t wordsLength = words.length();
-	for (auto it = talkActions.begin(); it != talkActions.end();) {
-		const std::string& talkactionWords = it->first;
-		if (!caseInsensitiveStartsWith(words, talkactionWords)) {
-			++it;
-			continue;
-		}
+TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type, std::string_view words) const {
+	TalkActionResult_t result = TALKACTION_CONTINUE;
+	talkActionWords.forEachPrefix(words, [&](const TalkActionMap::value_type* entry, size_t length) {
+		const auto& [talkactionWords, talkAction] = *entry;
 
-		std::string param;
-		if (wordsLength != talkactionWords.size()) {
-			param = words.substr(talkactionWords.size());
+		std::string_view param;
+		if (words.length() != length) {
+			param = words.substr(length);
 			if (param.front() != ' ') {
-				++it;
-				continue;
+				return false;
+			}
+
+			while (!param.empty() && isspace(static_cast<unsigned char>(param.front()))) {
+				param.remove_prefix(1);
 			}
-			boost::algorithm::trim_left(param);
-
-			std::string separator = it->second.getSeparator();
-			if (separator != " ") {
-				if (!param.empty()) {
-					if (param != separator) {
-						++it;
-						continue;
-					} else {
-						param.erase(param.begin());
-					}
+
+			const std::string& separator = talkAction.getSeparator();
+			if (separator != " " && !param.empty()) {
+				if (param != separator) {
+					return false;
 				}
+				param.remove_prefix(1);
 			}
 		}
 
-		if (it->second.fromLua) {
-			if (it->second.getNeedAccess() && !player->getGroup()->access) {
-				return TALKACTION_CONTINUE;
+		if (talkAction.fromLua) {
+			if (talkAction.getNeedAccess() && !player->getGroup()->access) {
+				return true;
 			}
 
-			if (player->getAccountType() < it->second.getRequiredAccountType()) {
-				return TALKACTION_CONTINUE;
+			if (player->getAccountType() < talkAction.getRequiredAccountType()) {
+				return true;
 			}
 		}
 
-		if (it->second.executeSay(player, talkactionWords, param, type)) {
-			return TALKACTION_CONTINUE;
-		} else {
-			return TALKACTION_BREAK;
+		if (!talkAction.executeSay(player, talkactionWords, param, type)) {
+			result = TALKACTION_BREAK;
 		}
-	}
-	return TALKACTION_CONTINUE;
+		return true;
+	});
+	return result;
 }
 
 bool TalkAction::configureEvent(const pugi::xml_node& node) {
@@ -136,7 +146,7 @@ bool TalkAction::configureEvent(const pugi::xml_node& node) {
 	return true;
 }
 
-bool TalkAction::executeSay(Player* player, const std::string& words, const std::string& param, SpeakClasses type) const {
+bool TalkAction::executeSay(Player* player, const std::string& words, std::string_view param, SpeakClasses type) const {
 	//onSay(player, words, param, type)
 	if (!lua::reserveScriptEnv()) {
 		std::cout << "[Error - TalkAction::executeSay] Call stack overflow" << std::endl;
@@ -150,8 +160,7 @@ bool TalkAction::executeSay(Player* player, const std::string& words, const std:
 
 	scriptInterface->pushFunction(scriptId);
 
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 
 	lua::pushString(L, words);
 	lua::pushString(L, param);
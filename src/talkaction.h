@@ -7,6 +7,7 @@
 #include "baseevents.h"
 #include "const.h"
 #include "luascript.h"
+#include "wordtrie.h"
 
 class TalkAction;
 
@@ -34,7 +35,7 @@ class TalkAction : public Event {
 			words = word;
 			wordsMap.emplace_back(word);
 		}
-		std::string getSeparator() const {
+		const std::string& getSeparator() const {
 			return separator;
 		}
 		void setSeparator(std::string sep) {
@@ -42,7 +43,7 @@ class TalkAction : public Event {
 		}
 
 		//scripting
-		bool executeSay(Player* player, const std::string& words, const std::string& param, SpeakClasses type) const;
+		bool executeSay(Player* player, const std::string& words, std::string_view param, SpeakClasses type) const;
 
 		AccountType_t getRequiredAccountType() const {
 			return requiredAccountType;
@@ -81,10 +82,11 @@ class TalkActions final : public BaseEvents {
 		TalkActions(const TalkActions&) = delete;
 		TalkActions& operator=(const TalkActions&) = delete;
 
-		TalkActionResult_t playerSaySpell(Player* player, SpeakClasses type, const std::string& words) const;
+		TalkActionResult_t playerSaySpell(Player* player, SpeakClasses type, std::string_view words) const;
 
 		bool registerLuaEvent(TalkAction* event);
 		void clear(bool fromLua) override final;
+		void removeScriptEvents(ScriptEventSet& events);
 
 	private:
 		LuaScriptInterface& getScriptInterface() override;
@@ -93,8 +95,13 @@ class TalkActions final : public BaseEvents {
 		}
 		Event_ptr getEvent(const std::string& nodeName) override;
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
+		void registerTalkAction(TalkAction_ptr talkAction);
+		void rebuildTalkActionWords();
 
-		std::map<std::string, TalkAction> talkActions;
+		using TalkActionMap = std::map<std::string, TalkAction>;
+
+		TalkActionMap talkActions;
+		WordTrie<const TalkActionMap::value_type> talkActionWords;
 
 		LuaScriptInterface scriptInterface;
 };
@@ -7,6 +7,8 @@
 
 #include "enums.h"
 #include "game/game.h"
+#include "luagc.h"
+#include "tickbudget.h"
 
 extern Game g_game;
 
@@ -26,6 +28,18 @@ void Dispatcher::threadMain() {
 	while (getState() != THREAD_STATE_TERMINATED) {
 		// check if there are tasks waiting
 		taskLockUnique.lock();
+		if (taskList.empty() && idleHandler) {
+			taskLockUnique.unlock();
+			bool busy = idleHandler();
+			taskLockUnique.lock();
+
+			if (busy && taskList.empty()) {
+				// more idle work, check for tasks again before the next slice
+				taskLockUnique.unlock();
+				continue;
+			}
+		}
+
 		if (taskList.empty()) {
 			//if the list is empty wait for signal
 			taskSignal.wait(taskLockUnique);
@@ -35,9 +49,14 @@ void Dispatcher::threadMain() {
 
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
+				g_tickBudget.addTaskLag(std::chrono::duration_cast<std::chrono::milliseconds>(
+					std::chrono::steady_clock::now() - task->getQueueTime()).count());
+
 				++dispatcherCycle;
 				// execute it
+				g_luaGcGovernor.beginTask();
 				(*task)();
+				g_luaGcGovernor.endTask();
 			}
 			delete task;
 		}
@@ -52,6 +71,7 @@ void Dispatcher::addTask(Task* task) {
 
 	if (getState() == THREAD_STATE_RUNNING) {
 		do_signal = taskList.empty();
+		task->setQueueTime(std::chrono::steady_clock::now());
 		taskList.push_back(task);
 	} else {
 		delete task;
@@ -70,6 +90,7 @@ void Dispatcher::shutdown() {
 		setState(THREAD_STATE_TERMINATED);
 		taskSignal.notify_one();
 	});
+	task->setQueueTime(std::chrono::steady_clock::now());
 
 	std::lock_guard<std::mutex> lockClass(taskLock);
 	taskList.push_back(task);
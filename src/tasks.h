@@ -34,8 +34,17 @@ class Task {
 			return expiration < std::chrono::system_clock::now();
 		}
 
+		// the time the task entered the dispatcher queue, for scheduler tasks the time they were due
+		void setQueueTime(std::chrono::steady_clock::time_point time) {
+			queueTime = time;
+		}
+		std::chrono::steady_clock::time_point getQueueTime() const {
+			return queueTime;
+		}
+
 	protected:
 		std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
+		std::chrono::steady_clock::time_point queueTime;
 
 	private:
 		// Expiration has another meaning for scheduler tasks,
@@ -61,6 +70,15 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 
 		void shutdown();
 
+		/**
+		 * Sets the work run while the task queue is empty. It is called again
+		 * as long as it returns true and no task arrived; it must be set
+		 * before the dispatcher starts.
+		 */
+		void setIdleHandler(std::function<bool()>&& handler) {
+			idleHandler = std::move(handler);
+		}
+
 		uint64_t getDispatcherCycle() const {
 			return dispatcherCycle;
 		}
@@ -72,6 +90,7 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 		std::condition_variable taskSignal;
 
 		std::vector<Task*> taskList;
+		std::function<bool()> idleHandler;
 		uint64_t dispatcherCycle = 0;
 };
 
@@ -0,0 +1,116 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "tickbudget.h"
+
+#include "configmanager.h"
+#include "map.h"
+
+TickBudget g_tickBudget;
+
+void TickBudget::update() {
+	smoothedLag = (smoothedLag * 3 + maxLag) / 4;
+	maxLag = 0;
+
+	const int64_t highLag = getNumber(ConfigManager::LOAD_LAG_HIGH);
+	const int64_t criticalLag = getNumber(ConfigManager::LOAD_LAG_CRITICAL);
+	auto isOver = [this](int64_t threshold) { return threshold > 0 && smoothedLag >= threshold; };
+	auto isUnder = [this](int64_t threshold) { return threshold <= 0 || smoothedLag < threshold / 2; };
+
+	LoadLevel_t newLevel = level;
+	if (newLevel == LOAD_CRITICAL && isUnder(criticalLag)) {
+		newLevel = LOAD_HIGH;
+	}
+	if (newLevel == LOAD_HIGH && isUnder(highLag)) {
+		newLevel = LOAD_NORMAL;
+	}
+	if (isOver(highLag)) {
+		newLevel = std::max(newLevel, LOAD_HIGH);
+	}
+	if (isOver(criticalLag)) {
+		newLevel = LOAD_CRITICAL;
+	}
+
+	if (newLevel == level) {
+		return;
+	}
+
+	const bool raised = newLevel > level;
+	level = newLevel;
+
+	std::cout << (raised ? "[Warning - TickBudget::update]" : "[Notice - TickBudget::update]") << " Dispatcher lag " << smoothedLag
+	          << " ms, load level " << getLoadLevelName(level);
+	if (level != LOAD_NORMAL) {
+		std::cout << ", degraded: " << getDegradedSystemNames();
+	}
+	std::cout << std::endl;
+}
+
+uint8_t TickBudget::getDegradedSystems() const {
+	switch (level) {
+		case LOAD_HIGH:
+			return DEGRADED_PATHFINDING | DEGRADED_SPAWNS;
+		case LOAD_CRITICAL:
+			return DEGRADED_PATHFINDING | DEGRADED_SPAWNS | DEGRADED_DECAY | DEGRADED_EFFECTS;
+		default:
+			return DEGRADED_NONE;
+	}
+}
+
+const char* TickBudget::getLoadLevelName(LoadLevel_t level) {
+	switch (level) {
+		case LOAD_HIGH:
+			return "high";
+		case LOAD_CRITICAL:
+			return "critical";
+		default:
+			return "normal";
+	}
+}
+
+std::string TickBudget::getDegradedSystemNames() const {
+	static constexpr std::pair<DegradedSystem_t, const char*> names[] = {
+		{DEGRADED_PATHFINDING, "pathfinding"},
+		{DEGRADED_SPAWNS, "spawns"},
+		{DEGRADED_DECAY, "decay"},
+		{DEGRADED_EFFECTS, "effects"},
+	};
+
+	std::string result;
+	for (auto&& [system, name] : names) {
+		if (isDegraded(system)) {
+			if (!result.empty()) {
+				result.push_back(',');
+			}
+			result.append(name);
+		}
+	}
+	return result;
+}
+
+uint32_t TickBudget::scalePathfindingInterval(uint32_t interval) const {
+	if (!isDegraded(DEGRADED_PATHFINDING)) {
+		return interval;
+	}
+	// twice the interval under high load, four times under critical load
+	return interval << level;
+}
+
+int32_t TickBudget::scaleSpawnBudget(int32_t budget) const {
+	if (budget <= 0 || !isDegraded(DEGRADED_SPAWNS)) {
+		return budget;
+	}
+	return std::max<int32_t>(1, budget >> level);
+}
+
+bool TickBudget::isEffectSent(const Position& playerPos, const Position& pos) const {
+	if (!isDegraded(DEGRADED_EFFECTS)) {
+		return true;
+	}
+
+	// the players on the same floor with pos on their screen
+	return playerPos.z == pos.z && playerPos.getDistanceX(pos) <= Map::maxClientViewportX
+	       && playerPos.getDistanceY(pos) <= Map::maxClientViewportY;
+}
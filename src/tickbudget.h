@@ -0,0 +1,86 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TICKBUDGET_H
+#define FS_TICKBUDGET_H
+
+#include "position.h"
+
+enum LoadLevel_t : uint8_t {
+	LOAD_NORMAL,
+	LOAD_HIGH,
+	LOAD_CRITICAL,
+};
+
+enum DegradedSystem_t : uint8_t {
+	DEGRADED_NONE = 0,
+	DEGRADED_PATHFINDING = 1 << 0,
+	DEGRADED_SPAWNS = 1 << 1,
+	DEGRADED_DECAY = 1 << 2,
+	DEGRADED_EFFECTS = 1 << 3,
+};
+
+/**
+ * Watches how far the dispatcher runs behind and tells the periodic work
+ * of the game loop how much of it to do.
+ *
+ * Every task records how long it waited between being queued, which for a
+ * scheduler task is the moment it was due, and being run. Once a second the
+ * worst wait of the last second is folded into a smoothed lag that decides
+ * the load level. Going up takes a lag over the threshold, coming back down
+ * one under half of it, so the level does not flap around a threshold.
+ *
+ * Under high load path updates run less often and fewer monsters respawn
+ * per tick; under critical load on top of that non-critical items decay
+ * later and effects are only sent to the players near them.
+ *
+ * All calls happen on the dispatcher thread.
+ */
+class TickBudget {
+	public:
+		// most items whose decay is not deferred in one decay pass under critical load
+		static constexpr size_t DECAY_BUDGET = 100;
+
+		TickBudget() = default;
+
+		// non-copyable
+		TickBudget(const TickBudget&) = delete;
+		TickBudget& operator=(const TickBudget&) = delete;
+
+		void addTaskLag(int64_t lag) {
+			maxLag = std::max(maxLag, lag);
+		}
+
+		// folds the lag of the last second in and logs when the load level changes
+		void update();
+
+		LoadLevel_t getLoadLevel() const {
+			return level;
+		}
+		// smoothed dispatcher lag in milliseconds
+		int64_t getLag() const {
+			return smoothedLag;
+		}
+		uint8_t getDegradedSystems() const;
+		bool isDegraded(DegradedSystem_t system) const {
+			return (getDegradedSystems() & system) != 0;
+		}
+
+		static const char* getLoadLevelName(LoadLevel_t level);
+		// comma separated names of the degraded systems, empty if none
+		std::string getDegradedSystemNames() const;
+
+		uint32_t scalePathfindingInterval(uint32_t interval) const;
+		int32_t scaleSpawnBudget(int32_t budget) const;
+		// whether a player at playerPos still gets the effects shown at pos
+		bool isEffectSent(const Position& playerPos, const Position& pos) const;
+
+	private:
+		int64_t maxLag = 0;
+		int64_t smoothedLag = 0;
+		LoadLevel_t level = LOAD_NORMAL;
+};
+
+extern TickBudget g_tickBudget;
+
+#endif // FS_TICKBUDGET_H
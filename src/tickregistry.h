@@ -0,0 +1,175 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TICKREGISTRY_H
+#define FS_TICKREGISTRY_H
+
+/**
+ * Position of an object inside a TickRegistry, stored on the object itself.
+ */
+struct TickHandle {
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	uint32_t index = NONE;
+	uint8_t bucket = 0;
+};
+
+/**
+ * Dense registry of the objects that are ticked periodically, split in
+ * buckets that are ticked one after another.
+ *
+ * Each bucket keeps its objects and their per-tick flags in two parallel
+ * vectors. A tick walks the flags and only touches the objects that are
+ * neither idle nor removed; the flags also tell the caller which parts of
+ * the tick an object needs. Objects are removed with a swap with the last
+ * entry, updating the handle of the moved object. Removing from the bucket
+ * being ticked only marks the entry and the swap happens after the tick, so
+ * a tick never skips or repeats an object.
+ *
+ * T must provide TickHandle& getTickHandle().
+ */
+template <typename T, size_t BucketCount>
+class TickRegistry {
+	public:
+		enum Flag : uint8_t {
+			// removed during a tick of its bucket, swapped out after it
+			FLAG_REMOVED = 1 << 0,
+			// kept registered but skipped until added again
+			FLAG_IDLE = 1 << 1,
+			FLAG_HAS_TARGET = 1 << 2,
+			FLAG_HAS_CONDITIONS = 1 << 3,
+		};
+
+		using ReleaseFunction = std::function<void(T*)>;
+
+		/**
+		 * @param release called for every object leaving the registry, to drop the reference taken by the caller of add
+		 */
+		explicit TickRegistry(ReleaseFunction release) : release(std::move(release)) {}
+
+		// non-copyable
+		TickRegistry(const TickRegistry&) = delete;
+		TickRegistry& operator=(const TickRegistry&) = delete;
+
+		/**
+		 * Registers the object in the given bucket, or makes an already
+		 * registered object active again with the new flags.
+		 *
+		 * @return true if the object was not registered yet
+		 */
+		bool add(T* object, size_t bucket, uint8_t flags) {
+			TickHandle& handle = object->getTickHandle();
+			if (handle.index != TickHandle::NONE) {
+				buckets[handle.bucket].flags[handle.index] = flags;
+				return false;
+			}
+
+			Bucket& target = buckets[bucket];
+			handle.index = static_cast<uint32_t>(target.objects.size());
+			handle.bucket = static_cast<uint8_t>(bucket);
+			target.objects.push_back(object);
+			target.flags.push_back(flags);
+			++count;
+			return true;
+		}
+
+		void remove(T* object) {
+			const TickHandle& handle = object->getTickHandle();
+			if (handle.index == TickHandle::NONE) {
+				return;
+			}
+
+			Bucket& bucket = buckets[handle.bucket];
+			if (handle.bucket == tickingBucket) {
+				bucket.flags[handle.index] |= FLAG_REMOVED;
+				bucket.pendingRemovals = true;
+				return;
+			}
+			swapRemove(bucket, handle.index);
+		}
+
+		void setFlag(T* object, Flag flag, bool value) {
+			const TickHandle& handle = object->getTickHandle();
+			if (handle.index == TickHandle::NONE) {
+				return;
+			}
+
+			uint8_t& flags = buckets[handle.bucket].flags[handle.index];
+			if (value) {
+				flags |= flag;
+			} else {
+				flags &= ~flag;
+			}
+		}
+
+		bool hasFlag(T* object, Flag flag) const {
+			const TickHandle& handle = object->getTickHandle();
+			return handle.index != TickHandle::NONE && (buckets[handle.bucket].flags[handle.index] & flag) != 0;
+		}
+
+		/**
+		 * Calls fn(object) for every object of the bucket that is neither idle
+		 * nor removed, including the ones fn adds to it.
+		 */
+		template <typename Fn>
+		void tick(size_t index, Fn&& fn) {
+			Bucket& bucket = buckets[index];
+			tickingBucket = index;
+			for (size_t i = 0; i < bucket.objects.size(); ++i) {
+				if ((bucket.flags[i] & (FLAG_REMOVED | FLAG_IDLE)) == 0) {
+					fn(bucket.objects[i]);
+				}
+			}
+			tickingBucket = NO_BUCKET;
+
+			if (!bucket.pendingRemovals) {
+				return;
+			}
+
+			bucket.pendingRemovals = false;
+			for (size_t i = 0; i < bucket.objects.size();) {
+				if (bucket.flags[i] & FLAG_REMOVED) {
+					// the last entry moves here, check this slot again
+					swapRemove(bucket, i);
+				} else {
+					++i;
+				}
+			}
+		}
+
+		size_t size() const {
+			return count;
+		}
+
+	private:
+		static constexpr size_t NO_BUCKET = std::numeric_limits<size_t>::max();
+
+		struct Bucket {
+			std::vector<T*> objects;
+			std::vector<uint8_t> flags;
+			bool pendingRemovals = false;
+		};
+
+		void swapRemove(Bucket& bucket, size_t index) {
+			T* object = bucket.objects[index];
+			const size_t last = bucket.objects.size() - 1;
+			if (index != last) {
+				bucket.objects[index] = bucket.objects[last];
+				bucket.flags[index] = bucket.flags[last];
+				bucket.objects[index]->getTickHandle().index = static_cast<uint32_t>(index);
+			}
+			bucket.objects.pop_back();
+			bucket.flags.pop_back();
+			--count;
+
+			object->getTickHandle() = {};
+			release(object);
+		}
+
+		std::array<Bucket, BucketCount> buckets;
+		ReleaseFunction release;
+		size_t tickingBucket = NO_BUCKET;
+		size_t count = 0;
+};
+
+#endif // FS_TICKREGISTRY_H
@@ -13,6 +13,7 @@
 #include "mailbox.h"
 #include "monster.h"
 #include "movement.h"
+#include "sightcache.h"
 #include "spectators.h"
 #include "teleport.h"
 #include "trashholder.h"
@@ -937,6 +938,7 @@ void Tile::updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 	item->setSubType(count);
 	setTileFlags(item);
 	onUpdateTileItem(item, oldType, item, newType);
+	item->markHouseItemsDirty();
 }
 
 void Tile::replaceThing(uint32_t index, Thing* thing) {
@@ -1004,6 +1006,7 @@ void Tile::replaceThing(uint32_t index, Thing* thing) {
 		const ItemType& oldType = Item::items[oldItem->getID()];
 		const ItemType& newType = Item::items[item->getID()];
 		onUpdateTileItem(oldItem, oldType, item, newType);
+		item->markHouseItemsDirty();
 
 		oldItem->setParent(nullptr);
 		return /*RETURNVALUE_NOERROR*/;
@@ -1491,6 +1494,13 @@ void Tile::setTileFlags(const Item* item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !hasFlag(TILESTATE_BLOCKPROJECTILE)) {
+		setFlag(TILESTATE_BLOCKPROJECTILE);
+		SightCache::invalidateAll();
+	} else if (item == ground) {
+		SightCache::invalidateAll();
+	}
 }
 
 void Tile::resetTileFlags(const Item* item) {
@@ -1551,6 +1561,13 @@ void Tile::resetTileFlags(const Item* item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !hasProperty(item, CONST_PROP_BLOCKPROJECTILE)) {
+		resetFlag(TILESTATE_BLOCKPROJECTILE);
+		SightCache::invalidateAll();
+	} else if (Item::items[item->getID()].isGroundTile()) {
+		SightCache::invalidateAll();
+	}
 }
 
 bool Tile::isMoveableBlocking() const {
@@ -0,0 +1,189 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TIMINGWHEEL_H
+#define FS_TIMINGWHEEL_H
+
+/**
+ * Position of an object inside a TimingWheel, stored on the object itself.
+ */
+struct TimerHandle {
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	TimerHandle() = default;
+	// a copy of a scheduled object is not scheduled, assigning resets the handle
+	TimerHandle(const TimerHandle&) {}
+	TimerHandle& operator=(const TimerHandle&) {
+		expiry = 0;
+		index = NONE;
+		level = 0;
+		slot = 0;
+		return *this;
+	}
+
+	bool isScheduled() const {
+		return index != NONE;
+	}
+
+	// absolute time in milliseconds
+	int64_t expiry = 0;
+	uint32_t index = NONE;
+	uint8_t level = 0;
+	uint8_t slot = 0;
+};
+
+/**
+ * Hierarchical timing wheel keyed by absolute expiry time.
+ *
+ * Level 0 has one slot per tick of the given resolution, each further level
+ * has slots as long as the whole level below. An object sits in the level
+ * matching how far its expiry is; when a level wraps around, the next slot of
+ * the level above is cascaded down. Scheduling and unscheduling are O(1)
+ * through the handle, and an object is only touched again when its slot is
+ * cascaded, which happens at most once per level, or when it expires.
+ *
+ * Expiries further than the wheel reaches are parked in the last slot in
+ * reach and placed again when it is cascaded.
+ *
+ * T must provide TimerHandle& getTimerHandle().
+ */
+template <typename T>
+class TimingWheel {
+	public:
+		TimingWheel(int64_t resolution, int64_t now) : resolution(resolution), currentTick(now / resolution) {}
+
+		// non-copyable
+		TimingWheel(const TimingWheel&) = delete;
+		TimingWheel& operator=(const TimingWheel&) = delete;
+
+		/**
+		 * Schedules the object to expire at the given time, rounded up to the
+		 * resolution, or moves it there if it was scheduled already.
+		 *
+		 * @return true if the object was not scheduled yet
+		 */
+		bool schedule(T* object, int64_t expiry) {
+			const bool wasScheduled = object->getTimerHandle().isScheduled();
+			if (wasScheduled) {
+				unlink(object);
+			}
+
+			object->getTimerHandle().expiry = expiry;
+			place(object, std::max<int64_t>((expiry + resolution - 1) / resolution, currentTick + 1));
+			return !wasScheduled;
+		}
+
+		/**
+		 * @return false if the object was not scheduled
+		 */
+		bool unschedule(T* object) {
+			if (!object->getTimerHandle().isScheduled()) {
+				return false;
+			}
+
+			unlink(object);
+			object->getTimerHandle() = {};
+			return true;
+		}
+
+		/**
+		 * Moves the wheel up to the given time and calls fn(object) for every
+		 * object expired meanwhile. The objects are unscheduled before fn is
+		 * called, fn may schedule them or any other object again.
+		 */
+		template <typename Fn>
+		void advance(int64_t now, Fn&& fn) {
+			const int64_t targetTick = now / resolution;
+			while (currentTick < targetTick) {
+				++currentTick;
+				cascade();
+
+				std::vector<T*>& slot = slots[0][currentTick & SLOT_MASK];
+				if (slot.empty()) {
+					continue;
+				}
+
+				expired.swap(slot);
+				count -= expired.size();
+				for (T* object : expired) {
+					object->getTimerHandle() = {};
+				}
+				for (T* object : expired) {
+					fn(object);
+				}
+				expired.clear();
+			}
+		}
+
+		size_t size() const {
+			return count;
+		}
+
+	private:
+		static constexpr int SLOT_BITS = 6;
+		static constexpr size_t SLOTS = 1 << SLOT_BITS;
+		static constexpr int64_t SLOT_MASK = SLOTS - 1;
+		static constexpr size_t LEVELS = 4;
+		// ticks from the current one to the last slot in reach
+		static constexpr int64_t REACH = (int64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+
+		void place(T* object, int64_t tick) {
+			tick = std::min(tick, currentTick + REACH);
+
+			const int64_t delta = tick - currentTick;
+			size_t level = 0;
+			while (level < LEVELS - 1 && delta >= (int64_t{1} << (SLOT_BITS * (level + 1)))) {
+				++level;
+			}
+
+			const size_t slotIndex = (tick >> (SLOT_BITS * level)) & SLOT_MASK;
+			std::vector<T*>& slot = slots[level][slotIndex];
+
+			TimerHandle& handle = object->getTimerHandle();
+			handle.index = static_cast<uint32_t>(slot.size());
+			handle.level = static_cast<uint8_t>(level);
+			handle.slot = static_cast<uint8_t>(slotIndex);
+			slot.push_back(object);
+			++count;
+		}
+
+		// swap-removes the object from its slot, the handle is left as is
+		void unlink(T* object) {
+			const TimerHandle& handle = object->getTimerHandle();
+			std::vector<T*>& slot = slots[handle.level][handle.slot];
+			if (handle.index != slot.size() - 1) {
+				T* moved = slot.back();
+				slot[handle.index] = moved;
+				moved->getTimerHandle().index = handle.index;
+			}
+			slot.pop_back();
+			--count;
+		}
+
+		// once a level wrapped around, places the objects of the next slot of each level above again
+		void cascade() {
+			for (size_t level = 1; level < LEVELS; ++level) {
+				if ((currentTick & ((int64_t{1} << (SLOT_BITS * level)) - 1)) != 0) {
+					return;
+				}
+
+				std::vector<T*>& slot = slots[level][(currentTick >> (SLOT_BITS * level)) & SLOT_MASK];
+				cascading.swap(slot);
+				count -= cascading.size();
+				for (T* object : cascading) {
+					const int64_t expiry = object->getTimerHandle().expiry;
+					place(object, std::max<int64_t>((expiry + resolution - 1) / resolution, currentTick));
+				}
+				cascading.clear();
+			}
+		}
+
+		std::array<std::array<std::vector<T*>, SLOTS>, LEVELS> slots;
+		std::vector<T*> expired;
+		std::vector<T*> cascading;
+		int64_t resolution;
+		int64_t currentTick;
+		size_t count = 0;
+};
+
+#endif // FS_TIMINGWHEEL_H
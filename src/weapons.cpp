@@ -108,10 +108,26 @@ bool Weapons::registerEvent(Event_ptr event, const pugi::xml_node&) {
 }
 
 bool Weapons::registerLuaEvent(Weapon* weapon) {
-	weapons[weapon->getID()] = weapon;
+	Weapon*& entry = weapons[weapon->getID()];
+	if (entry && entry != weapon) {
+		// a script reloaded on its own registers its weapons again
+		delete entry;
+	}
+	entry = weapon;
 	return true;
 }
 
+void Weapons::removeScriptEvents(ScriptEventSet& events) {
+	for (auto it = weapons.begin(); it != weapons.end();) {
+		if (events.claim(*it->second)) {
+			delete it->second;
+			it = weapons.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
 //monsters
 int32_t Weapons::getMaxMeleeDamage(int32_t attackSkill, int32_t attackValue) {
 	return static_cast<int32_t>(std::ceil((attackSkill * (attackValue * 0.05)) + (attackValue * 0.5)));
@@ -460,8 +476,7 @@ bool Weapon::executeUseWeapon(Player* player, const LuaVariant& var) const {
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	lua::pushUserdata(L, player);
-	lua::setMetatable(L, -1, "Player");
+	lua::pushCreature(L, player);
 	lua::pushVariant(L, var);
 
 	return scriptInterface->callFunction(2);
@@ -32,6 +32,7 @@ class Weapons final : public BaseEvents {
 		static int32_t getMaxWeaponDamage(uint32_t level, int32_t attackSkill, int32_t attackValue, float attackFactor);
 
 		bool registerLuaEvent(Weapon* event);
+		void removeScriptEvents(ScriptEventSet& events);
 		void clear(bool fromLua) override final;
 
 	private:
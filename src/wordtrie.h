@@ -0,0 +1,120 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_WORDTRIE_H
+#define FS_WORDTRIE_H
+
+/**
+ * Case-insensitive prefix trie mapping spell and talkaction words to their handler.
+ *
+ * Words are folded with tolower on insert and on lookup, so finding every
+ * registered word a chat line starts with costs one step per character of the
+ * line instead of one comparison per registered word. The trie stores
+ * pointers only; owners rebuild it whenever entries are erased.
+ */
+template <typename T>
+class WordTrie {
+	public:
+		WordTrie() {
+			clear();
+		}
+
+		void clear() {
+			nodes.clear();
+			nodes.emplace_back();
+		}
+
+		/**
+		 * @return false if the words were already registered, the first registration is kept
+		 */
+		bool insert(std::string_view words, T* value) {
+			uint32_t index = 0;
+			for (char ch : words) {
+				ch = fold(ch);
+				uint32_t child = findChild(index, ch);
+				if (child == 0) {
+					child = static_cast<uint32_t>(nodes.size());
+					nodes[index].children.emplace_back(ch, child);
+					nodes.emplace_back();
+				}
+				index = child;
+			}
+
+			if (nodes[index].value) {
+				return false;
+			}
+
+			nodes[index].value = value;
+			return true;
+		}
+
+		/**
+		 * Finds the longest registered words that prefix the text.
+		 *
+		 * @return the value and the length of its words, nullptr if none matches
+		 */
+		std::pair<T*, size_t> findLongest(std::string_view text) const {
+			std::pair<T*, size_t> result{nodes.front().value, 0};
+			uint32_t index = 0;
+			for (size_t pos = 0; pos < text.size(); ++pos) {
+				index = findChild(index, fold(text[pos]));
+				if (index == 0) {
+					break;
+				}
+
+				if (nodes[index].value) {
+					result = {nodes[index].value, pos + 1};
+				}
+			}
+			return result;
+		}
+
+		/**
+		 * Calls fn(value, length) for every registered words that prefix the
+		 * text while walking it, shortest first like the sorted word map,
+		 * until fn returns true.
+		 */
+		template <typename Fn>
+		void forEachPrefix(std::string_view text, Fn fn) const {
+			if (nodes.front().value && fn(nodes.front().value, 0)) {
+				return;
+			}
+
+			uint32_t index = 0;
+			for (size_t pos = 0; pos < text.size(); ++pos) {
+				index = findChild(index, fold(text[pos]));
+				if (index == 0) {
+					return;
+				}
+
+				if (nodes[index].value && fn(nodes[index].value, pos + 1)) {
+					return;
+				}
+			}
+		}
+
+	private:
+		struct Node {
+			// few children per node, a linear scan beats a map
+			std::vector<std::pair<char, uint32_t>> children;
+			T* value = nullptr;
+		};
+
+		static char fold(char ch) {
+			return static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+		}
+
+		// the root is never a child, so 0 means "no such child"
+		uint32_t findChild(uint32_t index, char ch) const {
+			for (const auto& [childChar, child] : nodes[index].children) {
+				if (childChar == ch) {
+					return child;
+				}
+			}
+			return 0;
+		}
+
+		std::vector<Node> nodes;
+};
+
+#endif // FS_WORDTRIE_H
@@ -0,0 +1,189 @@
+#include "otpch.h"
+#include "matrixarea.h"
+
+#include <boost/container/small_vector.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+// The largest rune, wave and beam areas of data/spells/lib/spells.lua cast
+// in random directions over a small map. Each cast collects the tiles of
+// the area and the spectator range, once the way getCombatArea did it from
+// the rotated MatrixArea and once from the AreaOffsets computed at setup.
+// The sight check is a lookup in a grid of blocking tiles, the same for both.
+
+namespace {
+
+constexpr int MAP_SIZE = 256;
+constexpr int CASTS = 200000;
+
+struct FakeTile {
+        int32_t x = 0;
+        int32_t y = 0;
+        bool blocking = false;
+};
+
+struct FakeMap {
+        std::vector<FakeTile> tiles;
+
+        FakeMap() : tiles(MAP_SIZE * MAP_SIZE) {
+                std::mt19937 rng{3};
+                std::uniform_int_distribution<int> percent(0, 99);
+                for (int y = 0; y < MAP_SIZE; ++y) {
+                        for (int x = 0; x < MAP_SIZE; ++x) {
+                                FakeTile& tile = tiles[y * MAP_SIZE + x];
+                                tile.x = x;
+                                tile.y = y;
+                                tile.blocking = percent(rng) < 5;
+                        }
+                }
+        }
+
+        FakeTile* getTile(int32_t x, int32_t y) {
+                return &tiles[(y & (MAP_SIZE - 1)) * MAP_SIZE + (x & (MAP_SIZE - 1))];
+        }
+
+        bool isSightClear(int32_t x, int32_t y) {
+                return !getTile(x, y)->blocking;
+        }
+};
+
+struct Shape {
+        const char* name;
+        std::vector<uint32_t> cells;
+        uint32_t rows;
+};
+
+const std::vector<Shape>& getShapes() {
+        static const std::vector<Shape> shapes = {
+                {"circle6x6", {
+                        0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
+                        0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0,
+                        0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
+                        0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        1, 1, 1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 1,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+                        0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
+                        0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0,
+                        0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
+                }, 13},
+                {"squarewave6", {
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+                        0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+                        0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+                        0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+                        0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
+                        0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
+                        0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0,
+                        0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0,
+                        0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                        0, 0, 0, 0, 0, 3, 0, 0, 0, 0, 0,
+                }, 12},
+                {"beam8", {1, 1, 1, 1, 1, 1, 1, 3}, 8},
+        };
+        return shapes;
+}
+
+// the four directions, as AreaCombat::setupArea rotates them
+std::array<MatrixArea, 4> rotate(const MatrixArea& area) {
+        return {area, area.rotate90(), area.rotate180(), area.rotate270()};
+}
+
+// getList and the range scan of Combat::doAreaCombat before AreaOffsets
+size_t castMatrix(FakeMap& map, const MatrixArea& area, int32_t targetX, int32_t targetY, int32_t& rangeX, int32_t& rangeY) {
+        std::vector<FakeTile*> vec;
+
+        auto center = area.getCenter();
+        int32_t x = targetX - center.first;
+        int32_t y = targetY - center.second;
+        for (uint32_t row = 0; row < area.getRows(); ++row, ++y) {
+                for (uint32_t col = 0; col < area.getCols(); ++col, ++x) {
+                        if (area(row, col) && map.isSightClear(x, y)) {
+                                vec.push_back(map.getTile(x, y));
+                        }
+                }
+                x -= area.getCols();
+        }
+
+        int32_t maxX = 0;
+        int32_t maxY = 0;
+        for (FakeTile* tile : vec) {
+                maxX = std::max(maxX, std::abs(tile->x - (targetX & (MAP_SIZE - 1))));
+                maxY = std::max(maxY, std::abs(tile->y - (targetY & (MAP_SIZE - 1))));
+        }
+        rangeX = maxX;
+        rangeY = maxY;
+        return vec.size();
+}
+
+size_t castOffsets(FakeMap& map, const AreaOffsets& area, int32_t targetX, int32_t targetY, int32_t& rangeX, int32_t& rangeY) {
+        boost::container::small_vector<FakeTile*, 64> tiles;
+        for (auto&& [x, y] : area.offsets) {
+                if (map.isSightClear(targetX + x, targetY + y)) {
+                        tiles.push_back(map.getTile(targetX + x, targetY + y));
+                }
+        }
+        rangeX = area.maxX;
+        rangeY = area.maxY;
+        return tiles.size();
+}
+
+} // namespace
+
+int main() {
+        FakeMap map;
+        bool failed = false;
+
+        for (const Shape& shape : getShapes()) {
+                const MatrixArea area = createArea(shape.cells, shape.rows);
+                const auto matrices = rotate(area);
+                std::array<AreaOffsets, 4> offsets;
+                for (size_t dir = 0; dir < 4; ++dir) {
+                        offsets[dir] = createAreaOffsets(matrices[dir]);
+                }
+
+                std::vector<std::array<int32_t, 3>> casts(CASTS);
+                std::mt19937 rng{11};
+                std::uniform_int_distribution<int32_t> coordinate(16, MAP_SIZE - 16);
+                std::uniform_int_distribution<int32_t> direction(0, 3);
+                for (auto& cast : casts) {
+                        cast = {coordinate(rng), coordinate(rng), direction(rng)};
+                }
+
+                uint64_t matrixTiles = 0;
+                int32_t matrixRange = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (auto&& [x, y, dir] : casts) {
+                        int32_t rangeX, rangeY;
+                        matrixTiles += castMatrix(map, matrices[dir], x, y, rangeX, rangeY);
+                        matrixRange = std::max({matrixRange, rangeX, rangeY});
+                }
+                double matrixMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                uint64_t offsetTiles = 0;
+                int32_t offsetRange = 0;
+                start = std::chrono::steady_clock::now();
+                for (auto&& [x, y, dir] : casts) {
+                        int32_t rangeX, rangeY;
+                        offsetTiles += castOffsets(map, offsets[dir], x, y, rangeX, rangeY);
+                        offsetRange = std::max({offsetRange, rangeX, rangeY});
+                }
+                double offsetMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                std::printf("%-12s %3zu cells  matrix %8.2f ms  offsets %8.2f ms for %d casts\n", shape.name,
+                            offsets[0].offsets.size(), matrixMs, offsetMs, CASTS);
+
+                // the offsets must hit the same tiles, their range covers the whole area
+                if (matrixTiles != offsetTiles || offsetRange < matrixRange) {
+                        std::fprintf(stderr, "%s: offsets and matrix disagree\n", shape.name);
+                        failed = true;
+                }
+        }
+        return failed ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+#include "otpch.h"
+
+#include <chrono>
+#include <cstdio>
+
+// A great fireball hitting a crowd of 100 monsters while a few dozen players
+// watch from around it. Game::combatChangeHealth needs the players seeing
+// each target, once for the hit effect and text and once for the health
+// update. Before, every target scanned the map for them; now the area combat
+// scans once for the whole area and every target picks its spectators from
+// that list, the way Game::filterSpectatorsInInstance does. The map is a grid
+// of leaves of players like the quadtree leaves Map::getSpectatorsInternal
+// walks, the fight happens on the ground floor and some players watch from
+// the floors above.
+
+namespace {
+
+constexpr int32_t FLOOR_SIZE = 8;
+constexpr int32_t MAP_SIZE = 256;
+constexpr int32_t LEAVES = MAP_SIZE / FLOOR_SIZE;
+constexpr int32_t VIEWPORT_X = 11;
+constexpr int32_t VIEWPORT_Y = 11;
+constexpr int32_t AREA_RADIUS = 6;
+constexpr int MONSTERS = 100;
+constexpr int PLAYERS = 40;
+constexpr int CASTS = 20000;
+
+constexpr int32_t GROUND_FLOOR = 7;
+// the floors a multifloor lookup on the ground floor looks at
+constexpr int32_t MIN_FLOOR = 0;
+constexpr int32_t MAX_FLOOR = 9;
+
+struct FakePlayer {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        uint32_t id;
+};
+
+// both bounds of Map::getSpectatorsInternal: the floor and the range shifted by the floor offset
+bool isInRange(int32_t centerX, int32_t centerY, int32_t rangeX, int32_t rangeY, const FakePlayer& player) {
+        if (player.z < MIN_FLOOR || player.z > MAX_FLOOR) {
+                return false;
+        }
+
+        const int32_t offsetZ = GROUND_FLOOR - player.z;
+        return player.x >= centerX - rangeX + offsetZ && player.x <= centerX + rangeX + offsetZ
+               && player.y >= centerY - rangeY + offsetZ && player.y <= centerY + rangeY + offsetZ;
+}
+
+struct FakeMap {
+        std::vector<FakePlayer> players;
+        std::vector<std::vector<const FakePlayer*>> leaves{LEAVES * LEAVES};
+
+        void index() {
+                for (const FakePlayer& player : players) {
+                        leaves[(player.y / FLOOR_SIZE) * LEAVES + player.x / FLOOR_SIZE].push_back(&player);
+                }
+        }
+
+        // Map::getSpectatorsInternal, the leaves cover every floor
+        void getSpectators(std::vector<const FakePlayer*>& spectators, int32_t centerX, int32_t centerY, int32_t rangeX, int32_t rangeY) {
+                const int32_t minX = std::max(0, centerX - rangeX + GROUND_FLOOR - MAX_FLOOR);
+                const int32_t maxX = std::min(MAP_SIZE - 1, centerX + rangeX + GROUND_FLOOR - MIN_FLOOR);
+                const int32_t minY = std::max(0, centerY - rangeY + GROUND_FLOOR - MAX_FLOOR);
+                const int32_t maxY = std::min(MAP_SIZE - 1, centerY + rangeY + GROUND_FLOOR - MIN_FLOOR);
+                for (int32_t leafY = minY / FLOOR_SIZE; leafY <= maxY / FLOOR_SIZE; ++leafY) {
+                        for (int32_t leafX = minX / FLOOR_SIZE; leafX <= maxX / FLOOR_SIZE; ++leafX) {
+                                for (const FakePlayer* player : leaves[leafY * LEAVES + leafX]) {
+                                        if (isInRange(centerX, centerY, rangeX, rangeY, *player)) {
+                                                spectators.push_back(player);
+                                        }
+                                }
+                        }
+                }
+        }
+};
+
+// Map::isInSpectatorRange
+bool isInSpectatorRange(int32_t centerX, int32_t centerY, const FakePlayer& player) {
+        return isInRange(centerX, centerY, VIEWPORT_X, VIEWPORT_Y, player);
+}
+
+struct Target {
+        int32_t x;
+        int32_t y;
+};
+
+struct Result {
+        double ms = 0;
+        uint64_t scans = 0;
+        uint64_t packets = 0;
+        uint64_t checksum = 0;
+};
+
+// what combatChangeHealth sends to each spectator of a hit target
+void sendHit(Result& result, const std::vector<const FakePlayer*>& spectators, const Target& target) {
+        for (const FakePlayer* spectator : spectators) {
+                // hit effect, damage text and health
+                result.packets += 3;
+                result.checksum += spectator->id * 31 + target.x * 7 + target.y;
+        }
+}
+
+Result runPerTarget(FakeMap& map, const std::vector<Target>& targets, int32_t centerX, int32_t centerY) {
+        Result result;
+        auto start = std::chrono::steady_clock::now();
+        for (int cast = 0; cast < CASTS; ++cast) {
+                std::vector<const FakePlayer*> areaSpectators;
+                areaSpectators.reserve(32);
+                map.getSpectators(areaSpectators, centerX, centerY, AREA_RADIUS + VIEWPORT_X, AREA_RADIUS + VIEWPORT_Y);
+                ++result.scans;
+
+                for (const Target& target : targets) {
+                        std::vector<const FakePlayer*> spectators;
+                        spectators.reserve(32);
+                        map.getSpectators(spectators, target.x, target.y, VIEWPORT_X, VIEWPORT_Y);
+                        ++result.scans;
+                        sendHit(result, spectators, target);
+                }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+Result runAreaPass(FakeMap& map, const std::vector<Target>& targets, int32_t centerX, int32_t centerY) {
+        Result result;
+        auto start = std::chrono::steady_clock::now();
+        for (int cast = 0; cast < CASTS; ++cast) {
+                std::vector<const FakePlayer*> areaSpectators;
+                areaSpectators.reserve(32);
+                map.getSpectators(areaSpectators, centerX, centerY, AREA_RADIUS + VIEWPORT_X, AREA_RADIUS + VIEWPORT_Y);
+                ++result.scans;
+
+                for (const Target& target : targets) {
+                        std::vector<const FakePlayer*> spectators;
+                        spectators.reserve(32);
+                        for (const FakePlayer* spectator : areaSpectators) {
+                                if (isInSpectatorRange(target.x, target.y, *spectator)) {
+                                        spectators.push_back(spectator);
+                                }
+                        }
+                        sendHit(result, spectators, target);
+                }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+void report(const char* name, const Result& result) {
+        std::printf("%-11s %8.2f ms for %d casts %8.2f us/cast %4llu map scans/cast %6llu packets/cast\n", name, result.ms,
+                    CASTS, result.ms * 1000 / CASTS, static_cast<unsigned long long>(result.scans / CASTS),
+                    static_cast<unsigned long long>(result.packets / CASTS));
+}
+
+} // namespace
+
+int main() {
+        const int32_t centerX = MAP_SIZE / 2;
+        const int32_t centerY = MAP_SIZE / 2;
+
+        std::mt19937 rng{5};
+        FakeMap map;
+        // the players stand around the crowd, some of them out of sight of the far side of it
+        std::uniform_int_distribution<int32_t> around(-20, 20);
+        std::uniform_int_distribution<int32_t> percent(0, 99);
+        for (int i = 0; i < PLAYERS; ++i) {
+                const int32_t z = percent(rng) < 75 ? GROUND_FLOOR : GROUND_FLOOR - 1 - percent(rng) % 3;
+                map.players.push_back({centerX + around(rng), centerY + around(rng), z, static_cast<uint32_t>(i + 1)});
+        }
+        map.index();
+
+        // 100 monsters on the cells of the circle of radius 6
+        std::vector<Target> targets;
+        for (int32_t y = -AREA_RADIUS; y <= AREA_RADIUS && targets.size() < MONSTERS; ++y) {
+                for (int32_t x = -AREA_RADIUS; x <= AREA_RADIUS && targets.size() < MONSTERS; ++x) {
+                        if (x * x + y * y <= AREA_RADIUS * AREA_RADIUS + 1) {
+                                targets.push_back({centerX + x, centerY + y});
+                        }
+                }
+        }
+
+        Result perTarget = runPerTarget(map, targets, centerX, centerY);
+        Result areaPass = runAreaPass(map, targets, centerX, centerY);
+
+        std::printf("%zu targets, %d players around\n", targets.size(), PLAYERS);
+        report("per target", perTarget);
+        report("area pass", areaPass);
+
+        if (perTarget.packets != areaPass.packets || perTarget.checksum != areaPass.checksum) {
+                std::fprintf(stderr, "both must reach the same spectators\n");
+                return 1;
+        }
+        return 0;
+}
@@ -0,0 +1,139 @@
+#include "otpch.h"
+
+#include "game/game.h"
+#include "player.h"
+
+#include <cstdio>
+
+// Area combat lists the players around the whole area once and
+// Game::combatChangeHealth filters that list down to each target with
+// Map::isInSpectatorRange instead of scanning the map again. The filter only
+// holds if Map::isInSpectatorRange keeps the floors and the bounds, shifted by
+// the floor offset, of Map::getSpectators: on every floor, single and
+// multifloor, both must pick the same players, and filtering the area list of
+// Combat::doAreaCombat must give what a fresh scan gives for every target.
+
+extern Game g_game;
+
+namespace {
+
+constexpr uint16_t CENTER_X = 1000;
+constexpr uint16_t CENTER_Y = 1000;
+// an area target plus the viewport plus the largest floor offset, and a margin
+constexpr int32_t SPREAD = 3 + Map::maxViewportX + 9 + 3;
+constexpr int32_t AREA_RADIUS = 3;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+		if (!condition) {
+				std::fprintf(stderr, "%s\n", message);
+				++failures;
+		}
+}
+
+std::vector<Creature*> sorted(const SpectatorVec& spectators) {
+		std::vector<Creature*> creatures(spectators.begin(), spectators.end());
+		std::sort(creatures.begin(), creatures.end());
+		return creatures;
+}
+
+void place(std::vector<Player*>& players, int32_t dx, int32_t dy, uint8_t z) {
+		const Position pos(CENTER_X + dx, CENTER_Y + dy, z);
+		if (!g_game.map.getTile(pos)) {
+				g_game.map.setTile(pos, new DynamicTile(pos.x, pos.y, pos.z));
+		}
+
+		Player* player = new Player(nullptr);
+		player->incrementReferenceCounter();
+		if (!g_game.map.placeCreature(pos, player, false, true)) {
+				check(false, "unable to place a player");
+				return;
+		}
+		players.push_back(player);
+}
+
+// every floor, with each bound crossed along both axes and the diagonals
+void populate(std::vector<Player*>& players) {
+		for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+				for (int32_t d = -SPREAD; d <= SPREAD; ++d) {
+						for (int32_t across : {-7, 0, 4}) {
+								place(players, d, across, z);
+								place(players, across, d, z);
+						}
+						place(players, d, d, z);
+						place(players, d, -d, z);
+				}
+		}
+}
+
+void testRange(const std::vector<Player*>& players) {
+		for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+				for (const Position& centerPos : {Position(CENTER_X, CENTER_Y, z), Position(CENTER_X + 2, CENTER_Y - 3, z)}) {
+						for (bool multifloor : {false, true}) {
+								SpectatorVec spectators;
+								g_game.map.getSpectators(spectators, centerPos, multifloor, true);
+
+								SpectatorVec inRange;
+								for (Player* player : players) {
+										if (Map::isInSpectatorRange(centerPos, player->getPosition(), multifloor)) {
+												inRange.emplace_back(player);
+										}
+								}
+
+								check(sorted(spectators) == sorted(inRange),
+									  "isInSpectatorRange must pick the players getSpectators finds");
+						}
+				}
+		}
+}
+
+void testAreaFilter() {
+		for (uint8_t z : {0, 4, 6, 7, 8, 9, 12, 15}) {
+				const Position position(CENTER_X, CENTER_Y, z);
+
+				// Combat::doAreaCombat
+				const int32_t rangeX = AREA_RADIUS + Map::maxViewportX;
+				const int32_t rangeY = AREA_RADIUS + Map::maxViewportY;
+				SpectatorVec areaSpectators;
+				g_game.map.getSpectators(areaSpectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
+
+				for (int32_t dy = -AREA_RADIUS; dy <= AREA_RADIUS; ++dy) {
+						for (int32_t dx = -AREA_RADIUS; dx <= AREA_RADIUS; ++dx) {
+								const Position targetPos(position.x + dx, position.y + dy, z);
+								Tile* tile = g_game.map.getTile(targetPos);
+								if (!tile || !tile->getTopCreature()) {
+										continue;
+								}
+
+								const InstanceId instanceId = tile->getTopCreature()->getInstanceId();
+								for (bool multifloor : {false, true}) {
+										SpectatorVec filtered;
+										Game::filterSpectatorsInInstance(filtered, areaSpectators, targetPos, instanceId, multifloor, true);
+
+										SpectatorVec fresh;
+										g_game.map.getSpectators(fresh, targetPos, multifloor, true);
+
+										check(sorted(filtered) == sorted(fresh),
+											  "the filtered area list must equal a fresh scan around the target");
+								}
+						}
+				}
+		}
+}
+
+} // namespace
+
+int main() {
+		if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+				std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+				return 1;
+		}
+
+		std::vector<Player*> players;
+		populate(players);
+
+		testRange(players);
+		testAreaFilter();
+		return failures == 0 ? 0 : 1;
+}
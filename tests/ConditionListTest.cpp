@@ -0,0 +1,132 @@
+#include "otpch.h"
+#include "enums.h"
+
+#include <cstdio>
+
+// The invariants Creature::executeConditions relies on: conditions erased
+// during a walk are not visited afterwards and the list is compacted once the
+// walk ends, conditions added during a walk wait for the next one, iterators
+// skip erased entries and meet a saved end(), and the type mask follows every
+// change.
+
+// ConditionList only needs getType from a condition, so a light stand-in
+// replaces condition.h and the test does not pull in the game.
+#define FS_CONDITION_H
+class Condition {
+        public:
+                explicit Condition(ConditionType_t type) : type(type) {}
+
+                ConditionType_t getType() const {
+                        return type;
+                }
+
+                int visits = 0;
+
+        private:
+                ConditionType_t type;
+};
+#include "conditionlist.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+        if (!condition) {
+                std::fprintf(stderr, "%s\n", message);
+                ++failures;
+        }
+}
+
+void testEraseDuringWalk() {
+        std::vector<Condition> conditions;
+        for (int i = 0; i < 8; ++i) {
+                conditions.emplace_back(i % 2 == 0 ? CONDITION_POISON : CONDITION_FIRE);
+        }
+
+        ConditionList list;
+        for (Condition& condition : conditions) {
+                list.push_back(&condition);
+        }
+
+        // each condition erases the one after it, and the first also the last
+        list.walk([&](Condition* condition) {
+                ++condition->visits;
+                const size_t index = condition - conditions.data();
+                if (index % 2 == 0 && index + 1 < conditions.size()) {
+                        list.remove(&conditions[index + 1]);
+                }
+                if (index == 0) {
+                        list.remove(&conditions.back());
+                }
+        });
+
+        for (size_t i = 0; i < conditions.size(); ++i) {
+                check(conditions[i].visits == (i % 2 == 0 ? 1 : 0), "erased conditions must not be visited afterwards");
+        }
+        check(list.size() == conditions.size() / 2, "size must drop by the erased conditions");
+        check(list.hasType(CONDITION_POISON), "the mask must keep the remaining types");
+        check(!list.hasType(CONDITION_FIRE), "the mask must drop the erased types");
+
+        size_t remaining = 0;
+        for (Condition* condition : list) {
+                check(condition && condition->getType() == CONDITION_POISON, "iteration must only see the remaining conditions");
+                ++remaining;
+        }
+        check(remaining == list.size(), "iteration must see every remaining condition");
+}
+
+void testAddDuringWalk() {
+        Condition first{CONDITION_POISON};
+        Condition added{CONDITION_BLEEDING};
+
+        ConditionList list;
+        list.push_back(&first);
+        list.walk([&](Condition* condition) {
+                ++condition->visits;
+                if (condition == &first) {
+                        list.push_back(&added);
+                }
+        });
+
+        check(first.visits == 1 && added.visits == 0, "a condition added during a walk must wait for the next one");
+        check(list.size() == 2 && list.hasType(CONDITION_BLEEDING), "a condition added during a walk must be kept");
+
+        list.walk([](Condition* condition) { ++condition->visits; });
+        check(first.visits == 2 && added.visits == 1, "the next walk must visit every condition");
+}
+
+void testEraseWithSavedEnd() {
+        std::vector<Condition> conditions(5, Condition{CONDITION_ENERGY});
+
+        ConditionList list;
+        for (Condition& condition : conditions) {
+                list.push_back(&condition);
+        }
+
+        // the loop of Creature::removeCondition, with end() saved up front
+        size_t erased = 0;
+        list.walk([&](Condition*) {
+                if (erased != 0) {
+                        return;
+                }
+
+                for (auto it = list.begin(), end = list.end(); it != end;) {
+                        it = list.erase(it);
+                        ++erased;
+                }
+        });
+
+        check(erased == conditions.size(), "a loop with a saved end() must erase every condition");
+        check(list.empty() && !list.hasType(CONDITION_ENERGY), "the list must be empty");
+        check(list.begin() == list.end(), "an empty list must have begin() equal to end()");
+}
+
+} // namespace
+
+int main() {
+        testEraseDuringWalk();
+        testAddDuringWalk();
+        testEraseWithSavedEnd();
+        return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+#include "otpch.h"
+#include "enums.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Thousands of poisoned or burning monsters, as after a few area runes on a
+// crowded spawn. Every check cycle each monster executes its conditions and
+// looks up a couple of condition types, the way Game::checkCreatures and the
+// monster think do. The same cycles run once through the former std::list
+// storage and once through ConditionList, counting the allocations made by
+// the cycles themselves.
+
+// ConditionList only needs getType from a condition, so a light stand-in
+// replaces condition.h and the benchmark does not pull in the game.
+#define FS_CONDITION_H
+class Condition {
+        public:
+                Condition(ConditionType_t type, int32_t ticks) : type(type), ticks(ticks) {}
+
+                ConditionType_t getType() const {
+                        return type;
+                }
+
+                bool executeCondition(uint64_t& damage) {
+                        damage += 10;
+                        return --ticks > 0;
+                }
+
+        private:
+                ConditionType_t type;
+                int32_t ticks;
+};
+#include "conditionlist.h"
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+        ++allocations;
+        if (void* p = std::malloc(size)) {
+                return p;
+        }
+        throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+        std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+        std::free(p);
+}
+
+namespace {
+
+constexpr int MONSTERS = 5000;
+constexpr int CYCLES = 200;
+// a condition outlives the benchmark unless it is one of the short ones
+constexpr int32_t LONG_TICKS = CYCLES * 2;
+constexpr int32_t SHORT_TICKS = CYCLES / 4;
+
+struct ListMonster {
+        std::list<Condition*> conditions;
+        uint64_t damage = 0;
+
+        // Creature::executeConditions before ConditionList
+        void executeConditions() {
+                std::list<Condition*> tempConditions{conditions};
+                for (Condition* condition : tempConditions) {
+                        auto it = std::find(conditions.begin(), conditions.end(), condition);
+                        if (it == conditions.end()) {
+                                continue;
+                        }
+
+                        if (!condition->executeCondition(damage)) {
+                                it = std::find(conditions.begin(), conditions.end(), condition);
+                                if (it != conditions.end()) {
+                                        conditions.erase(it);
+                                        delete condition;
+                                }
+                        }
+                }
+        }
+
+        bool hasCondition(ConditionType_t type) const {
+                return std::find_if(conditions.begin(), conditions.end(), [type](const Condition* condition) {
+                        return condition->getType() == type;
+                }) != conditions.end();
+        }
+
+        ~ListMonster() {
+                for (Condition* condition : conditions) {
+                        delete condition;
+                }
+        }
+};
+
+struct VectorMonster {
+        ConditionList conditions;
+        uint64_t damage = 0;
+
+        void executeConditions() {
+                conditions.walk([this](Condition* condition) {
+                        if (!condition->executeCondition(damage) && conditions.remove(condition)) {
+                                delete condition;
+                        }
+                });
+        }
+
+        bool hasCondition(ConditionType_t type) const {
+                if (!conditions.hasType(type)) {
+                        return false;
+                }
+                return std::find_if(conditions.begin(), conditions.end(), [type](const Condition* condition) {
+                        return condition->getType() == type;
+                }) != conditions.end();
+        }
+
+        ~VectorMonster() {
+                for (Condition* condition : conditions) {
+                        delete condition;
+                }
+        }
+};
+
+struct Result {
+        double ms;
+        uint64_t allocations;
+        uint64_t damage;
+        uint64_t lookups;
+};
+
+template <typename Monster>
+Result run() {
+        std::vector<Monster> monsters(MONSTERS);
+        for (int i = 0; i < MONSTERS; ++i) {
+                Monster& monster = monsters[i];
+                // everyone is poisoned, every other one burns, every fifth one also has a short energy condition
+                monster.conditions.push_back(new Condition(CONDITION_POISON, LONG_TICKS));
+                if (i % 2 == 0) {
+                        monster.conditions.push_back(new Condition(CONDITION_FIRE, LONG_TICKS));
+                }
+                if (i % 5 == 0) {
+                        monster.conditions.push_back(new Condition(CONDITION_ENERGY, SHORT_TICKS));
+                }
+        }
+
+        uint64_t lookups = 0;
+        const uint64_t allocationsBefore = allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; ++cycle) {
+                for (Monster& monster : monsters) {
+                        monster.executeConditions();
+                        // Creature::isInvisible and the paralyze check of the walk
+                        lookups += monster.hasCondition(CONDITION_INVISIBLE);
+                        lookups += monster.hasCondition(CONDITION_PARALYZE);
+                        lookups += monster.hasCondition(CONDITION_FIRE);
+                }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Result result{ms, allocations - allocationsBefore, 0, lookups};
+        for (const Monster& monster : monsters) {
+                result.damage += monster.damage;
+        }
+        return result;
+}
+
+void report(const char* name, const Result& result) {
+        std::printf("%-14s %9.2f ms for %d cycles %8.3f ms/cycle %10llu allocations\n", name, result.ms, CYCLES,
+                    result.ms / CYCLES, static_cast<unsigned long long>(result.allocations));
+}
+
+} // namespace
+
+int main() {
+        Result list = run<ListMonster>();
+        Result vector = run<VectorMonster>();
+
+        report("std::list", list);
+        report("ConditionList", vector);
+
+        if (list.damage != vector.damage || list.lookups != vector.lookups) {
+                std::fprintf(stderr, "both storages must execute the same conditions\n");
+                return 1;
+        }
+        if (vector.allocations != 0) {
+                std::fprintf(stderr, "condition execution must not allocate\n");
+                return 1;
+        }
+        return 0;
+}
@@ -0,0 +1,227 @@
+#include "otpch.h"
+#include "tickregistry.h"
+
+#include <chrono>
+#include <cstdio>
+
+// 50k spawned monsters, most of them idle because no player is around. Every
+// cycle a few monsters wake up or fall asleep as players move. The same
+// minute of ticks runs once through the former per-bucket std::list with lazy
+// erase and once through the TickRegistry with its per-tick flags.
+
+namespace {
+
+constexpr int MONSTERS = 50000;
+constexpr size_t BUCKETS = 10;
+constexpr int CYCLES = 60;
+// per mille of the monsters that change their idle state each cycle
+constexpr int TOGGLES_PER_MILLE = 20;
+
+struct FakeMonster {
+        virtual ~FakeMonster() = default;
+
+        virtual void onThink() {
+                ++thinks;
+        }
+        virtual void onAttacking() {
+                if (!target) {
+                        return;
+                }
+                ++attacks;
+        }
+        void executeConditions() {
+                // like Creature::executeConditions, which iterates over a copy
+                std::list<int> tempConditions{conditions};
+                conditions.clear();
+                for (int ticks : tempConditions) {
+                        if (ticks > 1) {
+                                conditions.push_back(ticks - 1);
+                        }
+                }
+        }
+
+        TickHandle& getTickHandle() {
+                return tickHandle;
+        }
+
+        // the rest of a Creature, cold during ticks
+        char payload[640] = {};
+
+        TickHandle tickHandle;
+        std::list<int> conditions;
+        FakeMonster* target = nullptr;
+        uint64_t thinks = 0;
+        uint64_t attacks = 0;
+        size_t bucket = 0;
+        bool idle = true;
+        bool creatureCheck = false;
+        bool inCheckCreaturesVector = false;
+};
+
+using Registry = TickRegistry<FakeMonster, BUCKETS>;
+
+struct World {
+        std::vector<std::unique_ptr<FakeMonster>> monsters;
+        std::mt19937 rng{42};
+
+        World() {
+                monsters.reserve(MONSTERS);
+                for (int i = 0; i < MONSTERS; ++i) {
+                        monsters.push_back(std::make_unique<FakeMonster>());
+                        monsters.back()->bucket = i % BUCKETS;
+                }
+        }
+
+        // wakes up or puts to sleep random monsters, waking ones may get a target or a condition
+        template <typename Wake, typename Sleep>
+        void movePlayers(Wake wake, Sleep sleep) {
+                std::uniform_int_distribution<int> pick(0, MONSTERS - 1);
+                std::uniform_int_distribution<int> percent(0, 99);
+                for (int i = 0; i < MONSTERS * TOGGLES_PER_MILLE / 1000; ++i) {
+                        FakeMonster* monster = monsters[pick(rng)].get();
+                        if (monster->idle) {
+                                monster->idle = false;
+                                monster->target = percent(rng) < 30 ? monsters[pick(rng)].get() : nullptr;
+                                if (percent(rng) < 5) {
+                                        monster->conditions.assign(3, 5);
+                                }
+                                wake(monster);
+                        } else {
+                                monster->idle = true;
+                                monster->target = nullptr;
+                                sleep(monster);
+                        }
+                }
+        }
+
+        uint64_t totalThinks() const {
+                uint64_t total = 0;
+                for (const auto& monster : monsters) {
+                        total += monster->thinks + monster->attacks;
+                }
+                return total;
+        }
+};
+
+// Game::checkCreatures before the registry
+double runLists(World& world) {
+        std::list<FakeMonster*> checkCreatureLists[BUCKETS];
+        auto addCreatureCheck = [&](FakeMonster* monster) {
+                monster->creatureCheck = true;
+                if (monster->inCheckCreaturesVector) {
+                        return;
+                }
+                monster->inCheckCreaturesVector = true;
+                checkCreatureLists[monster->bucket].push_back(monster);
+        };
+        auto removeCreatureCheck = [](FakeMonster* monster) {
+                if (monster->inCheckCreaturesVector) {
+                        monster->creatureCheck = false;
+                }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; ++cycle) {
+                world.movePlayers(addCreatureCheck, removeCreatureCheck);
+                for (size_t index = 0; index < BUCKETS; ++index) {
+                        auto& checkCreatureList = checkCreatureLists[index];
+                        auto it = checkCreatureList.begin(), end = checkCreatureList.end();
+                        while (it != end) {
+                                FakeMonster* monster = *it;
+                                if (monster->creatureCheck) {
+                                        monster->onThink();
+                                        monster->onAttacking();
+                                        monster->executeConditions();
+                                        ++it;
+                                } else {
+                                        monster->inCheckCreaturesVector = false;
+                                        it = checkCreatureList.erase(it);
+                                }
+                        }
+                }
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Game::checkCreatures with the registry, idle monsters are swapped out of it
+double runRegistry(World& world) {
+        Registry registry{[](FakeMonster*) {}};
+        auto addCreatureCheck = [&](FakeMonster* monster) {
+                uint8_t flags = 0;
+                if (monster->target) {
+                        flags |= Registry::FLAG_HAS_TARGET;
+                }
+                if (!monster->conditions.empty()) {
+                        flags |= Registry::FLAG_HAS_CONDITIONS;
+                }
+                registry.add(monster, monster->bucket, flags);
+        };
+        auto removeCreatureCheck = [&](FakeMonster* monster) {
+                registry.remove(monster);
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; ++cycle) {
+                world.movePlayers(addCreatureCheck, removeCreatureCheck);
+                for (size_t index = 0; index < BUCKETS; ++index) {
+                        registry.tick(index, [&](FakeMonster* monster) {
+                                monster->onThink();
+                                if (registry.hasFlag(monster, Registry::FLAG_HAS_TARGET)) {
+                                        monster->onAttacking();
+                                        if (!monster->target) {
+                                                registry.setFlag(monster, Registry::FLAG_HAS_TARGET, false);
+                                        }
+                                }
+                                if (registry.hasFlag(monster, Registry::FLAG_HAS_CONDITIONS)) {
+                                        monster->executeConditions();
+                                        if (monster->conditions.empty()) {
+                                                registry.setFlag(monster, Registry::FLAG_HAS_CONDITIONS, false);
+                                        }
+                                }
+                        });
+                }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // removal sanity checks: swap-remove keeps the handles consistent, removal during a tick is deferred
+        FakeMonster* first = world.monsters[0].get();
+        FakeMonster* second = world.monsters[BUCKETS].get();
+        registry.add(first, first->bucket, 0);
+        registry.add(second, second->bucket, 0);
+        size_t before = registry.size();
+        registry.tick(first->bucket, [&](FakeMonster* monster) {
+                if (monster == first) {
+                        registry.remove(first);
+                }
+        });
+        registry.remove(second);
+        if (registry.size() != before - 2 || first->tickHandle.index != TickHandle::NONE || second->tickHandle.index != TickHandle::NONE) {
+                std::fprintf(stderr, "registry removal failed\n");
+                std::exit(1);
+        }
+        return ms;
+}
+
+void report(const char* name, double ms, uint64_t work) {
+        std::printf("%-10s %10.2f ms for %d cycles %8.3f ms/cycle %12llu thinks+attacks\n", name, ms, CYCLES, ms / CYCLES,
+                    static_cast<unsigned long long>(work));
+}
+
+} // namespace
+
+int main() {
+        World lists;
+        double listsMs = runLists(lists);
+
+        World registry;
+        double registryMs = runRegistry(registry);
+
+        report("lists", listsMs, lists.totalThinks());
+        report("registry", registryMs, registry.totalThinks());
+
+        if (lists.totalThinks() != registry.totalThinks()) {
+                std::fprintf(stderr, "both engines must tick the same monsters\n");
+                return 1;
+        }
+        return 0;
+}
@@ -0,0 +1,187 @@
+#include "otpch.h"
+#include "timingwheel.h"
+
+#include <chrono>
+#include <cstdio>
+
+// A busy map: corpses, fields and burning items decaying at the same time.
+// Every expired item is replaced by a fresh one, as corpses turn into
+// remains and new monsters die. The same five minutes of game time run once
+// through the former four std::list buckets of Game::checkDecay and once
+// through the TimingWheel, counting how often an item is touched.
+
+namespace {
+
+constexpr int ITEMS = 100000;
+constexpr int64_t INTERVAL = 250;
+constexpr int BUCKETS = 4;
+constexpr int64_t SIMULATED_MS = 5 * 60 * 1000;
+
+struct FakeItem {
+        TimerHandle& getTimerHandle() {
+                return timerHandle;
+        }
+
+        TimerHandle timerHandle;
+        int64_t expiry = 0;
+        int32_t duration = 0;
+};
+
+struct Result {
+        double ms = 0;
+        uint64_t touches = 0;
+        uint64_t expired = 0;
+        int64_t maxLateness = 0;
+};
+
+// fields last seconds, corpses minutes
+int32_t randomDuration(std::mt19937& rng) {
+        std::uniform_int_distribution<int> percent(0, 99);
+        if (percent(rng) < 40) {
+                return std::uniform_int_distribution<int32_t>(2000, 30000)(rng);
+        }
+        return std::uniform_int_distribution<int32_t>(60000, 600000)(rng);
+}
+
+// Game::checkDecay before the timing wheel
+Result runLists() {
+        std::mt19937 rng{7};
+        std::vector<FakeItem> items(ITEMS);
+        std::list<FakeItem*> decayItems[BUCKETS];
+        size_t lastBucket = 0;
+
+        auto add = [&](FakeItem* item) {
+                const int32_t dur = item->duration;
+                if (dur >= INTERVAL * BUCKETS) {
+                        decayItems[lastBucket].push_back(item);
+                } else {
+                        decayItems[(lastBucket + 1 + dur / 1000) % BUCKETS].push_back(item);
+                }
+        };
+
+        for (FakeItem& item : items) {
+                item.duration = randomDuration(rng);
+                add(&item);
+        }
+
+        Result result;
+        std::vector<FakeItem*> toDecayItems;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t now = INTERVAL; now <= SIMULATED_MS; now += INTERVAL) {
+                size_t bucket = (lastBucket + 1) % BUCKETS;
+                auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
+                while (it != end) {
+                        FakeItem* item = *it;
+                        ++result.touches;
+
+                        int32_t duration = item->duration;
+                        int32_t decreaseTime = std::min<int32_t>(INTERVAL * BUCKETS, duration);
+                        duration -= decreaseTime;
+                        item->duration = duration;
+
+                        if (duration <= 0) {
+                                it = decayItems[bucket].erase(it);
+                                toDecayItems.push_back(item);
+                        } else if (duration < INTERVAL * BUCKETS) {
+                                it = decayItems[bucket].erase(it);
+                                size_t newBucket = (bucket + ((duration + INTERVAL / 2) / 1000)) % BUCKETS;
+                                if (newBucket == bucket) {
+                                        toDecayItems.push_back(item);
+                                } else {
+                                        decayItems[newBucket].push_back(item);
+                                }
+                        } else {
+                                ++it;
+                        }
+                }
+                lastBucket = bucket;
+
+                // Game::cleanup
+                for (FakeItem* item : toDecayItems) {
+                        ++result.expired;
+                        item->duration = randomDuration(rng);
+                        add(item);
+                }
+                toDecayItems.clear();
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+Result runWheel() {
+        std::mt19937 rng{7};
+        std::vector<FakeItem> items(ITEMS);
+        TimingWheel<FakeItem> wheel{INTERVAL, 0};
+
+        for (FakeItem& item : items) {
+                item.expiry = randomDuration(rng);
+                wheel.schedule(&item, item.expiry);
+        }
+
+        Result result;
+        std::vector<FakeItem*> toDecayItems;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t now = INTERVAL; now <= SIMULATED_MS; now += INTERVAL) {
+                wheel.advance(now, [&](FakeItem* item) {
+                        ++result.touches;
+                        if (item->expiry > now) {
+                                std::fprintf(stderr, "item expired %lld ms early\n", static_cast<long long>(item->expiry - now));
+                                std::exit(1);
+                        }
+                        result.maxLateness = std::max(result.maxLateness, now - item->expiry);
+                        toDecayItems.push_back(item);
+                });
+
+                for (FakeItem* item : toDecayItems) {
+                        ++result.expired;
+                        item->expiry = now + randomDuration(rng);
+                        wheel.schedule(item, item->expiry);
+                }
+                toDecayItems.clear();
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (wheel.size() != ITEMS) {
+                std::fprintf(stderr, "the wheel lost items\n");
+                std::exit(1);
+        }
+
+        // unscheduling keeps the handles of the other items in the slot consistent
+        FakeItem& first = items[0];
+        FakeItem& second = items[1];
+        wheel.schedule(&first, SIMULATED_MS + 5000);
+        wheel.schedule(&second, SIMULATED_MS + 5000);
+        wheel.unschedule(&first);
+        bool secondExpired = false;
+        wheel.advance(SIMULATED_MS + 5000, [&](FakeItem* item) {
+                secondExpired = secondExpired || item == &second;
+        });
+        if (first.timerHandle.isScheduled() || !secondExpired) {
+                std::fprintf(stderr, "unschedule failed\n");
+                std::exit(1);
+        }
+        return result;
+}
+
+void report(const char* name, const Result& result) {
+        std::printf("%-8s %9.2f ms for %lld s of decay %12llu item touches %9llu expired\n", name, result.ms,
+                    static_cast<long long>(SIMULATED_MS / 1000), static_cast<unsigned long long>(result.touches),
+                    static_cast<unsigned long long>(result.expired));
+}
+
+} // namespace
+
+int main() {
+        Result lists = runLists();
+        Result wheel = runWheel();
+
+        report("lists", lists);
+        report("wheel", wheel);
+        std::printf("wheel expires at most %lld ms late\n", static_cast<long long>(wheel.maxLateness));
+
+        if (wheel.maxLateness >= INTERVAL) {
+                std::fprintf(stderr, "items must expire within one interval\n");
+                return 1;
+        }
+        return 0;
+}
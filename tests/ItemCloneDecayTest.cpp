@@ -0,0 +1,179 @@
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "container.h"
+#include "game/game.h"
+#include "movement.h"
+#include "tickbudget.h"
+
+#include <cstdio>
+#include <thread>
+
+// Splitting a stack, item:clone() and item:split() all copy an item through
+// Item::clone. While an item decays its duration attribute holds the duration
+// it was scheduled with, so a copy made halfway through the decay must start
+// from the time left, not from the full duration, and so must the items of a
+// copied container.
+// Under critical load the decay that came due beyond the budget of a pass waits
+// in a queue; stopping, a new duration and a copy must all see such an item
+// right, and the queue must drain once the load drops.
+
+extern Game g_game;
+extern MoveEvents* g_moveEvents;
+
+namespace {
+
+constexpr uint16_t LIT_TORCH = 2051;
+constexpr uint16_t BACKPACK = 1988;
+constexpr uint16_t GRASS = 4526;
+constexpr uint16_t BASE = 1000;
+constexpr int32_t DURATION = 2000;
+// slack for the time between reading the duration and cloning, and the clock
+constexpr int32_t TOLERANCE = 100;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+void checkRemaining(const Item* copy, uint32_t remaining, const char* message) {
+	const int64_t difference = static_cast<int64_t>(copy->getDuration()) - static_cast<int64_t>(remaining);
+	check(std::abs(difference) <= TOLERANCE, message);
+}
+
+Tile* makeTile(const Position& pos) {
+	Tile* tile = new DynamicTile(pos.x, pos.y, pos.z);
+	tile->internalAddThing(Item::CreateItem(GRASS));
+	g_game.map.setTile(pos, tile);
+	return tile;
+}
+
+void testClone() {
+	// only items that lie somewhere decay
+	Tile* tile = makeTile(Position(BASE, BASE, 7));
+	Item* torch = Item::CreateItem(LIT_TORCH);
+	tile->internalAddThing(torch);
+	Container* backpack = Item::CreateItem(BACKPACK)->getContainer();
+	tile->internalAddThing(backpack);
+	Item* packedTorch = Item::CreateItem(LIT_TORCH);
+	backpack->internalAddThing(packedTorch);
+
+	// schedule both, then let half of the decay pass
+	for (Item* item : {torch, packedTorch}) {
+		g_game.startDecay(item);
+	}
+	g_game.cleanup();
+	for (Item* item : {torch, packedTorch}) {
+		g_game.setItemDuration(item, DURATION);
+		check(item->isDecayScheduled(), "the item must be decaying");
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(DURATION / 2));
+
+	const uint32_t remaining = torch->getDuration();
+	check(remaining <= DURATION / 2 + TOLERANCE, "half of the decay must have passed");
+
+	Item* half = torch->clone();
+	checkRemaining(half, remaining, "a copy must keep the time left of the decay");
+	check(half->getDecaying() == DECAYING_TRUE, "a copy of a decaying item must decay");
+
+	Container* backpackCopy = backpack->clone()->getContainer();
+	check(backpackCopy && backpackCopy->size() == 1, "a copied container must hold a copy of its items");
+	if (backpackCopy && backpackCopy->size() == 1) {
+		checkRemaining(backpackCopy->getItemByIndex(0), packedTorch->getDuration(),
+		"the items of a copied container must keep the time left of their decay");
+	}
+
+	// a copy of an item that is not decaying keeps its duration as is
+	Item* stopped = Item::CreateItem(LIT_TORCH);
+	stopped->setDuration(DURATION / 4);
+	Item* stoppedCopy = stopped->clone();
+	check(stoppedCopy->getDuration() == DURATION / 4, "a copy of an item that is not decaying must keep its duration");
+}
+
+void setLoad(LoadLevel_t level) {
+	const int64_t lag = level == LOAD_CRITICAL ? 10000 : 0;
+	while (g_tickBudget.getLoadLevel() != level) {
+		g_tickBudget.addTaskLag(lag);
+		g_tickBudget.update();
+	}
+}
+
+size_t countDecayed(const std::vector<Item*>& items) {
+	return std::count_if(items.begin(), items.end(), [](const Item* item) { return item->getID() != LIT_TORCH; });
+}
+
+void testQueue() {
+	Tile* tile = makeTile(Position(BASE, BASE + 10, 7));
+
+	// four more torches come due than a degraded pass decays
+	std::vector<Item*> torches;
+	for (size_t i = 0; i < TickBudget::DECAY_BUDGET + 4; ++i) {
+		Item* torch = Item::CreateItem(LIT_TORCH);
+		tile->internalAddThing(torch);
+		g_game.startDecay(torch);
+		torches.push_back(torch);
+	}
+	g_game.cleanup();
+	for (Item* torch : torches) {
+		g_game.setItemDuration(torch, 1);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_DECAYINTERVAL * 2));
+
+	setLoad(LOAD_CRITICAL);
+	g_game.checkDecay();
+	check(countDecayed(torches) == TickBudget::DECAY_BUDGET, "a degraded pass must decay its budget only");
+
+	std::vector<Item*> queued;
+	for (Item* torch : torches) {
+		if (torch->getID() == LIT_TORCH) {
+			check(torch->isDecayQueued() && torch->isDecayScheduled(), "the items beyond the budget must wait in the queue");
+			queued.push_back(torch);
+		}
+	}
+	if (queued.size() != 4) {
+		return;
+	}
+
+	g_game.stopDecay(queued[0]);
+	check(!queued[0]->isDecayQueued() && !queued[0]->isDecayScheduled(), "a stopped item must leave the queue");
+
+	g_game.setItemDuration(queued[1], DURATION);
+	check(!queued[1]->isDecayQueued() && queued[1]->isDecayScheduled(), "an item given a new duration must go back to the wheel");
+	checkRemaining(queued[1], DURATION, "an item given a new duration must decay after it");
+
+	Item* copy = queued[2]->clone();
+	g_game.cleanup();
+	check(!copy->isDecayQueued() && copy->isDecayScheduled(), "a copy of a queued item must be scheduled, not queued");
+	check(copy->getDuration() <= EVENT_DECAYINTERVAL, "a copy of a queued item must decay in the next pass");
+
+	// the queue drains in the first pass after the load dropped
+	setLoad(LOAD_NORMAL);
+	g_game.checkDecay();
+	check(queued[0]->getID() == LIT_TORCH, "a stopped item must not decay");
+	check(queued[1]->getID() == LIT_TORCH && queued[1]->isDecayScheduled(), "an item given a new duration must not decay early");
+	check(queued[2]->getID() != LIT_TORCH && queued[3]->getID() != LIT_TORCH, "the queue must drain once the load drops");
+	check(!queued[3]->isDecayQueued(), "a drained item must leave the queue");
+}
+
+} // namespace
+
+int main() {
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+		return 1;
+	}
+
+	// a decay on a tile runs the remove item events, none are registered
+	g_moveEvents = new MoveEvents();
+
+	ConfigManager::setNumber(ConfigManager::LOAD_LAG_HIGH, 100);
+	ConfigManager::setNumber(ConfigManager::LOAD_LAG_CRITICAL, 400);
+
+	testClone();
+	testQueue();
+	return failures == 0 ? 0 : 1;
+}
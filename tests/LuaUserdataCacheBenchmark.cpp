@@ -0,0 +1,163 @@
+#include "otpch.h"
+#include "scripting/LuaUserdataCache.h"
+
+#include <chrono>
+#include <cstdio>
+
+// Scripted combat scenario: every round each creature hits a random other one
+// and both are pushed to an onHealthChange handler. The same rounds are run once
+// allocating a fresh userdata per push and once through the userdata cache.
+
+namespace {
+
+struct FakeCreature {
+	int32_t health = 1000;
+};
+
+struct AllocStats {
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+};
+
+void* countingAlloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+	if (nsize == 0) {
+		std::free(ptr);
+		return nullptr;
+	}
+
+	auto stats = static_cast<AllocStats*>(ud);
+	if (!ptr || nsize > osize) {
+		++stats->allocations;
+		stats->bytes += nsize;
+	}
+	return std::realloc(ptr, nsize);
+}
+
+int creatureGetHealth(lua_State* L) {
+	auto creature = *static_cast<FakeCreature**>(lua_touserdata(L, 1));
+	if (!creature) {
+		lua_pushnil(L);
+	} else {
+		lua_pushnumber(L, creature->health);
+	}
+	return 1;
+}
+
+constexpr const char* COMBAT_SCRIPT = R"(
+function onHealthChange(creature, attacker, damage)
+	if creature:getHealth() > damage and attacker:getHealth() > 0 then
+		return damage
+	end
+	return 0
+end
+)";
+
+constexpr int CREATURES = 500;
+constexpr int ROUNDS = 400;
+
+struct Result {
+	double mutatorMs;
+	double collectMs;
+	AllocStats allocs;
+};
+
+Result runScenario(bool cached, std::vector<FakeCreature>& creatures) {
+	AllocStats stats;
+	lua_State* L = lua_newstate(countingAlloc, &stats);
+	luaL_openlibs(L);
+
+	luaL_newmetatable(L, "Player");
+	lua_newtable(L);
+	lua_pushcfunction(L, creatureGetHealth);
+	lua_setfield(L, -2, "getHealth");
+	lua_setfield(L, -2, "__index");
+	lua_pop(L, 1);
+
+	if (luaL_dostring(L, COMBAT_SCRIPT) != 0) {
+		std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+		std::exit(1);
+	}
+
+	LuaUserdataCache cache;
+	cache.attach(L);
+	auto push = [&](FakeCreature* creature) {
+		if (cached) {
+			cache.push(L, creature, "Player");
+		} else {
+			auto userdata = static_cast<FakeCreature**>(lua_newuserdata(L, sizeof(FakeCreature*)));
+			*userdata = creature;
+			luaL_getmetatable(L, "Player");
+			lua_setmetatable(L, -2);
+		}
+	};
+
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	lua_gc(L, LUA_GCSTOP, 0);
+	stats = {};
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> pick(0, CREATURES - 1);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < ROUNDS; ++round) {
+		for (int i = 0; i < CREATURES; ++i) {
+			lua_getglobal(L, "onHealthChange");
+			push(&creatures[i]);
+			push(&creatures[pick(rng)]);
+			lua_pushnumber(L, 10);
+			if (lua_pcall(L, 3, 1, 0) != 0) {
+				std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+				std::exit(1);
+			}
+			lua_pop(L, 1);
+		}
+	}
+	auto mutatorEnd = std::chrono::steady_clock::now();
+
+	Result result;
+	result.allocs = stats;
+	lua_gc(L, LUA_GCRESTART, 0);
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	auto collectEnd = std::chrono::steady_clock::now();
+
+	result.mutatorMs = std::chrono::duration<double, std::milli>(mutatorEnd - start).count();
+	result.collectMs = std::chrono::duration<double, std::milli>(collectEnd - mutatorEnd).count();
+
+	if (cached) {
+		// identity and invalidation sanity checks
+		cache.push(L, &creatures[0], "Player");
+		cache.push(L, &creatures[0], "Player");
+		if (!lua_rawequal(L, -1, -2)) {
+			std::fprintf(stderr, "cached pushes returned different userdata\n");
+			std::exit(1);
+		}
+
+		cache.release(&creatures[0]);
+		if (*static_cast<FakeCreature**>(lua_touserdata(L, -1)) != nullptr) {
+			std::fprintf(stderr, "released userdata still points to the object\n");
+			std::exit(1);
+		}
+		lua_pop(L, 2);
+	}
+
+	cache.attach(nullptr);
+	lua_close(L);
+	return result;
+}
+
+void report(const char* name, const Result& result) {
+	double seconds = (result.mutatorMs + result.collectMs) / 1000;
+	std::printf("%-10s %10.2f ms run %8.2f ms gc %10llu allocs %12.0f allocs/s %10llu KiB\n", name, result.mutatorMs, result.collectMs,
+		static_cast<unsigned long long>(result.allocs.allocations), result.allocs.allocations / seconds,
+		static_cast<unsigned long long>(result.allocs.bytes / 1024));
+}
+
+} // namespace
+
+int main() {
+	std::vector<FakeCreature> creatures(CREATURES);
+
+	report("uncached", runScenario(false, creatures));
+	report("cached", runScenario(true, creatures));
+	return 0;
+}
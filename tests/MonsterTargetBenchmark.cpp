@@ -0,0 +1,235 @@
+#include "otpch.h"
+
+#include <chrono>
+#include <cstdio>
+
+// A hunting area with 2,000 monsters and 200 players, some of them with a
+// summon. Every think cycle each monster refreshes its targets the way
+// Monster::updateTargetList does. Before, it walked every creature of the
+// multifloor spectator range, monsters included, and kept the opponents;
+// now it walks only the players and the summons of players each quadtree
+// leaf keeps apart, as Map::getNearestPlayerSide does, nearest first. Both
+// must find the same opponents, and the nearest one must be as close as the
+// closest of the full scan.
+
+namespace {
+
+constexpr int32_t FLOOR_SIZE = 8;
+constexpr int32_t MAP_SIZE = 512;
+constexpr int32_t LEAVES = MAP_SIZE / FLOOR_SIZE;
+constexpr int32_t VIEWPORT_X = 11;
+constexpr int32_t VIEWPORT_Y = 11;
+constexpr int MONSTERS = 2000;
+constexpr int PLAYERS = 200;
+constexpr int CYCLES = 100;
+
+constexpr int32_t GROUND_FLOOR = 7;
+// the floors a multifloor lookup on the ground floor looks at
+constexpr int32_t MIN_FLOOR = 0;
+constexpr int32_t MAX_FLOOR = 9;
+
+struct FakeCreature {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        uint32_t id;
+        bool player;
+        const FakeCreature* master;
+};
+
+// Monster::isOpponent of a monster without a player master
+bool isOpponent(const FakeCreature& creature) {
+        return creature.player || (creature.master && creature.master->player);
+}
+
+// both bounds of Map::getSpectatorsInternal: the floor and the range shifted by the floor offset
+bool isInRange(const FakeCreature& center, const FakeCreature& creature) {
+        if (creature.z < MIN_FLOOR || creature.z > MAX_FLOOR) {
+                return false;
+        }
+
+        const int32_t offsetZ = center.z - creature.z;
+        return creature.x >= center.x - VIEWPORT_X + offsetZ && creature.x <= center.x + VIEWPORT_X + offsetZ
+               && creature.y >= center.y - VIEWPORT_Y + offsetZ && creature.y <= center.y + VIEWPORT_Y + offsetZ;
+}
+
+int32_t distance(const FakeCreature& from, const FakeCreature& to) {
+        return std::abs(from.x - to.x) + std::abs(from.y - to.y);
+}
+
+// QTreeLeafNode::creature_list and player_side_list
+struct Leaf {
+        std::vector<const FakeCreature*> creatures;
+        std::vector<const FakeCreature*> playerSide;
+};
+
+struct FakeMap {
+        std::vector<Leaf> leaves{LEAVES * LEAVES};
+
+        void addCreature(const FakeCreature& creature) {
+                Leaf& leaf = leaves[(creature.y / FLOOR_SIZE) * LEAVES + creature.x / FLOOR_SIZE];
+                leaf.creatures.push_back(&creature);
+                if (isOpponent(creature)) {
+                        leaf.playerSide.push_back(&creature);
+                }
+        }
+
+        template <typename Callback>
+        void forEachLeaf(const FakeCreature& center, Callback&& callback) const {
+                const int32_t minX = std::max(0, center.x - VIEWPORT_X + center.z - MAX_FLOOR);
+                const int32_t maxX = std::min(MAP_SIZE - 1, center.x + VIEWPORT_X + center.z - MIN_FLOOR);
+                const int32_t minY = std::max(0, center.y - VIEWPORT_Y + center.z - MAX_FLOOR);
+                const int32_t maxY = std::min(MAP_SIZE - 1, center.y + VIEWPORT_Y + center.z - MIN_FLOOR);
+                for (int32_t leafY = minY / FLOOR_SIZE; leafY <= maxY / FLOOR_SIZE; ++leafY) {
+                        for (int32_t leafX = minX / FLOOR_SIZE; leafX <= maxX / FLOOR_SIZE; ++leafX) {
+                                callback(leaves[leafY * LEAVES + leafX]);
+                        }
+                }
+        }
+};
+
+struct Result {
+        double ms = 0;
+        uint64_t visited = 0;
+        uint64_t opponents = 0;
+        uint64_t checksum = 0;
+        uint64_t nearestDistances = 0;
+};
+
+// Monster::updateTargetList before the index: every spectator, then Monster::isOpponent
+Result runFullScan(const FakeMap& map, const std::vector<FakeCreature>& monsters) {
+        Result result;
+        std::vector<const FakeCreature*> spectators;
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; ++cycle) {
+                for (const FakeCreature& monster : monsters) {
+                        spectators.clear();
+                        map.forEachLeaf(monster, [&](const Leaf& leaf) {
+                                for (const FakeCreature* creature : leaf.creatures) {
+                                        ++result.visited;
+                                        if (isInRange(monster, *creature)) {
+                                                spectators.push_back(creature);
+                                        }
+                                }
+                        });
+
+                        int32_t nearest = std::numeric_limits<int32_t>::max();
+                        for (const FakeCreature* creature : spectators) {
+                                if (creature != &monster && isOpponent(*creature)) {
+                                        ++result.opponents;
+                                        result.checksum += creature->id * 2654435761u ^ monster.id;
+                                        nearest = std::min(nearest, distance(monster, *creature));
+                                }
+                        }
+
+                        if (nearest != std::numeric_limits<int32_t>::max()) {
+                                result.nearestDistances += nearest;
+                        }
+                }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+// Map::getNearestPlayerSide
+Result runIndex(const FakeMap& map, const std::vector<FakeCreature>& monsters) {
+        Result result;
+        std::vector<const FakeCreature*> opponents;
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; ++cycle) {
+                for (const FakeCreature& monster : monsters) {
+                        opponents.clear();
+                        map.forEachLeaf(monster, [&](const Leaf& leaf) {
+                                for (const FakeCreature* creature : leaf.playerSide) {
+                                        ++result.visited;
+                                        if (isInRange(monster, *creature)) {
+                                                opponents.push_back(creature);
+                                        }
+                                }
+                        });
+
+                        std::sort(opponents.begin(), opponents.end(), [&monster](const FakeCreature* lhs, const FakeCreature* rhs) {
+                                return distance(monster, *lhs) < distance(monster, *rhs);
+                        });
+
+                        for (const FakeCreature* creature : opponents) {
+                                ++result.opponents;
+                                result.checksum += creature->id * 2654435761u ^ monster.id;
+                        }
+
+                        if (!opponents.empty()) {
+                                result.nearestDistances += distance(monster, *opponents.front());
+                        }
+                }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+void report(const char* name, const Result& result) {
+        std::printf("%-9s %8.2f ms for %d cycles %8.3f ms/cycle %10llu creatures visited %8llu opponents found\n", name,
+                    result.ms, CYCLES, result.ms / CYCLES, static_cast<unsigned long long>(result.visited),
+                    static_cast<unsigned long long>(result.opponents));
+}
+
+} // namespace
+
+int main() {
+        std::mt19937 rng{23};
+        std::uniform_int_distribution<int32_t> coordinate(64, MAP_SIZE - 64);
+        std::uniform_int_distribution<int32_t> around(-10, 10);
+        std::uniform_int_distribution<int32_t> percent(0, 99);
+
+        // reserved up front, the leaves keep pointers to the creatures
+        std::vector<FakeCreature> players;
+        players.reserve(PLAYERS);
+        std::vector<FakeCreature> summons;
+        summons.reserve(PLAYERS);
+        std::vector<FakeCreature> monsters;
+        monsters.reserve(MONSTERS);
+
+        uint32_t id = 0;
+        for (int i = 0; i < PLAYERS; ++i) {
+                const int32_t z = percent(rng) < 80 ? GROUND_FLOOR : GROUND_FLOOR - 1 - percent(rng) % 3;
+                players.push_back({coordinate(rng), coordinate(rng), z, ++id, true, nullptr});
+                if (percent(rng) < 20) {
+                        const FakeCreature& master = players.back();
+                        summons.push_back({master.x + 1, master.y, master.z, ++id, false, &master});
+                }
+        }
+
+        // the monsters crowd around the hunting players, the rest roam the area
+        for (int i = 0; i < MONSTERS; ++i) {
+                if (percent(rng) < 60) {
+                        const FakeCreature& player = players[i % PLAYERS];
+                        monsters.push_back({player.x + around(rng), player.y + around(rng), GROUND_FLOOR, ++id, false, nullptr});
+                } else {
+                        monsters.push_back({coordinate(rng), coordinate(rng), GROUND_FLOOR, ++id, false, nullptr});
+                }
+        }
+
+        FakeMap map;
+        for (const auto* creatures : {&players, &summons, &monsters}) {
+                for (const FakeCreature& creature : *creatures) {
+                        map.addCreature(creature);
+                }
+        }
+
+        Result fullScan = runFullScan(map, monsters);
+        Result index = runIndex(map, monsters);
+
+        std::printf("%d monsters, %d players, %zu summons of players\n", MONSTERS, PLAYERS, summons.size());
+        report("full scan", fullScan);
+        report("index", index);
+
+        if (fullScan.opponents != index.opponents || fullScan.checksum != index.checksum) {
+                std::fprintf(stderr, "both must find the same opponents\n");
+                return 1;
+        }
+
+        if (fullScan.nearestDistances != index.nearestDistances) {
+                std::fprintf(stderr, "the index must put the nearest opponent first\n");
+                return 1;
+        }
+        return 0;
+}
@@ -0,0 +1,164 @@
+#include "otpch.h"
+
+#include "game/game.h"
+#include "monster.h"
+#include "monsters.h"
+#include "movement.h"
+#include "player.h"
+
+#include <cstdio>
+
+// Monster::updateTargetList takes the targets of wild monsters from the
+// players and the summons of players each map leaf keeps apart. The index must
+// follow the real map code: a step, a step onto another leaf and a teleport
+// keep a player listed exactly once where it stands, and Creature::setMaster
+// lists a monster when it becomes the summon of a player and drops it again
+// when it loses its master. Map::getNearestPlayerSide reports a creature left
+// behind in a leaf in range as a second entry, so every check counts entries.
+// Wild monsters fill their friend list only when it is read.
+
+extern Game g_game;
+extern MoveEvents* g_moveEvents;
+
+namespace {
+
+constexpr uint16_t GRASS = 4526;
+// map leaves are FLOOR_SIZE tiles wide, 1000 starts one
+constexpr uint16_t BASE = 1000;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+Tile* makeTile(const Position& pos) {
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		tile = new DynamicTile(pos.x, pos.y, pos.z);
+		tile->internalAddThing(Item::CreateItem(GRASS));
+		g_game.map.setTile(pos, tile);
+	}
+	return tile;
+}
+
+void place(Creature* creature, const Position& pos) {
+	makeTile(pos);
+	creature->incrementReferenceCounter();
+	check(g_game.map.placeCreature(pos, creature, false, true), "unable to place a creature");
+}
+
+void move(Creature* creature, const Position& pos, bool teleport = false) {
+	g_game.map.moveCreature(*creature, *makeTile(pos), teleport);
+	check(creature->getPosition() == pos, "the creature must stand where it was moved");
+}
+
+size_t countNear(const Creature* creature, const Position& centerPos) {
+	CreatureVector creatures;
+	g_game.map.getNearestPlayerSide(creatures, centerPos, true);
+	return std::count(creatures.begin(), creatures.end(), creature);
+}
+
+void testMove(Player* player) {
+	const Position start(BASE + 4, BASE + 4, 7);
+	place(player, start);
+	check(countNear(player, start) == 1, "a placed player must be listed once");
+
+	// within the leaf
+	move(player, Position(BASE + 5, BASE + 4, 7));
+	move(player, Position(BASE + 6, BASE + 4, 7));
+	move(player, Position(BASE + 7, BASE + 4, 7));
+	check(countNear(player, player->getPosition()) == 1, "a step within a leaf must keep the player listed once");
+
+	// onto the next leaf and back, both leaves in range of the lookup
+	move(player, Position(BASE + FLOOR_SIZE, BASE + 4, 7));
+	check(countNear(player, player->getPosition()) == 1, "a step onto another leaf must move the entry");
+	move(player, Position(BASE + FLOOR_SIZE, BASE + FLOOR_SIZE, 7));
+	check(countNear(player, player->getPosition()) == 1, "a diagonal leaf change must move the entry");
+	move(player, Position(BASE + FLOOR_SIZE - 1, BASE + FLOOR_SIZE - 1, 7));
+	check(countNear(player, player->getPosition()) == 1, "a step back must move the entry back");
+}
+
+void testTeleport(Player* player) {
+	const Position from = player->getPosition();
+	const Position far(BASE + 300, BASE + 300, 7);
+
+	move(player, far, true);
+	check(countNear(player, from) == 0, "a teleported player must be gone from where it left");
+	check(countNear(player, far) == 1, "a teleported player must be listed where it arrived");
+
+	move(player, Position(far.x, far.y, 8), true);
+	check(countNear(player, Position(far.x, far.y, 8)) == 1, "a floor change must keep the player listed once");
+
+	// an entry left behind would show up again next to the new one
+	move(player, from, true);
+	check(countNear(player, from) == 1, "a player teleported back must be listed once");
+}
+
+void testSetMaster(Player* player, MonsterType* monsterType) {
+	const Position pos(BASE + 2, BASE + 12, 7);
+	Monster* monster = new Monster(monsterType);
+	place(monster, pos);
+	check(countNear(monster, pos) == 0, "a wild monster must not be listed");
+
+	monster->setMaster(player);
+	check(countNear(monster, pos) == 1, "the summon of a player must be listed");
+
+	move(monster, Position(BASE + 1, BASE + 12, 7));
+	move(monster, Position(BASE, BASE + 12, 7));
+	move(monster, Position(BASE - 1, BASE + 12, 7));
+	check(countNear(monster, monster->getPosition()) == 1, "a summon changing leaves must stay listed once");
+
+	monster->setMaster(nullptr);
+	check(countNear(monster, monster->getPosition()) == 0, "a monster losing its master must be dropped");
+
+	// a summon placed with its master already set
+	Monster* summon = new Monster(monsterType);
+	summon->setMaster(player);
+	const Position summonPos(BASE + 3, BASE + 12, 7);
+	place(summon, summonPos);
+	check(countNear(summon, summonPos) == 1, "a summon placed with a master must be listed");
+}
+
+void testFriends(MonsterType* monsterType) {
+	// the wild monsters in sight are only collected when a script reads the list
+	Monster* monster = new Monster(monsterType);
+	place(monster, Position(BASE + 2, BASE + 100, 7));
+	Monster* other = new Monster(monsterType);
+	place(other, Position(BASE + 5, BASE + 100, 7));
+	Monster* farAway = new Monster(monsterType);
+	place(farAway, Position(BASE + 200, BASE + 100, 7));
+
+	const auto& friends = monster->getFriendList();
+	check(friends.size() == 1 && friends.count(other) == 1, "the friend list must hold the wild monsters in sight");
+}
+
+} // namespace
+
+int main() {
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+		return 1;
+	}
+
+	// Map::moveCreature runs the step in events, none are registered
+	g_moveEvents = new MoveEvents();
+
+	MonsterType monsterType;
+	monsterType.name = "Summon";
+
+	// the spectators of a move check what the player can see
+	Group group{"Player", 0, 0, 0, 1, false};
+	Player* player = new Player(nullptr);
+	player->setName("Summoner");
+	player->setGroup(&group);
+
+	testMove(player);
+	testTeleport(player);
+	testSetMaster(player, &monsterType);
+	testFriends(&monsterType);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "otpch.h"
+
+#include "actions.h"
+#include "creatureevent.h"
+#include "globalevent.h"
+#include "movement.h"
+#include "script.h"
+#include "spells.h"
+#include "talkaction.h"
+#include "weapons.h"
+
+#include <cstdio>
+#include <fstream>
+
+// Scripts::reloadChangedScripts runs a changed file again. The event callbacks
+// and weapons the file registered the first time must be dropped before that,
+// or every reload adds another copy of them, and removing the file must drop
+// them as well.
+
+extern LuaEnvironment g_luaEnvironment;
+extern Actions* g_actions;
+extern CreatureEvents* g_creatureEvents;
+extern GlobalEvents* g_globalEvents;
+extern MoveEvents* g_moveEvents;
+extern Scripts* g_scripts;
+extern Spells* g_spells;
+extern TalkActions* g_talkActions;
+extern Weapons* g_weapons;
+
+namespace {
+
+constexpr uint16_t SWORD = 2376;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+void writeScript(const std::filesystem::path& file, int version) {
+	std::ofstream out(file);
+	out << "-- version " << version << "\n"
+	    << "local event = Event()\n"
+	    << "event.onSpawn = function() ReloadTestCalls = ReloadTestCalls + 1 end\n"
+	    << "event:register()\n"
+	    << "local weapon = Weapon(WEAPON_SWORD)\n"
+	    << "weapon:id(" << SWORD << ")\n"
+	    << "weapon:onUseWeapon(function(player, variant) return true end)\n"
+	    << "weapon:register()\n";
+	out.close();
+
+	// the reload compares modification times, make sure the rewrite is seen
+	std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now() + std::chrono::seconds(version));
+}
+
+// runs every onSpawn callback once and tells how many ran
+int countCallbacks() {
+	lua_State* L = g_scripts->getScriptInterface().getLuaState();
+	if (luaL_dostring(L, "ReloadTestCalls = 0 Event.onSpawn() return ReloadTestCalls") != 0) {
+		std::fprintf(stderr, "%s\n", lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return -1;
+	}
+
+	int calls = static_cast<int>(lua_tonumber(L, -1));
+	lua_pop(L, 1);
+	return calls;
+}
+
+} // namespace
+
+int main() {
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+		return 1;
+	}
+
+	g_luaEnvironment.loadFile("data/global.lua");
+	g_scripts = new Scripts();
+	if (!g_scripts->loadScripts("scripts/lib", true, false)) {
+		std::fprintf(stderr, "unable to load data/scripts/lib\n");
+		return 1;
+	}
+
+	g_actions = new Actions();
+	g_creatureEvents = new CreatureEvents();
+	g_globalEvents = new GlobalEvents();
+	g_moveEvents = new MoveEvents();
+	g_spells = new Spells();
+	g_talkActions = new TalkActions();
+	g_weapons = new Weapons();
+
+	// an absolute folder name replaces data/ in Scripts::findScripts
+	const auto folder = std::filesystem::temp_directory_path() / "tfs_script_reload_test";
+	std::filesystem::remove_all(folder);
+	std::filesystem::create_directories(folder);
+	const auto file = folder / "callback.lua";
+	writeScript(file, 1);
+
+	if (!g_scripts->loadScripts(folder.string(), false, false)) {
+		std::fprintf(stderr, "unable to load %s\n", file.string().c_str());
+		return 1;
+	}
+
+	Item* sword = Item::CreateItem(SWORD);
+	const Weapon* weapon = g_weapons->getWeapon(sword);
+	check(countCallbacks() == 1, "a loaded file must register its callback");
+	check(weapon != nullptr, "a loaded file must register its weapon");
+
+	for (int version = 2; version <= 3; ++version) {
+		writeScript(file, version);
+		check(g_scripts->reloadChangedScripts(folder.string()) == 1, "a changed file must be reloaded");
+		check(countCallbacks() == 1, "a reloaded file must replace its callback, not add another one");
+		check(g_weapons->getWeapon(sword) != nullptr, "a reloaded file must register its weapon again");
+	}
+
+	std::filesystem::remove(file);
+	check(g_scripts->reloadChangedScripts(folder.string()) == 1, "a removed file must be unloaded");
+	check(countCallbacks() == 0, "a removed file must drop its callback");
+	check(g_weapons->getWeapon(sword) == nullptr, "a removed file must drop its weapon");
+
+	std::filesystem::remove_all(folder);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#include "otpch.h"
+#include "sightcache.h"
+
+#include <chrono>
+#include <cstdio>
+
+// A hunting ground of 300 monsters, each with a few players around. Every
+// cycle a monster looks for a target, checks whether it can still attack it
+// and whether it may keep its distance, asking Map::isSightClear for the same
+// lines each time. The same cycles run once through the former sight check,
+// descending the quadtree and scanning the items of every tile on the line,
+// and once through the line walk over the blocks projectile flag with the
+// SightCache in front of it. Both must agree on every line.
+
+namespace {
+
+constexpr int32_t FLOOR_BITS = 3;
+constexpr int32_t FLOOR_SIZE = 1 << FLOOR_BITS;
+constexpr int32_t FLOOR_MASK = FLOOR_SIZE - 1;
+constexpr int32_t MAP_SIZE = 512;
+constexpr uint8_t FLOOR = 7;
+constexpr int MONSTERS = 300;
+constexpr int PLAYERS = 60;
+constexpr int CYCLES = 200;
+// target search, attack and keep distance
+constexpr int CHECKS_PER_CYCLE = 3;
+
+struct FakeItem {
+        bool blockProjectile;
+};
+
+struct FakeTile {
+        std::vector<FakeItem> items;
+        bool blockProjectileFlag = false;
+
+        // Tile::hasProperty
+        bool hasBlockProjectile() const {
+                return std::any_of(items.begin(), items.end(), [](const FakeItem& item) { return item.blockProjectile; });
+        }
+};
+
+struct Floor {
+        FakeTile* tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
+};
+
+// QTreeNode and QTreeLeafNode
+struct Node {
+        Node* child[4] = {};
+        Floor* floors[16] = {};
+        bool leaf = false;
+
+        Node* createLeaf(uint32_t x, uint32_t y, uint32_t level) {
+                if (leaf) {
+                        return this;
+                }
+
+                uint32_t index = ((x & 0x8000) >> 15) | ((y & 0x8000) >> 14);
+                if (!child[index]) {
+                        child[index] = new Node();
+                        child[index]->leaf = level == FLOOR_BITS;
+                }
+                return child[index]->createLeaf(x * 2, y * 2, level - 1);
+        }
+
+        static const Node* getLeaf(const Node* node, uint32_t x, uint32_t y) {
+                do {
+                        node = node->child[((x & 0x8000) >> 15) | ((y & 0x8000) >> 14)];
+                        if (!node) {
+                                return nullptr;
+                        }
+
+                        x <<= 1;
+                        y <<= 1;
+                } while (!node->leaf);
+                return node;
+        }
+};
+
+struct FakeMap {
+        Node root;
+        std::vector<std::unique_ptr<FakeTile>> tiles;
+        std::vector<std::unique_ptr<Floor>> floors;
+
+        void setTile(uint16_t x, uint16_t y, FakeTile* tile) {
+                Node* leaf = root.createLeaf(x, y, 15);
+                if (!leaf->floors[FLOOR]) {
+                        floors.push_back(std::make_unique<Floor>());
+                        leaf->floors[FLOOR] = floors.back().get();
+                }
+                leaf->floors[FLOOR]->tiles[x & FLOOR_MASK][y & FLOOR_MASK] = tile;
+        }
+
+        // Map::getTile
+        const FakeTile* getTile(uint16_t x, uint16_t y) const {
+                const Node* leaf = Node::getLeaf(&root, x, y);
+                if (!leaf || !leaf->floors[FLOOR]) {
+                        return nullptr;
+                }
+                return leaf->floors[FLOOR]->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+        }
+};
+
+// the line walk of Map::checkSightLine, isClear(x, y) for the tiles between both ends
+template <typename IsClear>
+bool checkLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, IsClear&& isClear) {
+        auto walk = [&isClear](uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, bool steep) {
+                float dx = x1 - x0;
+                float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
+                float yi = y0 + slope;
+                for (uint16_t x = x0 + 1; x < x1; ++x) {
+                        const uint16_t y = std::floor(yi + 0.1);
+                        if (!(steep ? isClear(y, x) : isClear(x, y))) {
+                                return false;
+                        }
+                        yi += slope;
+                }
+                return true;
+        };
+
+        if (x0 == x1 && y0 == y1) {
+                return true;
+        }
+
+        if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
+                return y1 > y0 ? walk(y0, x0, y1, x1, true) : walk(y1, x1, y0, x0, true);
+        }
+        return x0 > x1 ? walk(x1, y1, x0, y0, false) : walk(x0, y0, x1, y1, false);
+}
+
+// Map::isSightClear on the same floor before the cache
+bool isSightClearOld(const FakeMap& map, const Position& fromPos, const Position& toPos) {
+        if (fromPos.getDistanceX(toPos) < 2 && fromPos.getDistanceY(toPos) < 2) {
+                return true;
+        }
+
+        return checkLine(fromPos.x, fromPos.y, toPos.x, toPos.y, [&map](uint16_t x, uint16_t y) {
+                const FakeTile* tile = map.getTile(x, y);
+                return !tile || !tile->hasBlockProjectile();
+        });
+}
+
+// SightLineTiles of map.cpp
+class SightLineTiles {
+        public:
+                explicit SightLineTiles(const Node& root) : root(root) {}
+
+                bool blocksProjectile(uint16_t x, uint16_t y) {
+                        const uint32_t leafX = x & ~FLOOR_MASK;
+                        const uint32_t leafY = y & ~FLOOR_MASK;
+                        if (leafX != lastLeafX || leafY != lastLeafY) {
+                                lastLeafX = leafX;
+                                lastLeafY = leafY;
+
+                                const Node* leaf = Node::getLeaf(&root, x, y);
+                                floor = leaf ? leaf->floors[FLOOR] : nullptr;
+                        }
+
+                        if (!floor) {
+                                return false;
+                        }
+
+                        const FakeTile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+                        return tile && tile->blockProjectileFlag;
+                }
+
+        private:
+                const Node& root;
+                const Floor* floor = nullptr;
+                uint32_t lastLeafX = std::numeric_limits<uint32_t>::max();
+                uint32_t lastLeafY = std::numeric_limits<uint32_t>::max();
+};
+
+bool isSightClearNew(const FakeMap& map, SightCache& cache, uint64_t cycle, const Position& fromPos, const Position& toPos) {
+        uint64_t key;
+        bool sightClear;
+        const bool cacheable = SightCache::makeKey(fromPos, toPos, true, key);
+        if (cacheable && cache.find(key, cycle, sightClear)) {
+                return sightClear;
+        }
+
+        if (fromPos.getDistanceX(toPos) < 2 && fromPos.getDistanceY(toPos) < 2) {
+                sightClear = true;
+        } else {
+                SightLineTiles tiles(map.root);
+                sightClear = checkLine(fromPos.x, fromPos.y, toPos.x, toPos.y, [&tiles](uint16_t x, uint16_t y) {
+                        return !tiles.blocksProjectile(x, y);
+                });
+        }
+
+        if (cacheable) {
+                cache.insert(key, sightClear);
+        }
+        return sightClear;
+}
+
+struct Creature {
+        Position pos;
+        std::vector<size_t> players;
+};
+
+struct Result {
+        double ms = 0;
+        uint64_t checks = 0;
+        uint64_t clear = 0;
+        uint64_t checksum = 0;
+};
+
+template <typename IsSightClear>
+Result run(std::vector<Creature> monsters, const std::vector<Position>& players, IsSightClear&& isSightClear) {
+        std::mt19937 rng{13};
+        std::uniform_int_distribution<int> step(-1, 1);
+
+        Result result;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t cycle = 1; cycle <= CYCLES; ++cycle) {
+                for (Creature& monster : monsters) {
+                        for (int check = 0; check < CHECKS_PER_CYCLE; ++check) {
+                                for (size_t player : monster.players) {
+                                        const bool clear = isSightClear(cycle, monster.pos, players[player]);
+                                        ++result.checks;
+                                        result.clear += clear;
+                                        result.checksum = result.checksum * 31 + clear;
+                                }
+                        }
+
+                        // a step every few cycles
+                        if (cycle % 4 == 0) {
+                                monster.pos.x += step(rng);
+                                monster.pos.y += step(rng);
+                        }
+                }
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+}
+
+void report(const char* name, const Result& result) {
+        std::printf("%-6s %8.2f ms for %d cycles %8.3f ms/cycle %9llu sight checks, %llu clear\n", name, result.ms, CYCLES,
+                    result.ms / CYCLES, static_cast<unsigned long long>(result.checks),
+                    static_cast<unsigned long long>(result.clear));
+}
+
+} // namespace
+
+int main() {
+        std::mt19937 rng{17};
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> itemCount(0, 3);
+
+        FakeMap map;
+        for (uint16_t x = 0; x < MAP_SIZE; ++x) {
+                for (uint16_t y = 0; y < MAP_SIZE; ++y) {
+                        auto tile = std::make_unique<FakeTile>();
+                        // ground, some decoration and now and then a wall or a tree
+                        tile->items.push_back({false});
+                        for (int i = itemCount(rng); i > 0; --i) {
+                                tile->items.push_back({false});
+                        }
+                        if (percent(rng) < 8) {
+                                tile->items.push_back({true});
+                        }
+                        tile->blockProjectileFlag = tile->hasBlockProjectile();
+                        map.setTile(x, y, tile.get());
+                        map.tiles.push_back(std::move(tile));
+                }
+        }
+
+        std::uniform_int_distribution<uint16_t> coordinate(32, MAP_SIZE - 32);
+        std::vector<Position> players;
+        for (int i = 0; i < PLAYERS; ++i) {
+                players.emplace_back(coordinate(rng), coordinate(rng), FLOOR);
+        }
+
+        // every monster hunts near a player and sees the players within its view
+        std::uniform_int_distribution<int> around(-7, 7);
+        std::vector<Creature> monsters(MONSTERS);
+        for (int i = 0; i < MONSTERS; ++i) {
+                const Position& near = players[i % PLAYERS];
+                monsters[i].pos = Position(near.x + around(rng), near.y + around(rng), FLOOR);
+                for (size_t player = 0; player < players.size(); ++player) {
+                        if (monsters[i].pos.getDistanceX(players[player]) <= 9 && monsters[i].pos.getDistanceY(players[player]) <= 7) {
+                                monsters[i].players.push_back(player);
+                        }
+                }
+        }
+
+        Result old = run(monsters, players, [&map](uint64_t, const Position& fromPos, const Position& toPos) {
+                return isSightClearOld(map, fromPos, toPos);
+        });
+
+        SightCache cache;
+        Result cached = run(monsters, players, [&map, &cache](uint64_t cycle, const Position& fromPos, const Position& toPos) {
+                return isSightClearNew(map, cache, cycle, fromPos, toPos);
+        });
+
+        report("before", old);
+        report("cached", cached);
+
+        if (old.checksum != cached.checksum || old.clear != cached.clear) {
+                std::fprintf(stderr, "both sight checks must give the same results\n");
+                return 1;
+        }
+
+        // a wall put up between two checks of the same cycle is seen by the second one
+        const Position from(100, 100, FLOOR);
+        const Position to(104, 100, FLOOR);
+        FakeTile* wall = map.tiles[102 * MAP_SIZE + 100].get();
+        wall->blockProjectileFlag = false;
+        map.tiles[101 * MAP_SIZE + 100]->blockProjectileFlag = false;
+        map.tiles[103 * MAP_SIZE + 100]->blockProjectileFlag = false;
+        const uint64_t cycle = CYCLES + 1;
+        const bool before = isSightClearNew(map, cache, cycle, from, to);
+        wall->blockProjectileFlag = true;
+        SightCache::invalidateAll();
+        const bool after = isSightClearNew(map, cache, cycle, from, to);
+        if (!before || after) {
+                std::fprintf(stderr, "invalidateAll must drop the cached results\n");
+                return 1;
+        }
+        return 0;
+}
@@ -0,0 +1,153 @@
+#include "otpch.h"
+
+#include "game/game.h"
+#include "movement.h"
+
+#include <cstdio>
+
+// Map::isSightClear remembers its results for a dispatcher cycle. The tiles
+// drop them as soon as a change can turn a line of sight: an item that starts
+// or stops blocking projectiles through a transform or a replace, and a ground
+// that is added, swapped or removed. The dispatcher does not run here, so the
+// whole test is one cycle and every stale result would be returned.
+
+extern Game g_game;
+extern MoveEvents* g_moveEvents;
+
+namespace {
+
+constexpr uint16_t GRASS = 4526;
+constexpr uint16_t LIT_TORCH = 2051;
+constexpr uint16_t BASE = 1000;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+Tile* makeTile(const Position& pos, bool withGround = true) {
+	Tile* tile = new DynamicTile(pos.x, pos.y, pos.z);
+	if (withGround) {
+		tile->internalAddThing(Item::CreateItem(GRASS));
+	}
+	g_game.map.setTile(pos, tile);
+	return tile;
+}
+
+// the first plain item type, neither on top of the others nor of a special kind
+uint16_t findItem(bool ground, bool blockProjectile) {
+	for (size_t id = 100; id < Item::items.size(); ++id) {
+		const ItemType& it = Item::items[id];
+		if (it.id != 0 && it.isGroundTile() == ground && it.blockProjectile == blockProjectile && !it.alwaysOnTop && it.type == ITEM_TYPE_NONE) {
+			return it.id;
+		}
+	}
+	return 0;
+}
+
+// sameFloor keeps a blocked line from being thrown over through the floor above
+bool isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor = true) {
+	// twice, the second answer comes from the cache
+	const bool sightClear = g_game.map.isSightClear(fromPos, toPos, sameFloor);
+	check(g_game.map.isSightClear(fromPos, toPos, sameFloor) == sightClear, "a remembered result must match the first one");
+	return sightClear;
+}
+
+void testItems(uint16_t wallId) {
+	const Position from(BASE, BASE, 7);
+	const Position to(BASE + 6, BASE, 7);
+	Tile* middle = nullptr;
+	for (uint16_t x = from.x; x <= to.x; ++x) {
+		Tile* tile = makeTile(Position(x, from.y, from.z));
+		if (x == BASE + 3) {
+			middle = tile;
+		}
+	}
+	check(isSightClear(from, to), "a line over plain ground must be clear");
+
+	Item* torch = Item::CreateItem(LIT_TORCH);
+	check(g_game.internalAddItem(middle, torch, INDEX_WHEREEVER, FLAG_NOLIMIT) == RETURNVALUE_NOERROR, "unable to add an item");
+	check(isSightClear(from, to), "an item that does not block projectiles must keep the line clear");
+
+	// Tile::updateThing
+	Item* wall = g_game.transformItem(torch, wallId);
+	check(wall && middle->hasFlag(TILESTATE_BLOCKPROJECTILE), "the tile of a transformed item must block projectiles");
+	check(!isSightClear(from, to), "an item transformed into one blocking projectiles must block the line");
+	torch = g_game.transformItem(wall, LIT_TORCH);
+	check(torch && !middle->hasFlag(TILESTATE_BLOCKPROJECTILE), "the tile of an item transformed back must not block projectiles");
+	check(isSightClear(from, to), "an item transformed back must clear the line");
+
+	// Tile::replaceThing
+	wall = Item::CreateItem(wallId);
+	middle->replaceThing(middle->getThingIndex(torch), wall);
+	check(!isSightClear(from, to), "an item replaced by one blocking projectiles must block the line");
+	Item* otherTorch = Item::CreateItem(LIT_TORCH);
+	middle->replaceThing(middle->getThingIndex(wall), otherTorch);
+	check(isSightClear(from, to), "an item blocking projectiles replaced by one that does not must clear the line");
+
+	// Tile::removeThing
+	wall = Item::CreateItem(wallId);
+	middle->replaceThing(middle->getThingIndex(otherTorch), wall);
+	check(!isSightClear(from, to), "the replaced item must block the line");
+	middle->removeThing(wall, 1);
+	check(isSightClear(from, to), "a removed item blocking projectiles must clear the line");
+}
+
+void testGround() {
+	// a throw down one floor needs the tile above the target without ground
+	const Position from(BASE, BASE + 20, 6);
+	const Position to(BASE + 4, BASE + 20, 7);
+	for (uint16_t x = from.x; x <= to.x; ++x) {
+		makeTile(Position(x, to.y, to.z));
+	}
+	Tile* above = makeTile(Position(to.x, to.y, from.z), false);
+	check(isSightClear(from, to, false), "a throw down through a tile without ground must be clear");
+
+	Item* ground = Item::CreateItem(GRASS);
+	above->addThing(ground);
+	check(!isSightClear(from, to, false), "a ground added above the target must block the throw");
+
+	above->removeThing(ground, 1);
+	check(isSightClear(from, to, false), "a ground removed above the target must clear the throw");
+
+	// swapping the ground of a tile on the line
+	const uint16_t blockingGround = findItem(true, true);
+	if (blockingGround == 0) {
+		std::fprintf(stderr, "no ground blocks projectiles in items.otb, the ground swap is not checked\n");
+		return;
+	}
+
+	const Position sameFrom(BASE, BASE + 20, 7);
+	Tile* onLine = g_game.map.getTile(BASE + 2, to.y, to.z);
+	check(isSightClear(sameFrom, to), "a line over plain ground must be clear");
+	onLine->addThing(Item::CreateItem(blockingGround));
+	check(!isSightClear(sameFrom, to), "a ground swapped for one blocking projectiles must block the line");
+	onLine->addThing(Item::CreateItem(GRASS));
+	check(isSightClear(sameFrom, to), "a ground swapped back must clear the line");
+}
+
+} // namespace
+
+int main() {
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+		return 1;
+	}
+
+	// adding an item runs the add item events, none are registered
+	g_moveEvents = new MoveEvents();
+
+	const uint16_t wallId = findItem(false, true);
+	if (wallId == 0) {
+		std::fprintf(stderr, "no item blocks projectiles in items.otb\n");
+		return 1;
+	}
+
+	testItems(wallId);
+	testGround();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "game/game.h"
+#include "monsters.h"
+#include "movement.h"
+#include "spawn.h"
+
+#include <cstdio>
+#include <thread>
+
+// Spawns::checkSpawns respawns at most maxSpawnsPerTick monsters per check.
+// The spawns that came due wait in a queue in the order they came due, a spawn
+// the budget cut short stays at its head for the next check, and a spawn
+// still comes back one interval after its monster was removed, at most one
+// check later.
+
+extern Game g_game;
+extern MoveEvents* g_moveEvents;
+
+namespace {
+
+constexpr uint16_t GRASS = 4526;
+constexpr uint16_t BASE = 1000;
+constexpr uint32_t RESPAWN_INTERVAL = 2000;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+Tile* makeTile(const Position& pos) {
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		tile = new DynamicTile(pos.x, pos.y, pos.z);
+		tile->internalAddThing(Item::CreateItem(GRASS));
+		g_game.map.setTile(pos, tile);
+	}
+	return tile;
+}
+
+void addBlock(Spawn& spawn, MonsterType* monsterType, const Position& pos, uint32_t interval) {
+	makeTile(pos);
+
+	spawnBlock_t sb;
+	sb.mTypes.push_back({monsterType, 100});
+	sb.pos = pos;
+	sb.direction = DIRECTION_SOUTH;
+	sb.interval = interval;
+	sb.lastSpawn = 0;
+	spawn.addBlock(sb);
+}
+
+Creature* getMonster(const Position& pos) {
+	return g_game.map.getTile(pos)->getTopCreature();
+}
+
+void waitChecks(int64_t checks) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(Spawns::CHECK_INTERVAL * checks + 100));
+}
+
+void testQueue(Spawns& spawns, MonsterType* monsterType) {
+	// one respawn per check, the first spawn needs two
+	ConfigManager::setNumber(ConfigManager::MAX_SPAWNS_PER_TICK, 1);
+
+	const Position first1(BASE, BASE, 7), first2(BASE + 1, BASE, 7);
+	const Position second(BASE, BASE + 10, 7), third(BASE, BASE + 20, 7);
+
+	// the spawns stay scheduled until the end, like the ones Spawns keeps
+	Spawn* firstSpawn = new Spawn(spawns, Position(BASE + 2, BASE + 2, 7), 5);
+	addBlock(*firstSpawn, monsterType, first1, 1);
+	addBlock(*firstSpawn, monsterType, first2, 1);
+	Spawn* secondSpawn = new Spawn(spawns, Position(BASE + 2, BASE + 12, 7), 5);
+	addBlock(*secondSpawn, monsterType, second, 1);
+	Spawn* thirdSpawn = new Spawn(spawns, Position(BASE + 2, BASE + 22, 7), 5);
+	addBlock(*thirdSpawn, monsterType, third, 1);
+
+	// come due one check apart, then all of them wait
+	firstSpawn->startSpawnCheck();
+	waitChecks(1);
+	secondSpawn->startSpawnCheck();
+	waitChecks(1);
+	thirdSpawn->startSpawnCheck();
+	waitChecks(2);
+
+	spawns.checkSpawns();
+	check(getMonster(first1) && !getMonster(first2), "the first check must spend its budget on the first spawn");
+	check(!getMonster(second) && !getMonster(third), "the spawns after an exhausted budget must wait");
+
+	spawns.checkSpawns();
+	check(getMonster(first2), "a spawn cut short by the budget must be finished first");
+	check(!getMonster(second) && !getMonster(third), "the spawns after an exhausted budget must wait");
+
+	spawns.checkSpawns();
+	check(getMonster(second) && !getMonster(third), "the spawns must be checked in the order they came due");
+
+	spawns.checkSpawns();
+	check(getMonster(third), "the last spawn must be checked once the budget reaches it");
+}
+
+void testTiming(Spawns& spawns, MonsterType* monsterType) {
+	ConfigManager::setNumber(ConfigManager::MAX_SPAWNS_PER_TICK, 100);
+
+	const Position pos(BASE, BASE + 30, 7);
+	Spawn* spawn = new Spawn(spawns, Position(BASE + 2, BASE + 32, 7), 5);
+	addBlock(*spawn, monsterType, pos, RESPAWN_INTERVAL);
+	spawn->startup();
+
+	Creature* monster = getMonster(pos);
+	check(monster != nullptr, "the spawn must place its monster on startup");
+	if (!monster) {
+		return;
+	}
+
+	const auto removed = std::chrono::steady_clock::now();
+	g_game.removeCreature(monster, false);
+
+	std::this_thread::sleep_until(removed + std::chrono::milliseconds(RESPAWN_INTERVAL - 500));
+	spawns.checkSpawns();
+	check(!getMonster(pos), "a monster must not come back before the interval of its spawn");
+
+	std::this_thread::sleep_until(removed + std::chrono::milliseconds(RESPAWN_INTERVAL + Spawns::CHECK_INTERVAL + 100));
+	spawns.checkSpawns();
+	check(getMonster(pos), "a monster must come back at most one check after the interval of its spawn");
+}
+
+} // namespace
+
+int main() {
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		std::fprintf(stderr, "unable to load the item types, run from the source directory\n");
+		return 1;
+	}
+
+	// placing a monster runs the step in events, none are registered
+	g_moveEvents = new MoveEvents();
+
+	ConfigManager::setNumber(ConfigManager::RATE_SPAWN, 10);
+
+	MonsterType monsterType;
+	monsterType.name = "Rat";
+
+	Spawns& spawns = g_game.map.spawns;
+	testQueue(spawns, &monsterType);
+	testTiming(spawns, &monsterType);
+	return failures == 0 ? 0 : 1;
+}
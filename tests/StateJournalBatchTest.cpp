@@ -0,0 +1,83 @@
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "statejournal.h"
+
+#include <cstdio>
+
+// The writer appends every batch of the journal with a commit record after
+// it. A crash can leave a batch on disk without its commit record, or cut it
+// anywhere in between; StateJournal::replay must then apply every committed
+// batch and none of the torn one.
+
+namespace {
+
+constexpr uint32_t GUID = 4243;
+// the commit record: frame length, type, count, sub and checksum
+constexpr size_t COMMIT_SIZE = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+bool hasStorage(const std::map<StateJournal::RecordKey, std::string>& records, uint32_t key) {
+	return records.find({JOURNAL_PLAYER_STORAGE, GUID, key}) != records.end();
+}
+
+void truncate(const std::string& from, const std::string& to, uintmax_t size) {
+	std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing);
+	std::filesystem::resize_file(to, size);
+}
+
+} // namespace
+
+int main() {
+	const std::string path = (std::filesystem::temp_directory_path() / "state_journal_batch_test.bin").string();
+	const std::string tornPath = path + ".torn";
+
+	ConfigManager::setBoolean(ConfigManager::STATE_JOURNAL, true);
+	ConfigManager::setString(ConfigManager::STATE_JOURNAL_FILE, path);
+	ConfigManager::setNumber(ConfigManager::STATE_JOURNAL_MAX_SIZE, 1);
+	g_stateJournal.start();
+	if (!g_stateJournal.isEnabled()) {
+		std::fprintf(stderr, "unable to start the journal\n");
+		return 1;
+	}
+
+	// two batches, the second one of three records
+	g_stateJournal.playerStorage(GUID, 1, 10);
+	g_stateJournal.flush();
+	g_stateJournal.playerStorage(GUID, 2, 20);
+	g_stateJournal.playerStorage(GUID, 3, 30);
+	g_stateJournal.playerBalance(GUID, 500);
+	g_stateJournal.shutdown();
+	g_stateJournal.join();
+
+	std::map<StateJournal::RecordKey, std::string> records;
+	check(StateJournal::loadRecords(path, records), "unable to read the journal back");
+	check(records.size() == 4, "both committed batches must be read");
+
+	const uintmax_t size = std::filesystem::file_size(path);
+
+	// every record of the last batch on disk, but not its commit record
+	truncate(path, tornPath, size - COMMIT_SIZE);
+	records.clear();
+	check(StateJournal::loadRecords(tornPath, records), "unable to read the torn journal");
+	check(hasStorage(records, 1), "the committed batch must be read");
+	check(records.size() == 1, "a batch without its commit record must be ignored");
+
+	// cut within the last record of the last batch
+	truncate(path, tornPath, size - COMMIT_SIZE - 10);
+	records.clear();
+	check(StateJournal::loadRecords(tornPath, records), "unable to read the torn journal");
+	check(records.size() == 1 && !hasStorage(records, 2), "no record of a torn batch may be read");
+
+	std::filesystem::remove(path);
+	std::filesystem::remove(tornPath);
+	return failures == 0 ? 0 : 1;
+}
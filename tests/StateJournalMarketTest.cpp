@@ -0,0 +1,135 @@
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "fileloader.h"
+#include "game/game.h"
+#include "inbox.h"
+#include "player.h"
+#include "statejournal.h"
+
+#include <cstdio>
+
+// A market buy debits the bank balance of the buyer and delivers the items to
+// their inbox, as the accept branch of Game::playerAcceptMarketOffer does. The
+// inbox is not part of the player's cylinder chain, so both changes must reach
+// the journal on their own: reading the journal back the way
+// StateJournal::replay does has to give the debited balance and an inbox row
+// for every bought item.
+
+extern Game g_game;
+
+namespace {
+
+constexpr uint32_t BUYER_GUID = 4242;
+constexpr uint16_t PLATE_ARMOR = 2463;
+constexpr uint16_t AMOUNT = 3;
+constexpr uint64_t BALANCE = 10000;
+constexpr uint64_t PRICE = 1200;
+
+// the inbox table of IOLoginData::serializePlayerItems
+constexpr uint8_t PLAYER_ITEMS_INBOX = 2;
+
+constexpr size_t RECORD_KEY_SIZE = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+bool readInboxItems(const std::string& data, std::vector<uint16_t>& items) {
+        PropStream stream;
+        stream.init(data.data() + RECORD_KEY_SIZE, data.size() - RECORD_KEY_SIZE);
+
+        uint8_t table;
+        while (stream.read<uint8_t>(table)) {
+                uint8_t hasRow;
+                while (stream.read<uint8_t>(hasRow) && hasRow != 0) {
+                        int32_t pid, sid;
+                        uint16_t type, count;
+                        if (!stream.read<int32_t>(pid) || !stream.read<int32_t>(sid) || !stream.read<uint16_t>(type)
+                            || !stream.read<uint16_t>(count) || !stream.readBlob().second) {
+                                return false;
+                        }
+
+                        if (table == PLAYER_ITEMS_INBOX) {
+                                items.push_back(type);
+                        }
+                }
+        }
+        return true;
+}
+
+int fail(const char* message) {
+        std::fprintf(stderr, "%s\n", message);
+        return 1;
+}
+
+} // namespace
+
+int main() {
+        const std::string path = (std::filesystem::temp_directory_path() / "state_journal_market_test.bin").string();
+        std::filesystem::remove(path);
+
+        if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+                return fail("unable to load the item types, run from the source directory");
+        }
+
+        ConfigManager::setBoolean(ConfigManager::STATE_JOURNAL, true);
+        ConfigManager::setString(ConfigManager::STATE_JOURNAL_FILE, path);
+        ConfigManager::setNumber(ConfigManager::STATE_JOURNAL_MAX_SIZE, 1);
+        g_stateJournal.start();
+        if (!g_stateJournal.isEnabled()) {
+                return fail("unable to start the journal");
+        }
+
+        Player* buyer = new Player(nullptr);
+        buyer->setGUID(BUYER_GUID);
+        buyer->setName("Market Buyer");
+        buyer->incrementReferenceCounter();
+        g_game.addPlayer(buyer);
+
+        // the buy: debit, then deliver to the inbox
+        buyer->setBankBalance(BALANCE - PRICE);
+        for (uint16_t i = 0; i < AMOUNT; ++i) {
+                Item* item = Item::CreateItem(PLATE_ARMOR);
+                if (g_game.internalAddItem(buyer->getInbox().get(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+                        return fail("unable to deliver the item to the inbox");
+                }
+        }
+
+        // the final flush of a shutdown, then wait for the writer
+        g_stateJournal.shutdown();
+        g_stateJournal.join();
+
+        std::map<StateJournal::RecordKey, std::string> records;
+        if (!StateJournal::loadRecords(path, records)) {
+                return fail("unable to read the journal back");
+        }
+
+        auto balance = records.find({JOURNAL_PLAYER_BALANCE, BUYER_GUID, 0});
+        if (balance == records.end()) {
+                return fail("the debit was not journaled");
+        }
+
+        PropStream balanceStream;
+        balanceStream.init(balance->second.data() + RECORD_KEY_SIZE, balance->second.size() - RECORD_KEY_SIZE);
+        uint64_t journaledBalance;
+        if (!balanceStream.read<uint64_t>(journaledBalance) || journaledBalance != BALANCE - PRICE) {
+                return fail("the journaled balance is not the debited one");
+        }
+
+        auto items = records.find({JOURNAL_PLAYER_ITEMS, BUYER_GUID, 0});
+        if (items == records.end()) {
+                return fail("the items delivered to the inbox were not journaled");
+        }
+
+        std::vector<uint16_t> inboxItems;
+        if (!readInboxItems(items->second, inboxItems)) {
+                return fail("the journaled items are malformed");
+        }
+
+        if (inboxItems.size() != AMOUNT || std::count(inboxItems.begin(), inboxItems.end(), PLATE_ARMOR) != AMOUNT) {
+                return fail("the journaled inbox does not hold the bought items");
+        }
+
+        g_game.removePlayer(buyer);
+        std::filesystem::remove(path);
+        std::printf("market buy journaled: balance %llu, %zu inbox items\n", static_cast<unsigned long long>(journaledBalance),
+                    inboxItems.size());
+        return 0;
+}
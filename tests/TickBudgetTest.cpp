@@ -0,0 +1,74 @@
+#include "otpch.h"
+
+#include "configmanager.h"
+#include "tickbudget.h"
+
+#include <cstdio>
+
+// TickBudget::update raises the load level as soon as the smoothed lag reaches
+// a threshold, but only lowers it again once the lag fell under half of it, so
+// a lag around a threshold does not flap the level.
+
+namespace {
+
+constexpr int64_t HIGH_LAG = 100;
+constexpr int64_t CRITICAL_LAG = 400;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+	if (!condition) {
+		std::fprintf(stderr, "%s\n", message);
+		++failures;
+	}
+}
+
+void feed(int64_t lag) {
+	g_tickBudget.addTaskLag(lag);
+	g_tickBudget.update();
+}
+
+} // namespace
+
+int main() {
+	ConfigManager::setNumber(ConfigManager::LOAD_LAG_HIGH, HIGH_LAG);
+	ConfigManager::setNumber(ConfigManager::LOAD_LAG_CRITICAL, CRITICAL_LAG);
+
+	check(g_tickBudget.getLoadLevel() == LOAD_NORMAL && !g_tickBudget.isDegraded(DEGRADED_PATHFINDING), "the load must start normal");
+
+	// going up, one level per threshold the smoothed lag reaches
+	feed(1000);
+	check(g_tickBudget.getLag() >= HIGH_LAG && g_tickBudget.getLag() < CRITICAL_LAG, "the lag must be smoothed");
+	check(g_tickBudget.getLoadLevel() == LOAD_HIGH, "a lag over the high threshold must raise the level");
+	check(g_tickBudget.isDegraded(DEGRADED_SPAWNS) && !g_tickBudget.isDegraded(DEGRADED_DECAY), "high load must not defer decay");
+
+	feed(1000);
+	check(g_tickBudget.getLoadLevel() == LOAD_CRITICAL, "a lag over the critical threshold must raise the level");
+	check(g_tickBudget.isDegraded(DEGRADED_DECAY) && g_tickBudget.isDegraded(DEGRADED_EFFECTS), "critical load must degrade every system");
+
+	// under a threshold but not under half of it the level stays
+	while (g_tickBudget.getLag() >= CRITICAL_LAG) {
+		feed(300);
+	}
+	check(g_tickBudget.getLag() >= CRITICAL_LAG / 2, "the lag must fall slowly");
+	check(g_tickBudget.getLoadLevel() == LOAD_CRITICAL, "a lag under the critical threshold must keep the level");
+
+	while (g_tickBudget.getLag() >= CRITICAL_LAG / 2) {
+		check(g_tickBudget.getLoadLevel() == LOAD_CRITICAL, "a lag over half the critical threshold must keep the level");
+		feed(0);
+	}
+	check(g_tickBudget.getLoadLevel() == LOAD_HIGH, "a lag under half the critical threshold must lower the level");
+
+	while (g_tickBudget.getLag() >= HIGH_LAG / 2) {
+		check(g_tickBudget.getLoadLevel() == LOAD_HIGH, "a lag over half the high threshold must keep the level");
+		feed(0);
+	}
+	check(g_tickBudget.getLoadLevel() == LOAD_NORMAL, "a lag under half the high threshold must lower the level");
+
+	// coming back up takes the full threshold again
+	feed(HIGH_LAG + HIGH_LAG / 4);
+	check(g_tickBudget.getLag() >= HIGH_LAG / 2 && g_tickBudget.getLag() < HIGH_LAG, "the lag must be between the bounds");
+	check(g_tickBudget.getLoadLevel() == LOAD_NORMAL, "a lag under the high threshold must not raise the level");
+
+	return failures == 0 ? 0 : 1;
+}
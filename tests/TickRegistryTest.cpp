@@ -0,0 +1,134 @@
+#include "otpch.h"
+#include "tickregistry.h"
+
+#include <cstdio>
+
+// The invariants Game::checkCreatures relies on: every active object is
+// ticked exactly once per pass of its bucket, idle ones are skipped, objects
+// removed while their bucket is ticked are neither skipped nor repeated and
+// are only released after the pass, and objects added during a pass are
+// ticked by it.
+
+namespace {
+
+struct FakeCreature {
+        TickHandle& getTickHandle() {
+                return tickHandle;
+        }
+
+        TickHandle tickHandle;
+        int ticks = 0;
+        bool released = false;
+};
+
+using Registry = TickRegistry<FakeCreature, 2>;
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+        if (!condition) {
+                std::fprintf(stderr, "%s\n", message);
+                ++failures;
+        }
+}
+
+Registry makeRegistry() {
+        return Registry{[](FakeCreature* creature) { creature->released = true; }};
+}
+
+void testAddAndIdle() {
+        std::vector<FakeCreature> creatures(10);
+        Registry registry = makeRegistry();
+        for (FakeCreature& creature : creatures) {
+                check(registry.add(&creature, 0, 0), "a new object must be registered");
+        }
+        check(!registry.add(&creatures[0], 0, 0), "adding again must only update the flags");
+        check(registry.size() == creatures.size(), "size must count every object once");
+
+        registry.setFlag(&creatures[3], Registry::FLAG_IDLE, true);
+        registry.tick(0, [](FakeCreature* creature) { ++creature->ticks; });
+        for (size_t i = 0; i < creatures.size(); ++i) {
+                check(creatures[i].ticks == (i == 3 ? 0 : 1), "only the active objects must be ticked, once");
+        }
+
+        // adding an idle object again wakes it with the new flags
+        registry.add(&creatures[3], 0, Registry::FLAG_HAS_TARGET);
+        check(!registry.hasFlag(&creatures[3], Registry::FLAG_IDLE), "adding again must clear the idle flag");
+        check(registry.hasFlag(&creatures[3], Registry::FLAG_HAS_TARGET), "adding again must set the new flags");
+}
+
+void testRemoveDuringTick() {
+        std::vector<FakeCreature> creatures(20);
+        Registry registry = makeRegistry();
+        for (FakeCreature& creature : creatures) {
+                registry.add(&creature, 0, 0);
+        }
+
+        // every object removes the one after it and, from the other bucket, nothing
+        std::vector<FakeCreature*> order;
+        registry.tick(0, [&](FakeCreature* creature) {
+                order.push_back(creature);
+                const size_t index = creature - creatures.data();
+                if (index % 2 == 0 && index + 1 < creatures.size()) {
+                        registry.remove(&creatures[index + 1]);
+                        check(!creatures[index + 1].released, "a removal during the pass must be deferred");
+                }
+        });
+
+        check(order.size() == creatures.size() / 2, "removed objects must not be ticked after their removal");
+        for (size_t i = 0; i < creatures.size(); ++i) {
+                check(creatures[i].released == (i % 2 == 1), "removed objects must be released after the pass");
+                check((creatures[i].tickHandle.index == TickHandle::NONE) == (i % 2 == 1), "handles must follow the removal");
+        }
+        check(registry.size() == creatures.size() / 2, "size must drop by the removed objects");
+
+        // the swapped handles must still point at their objects
+        for (size_t i = 0; i < creatures.size(); i += 2) {
+                registry.remove(&creatures[i]);
+                check(creatures[i].released, "a removal outside a pass must be immediate");
+        }
+        check(registry.size() == 0, "every object must be gone");
+}
+
+void testAddDuringTick() {
+        std::vector<FakeCreature> creatures(4);
+        Registry registry = makeRegistry();
+        registry.add(&creatures[0], 0, 0);
+
+        registry.tick(0, [&](FakeCreature* creature) {
+                ++creature->ticks;
+                const size_t index = creature - creatures.data();
+                if (index + 1 < creatures.size()) {
+                        registry.add(&creatures[index + 1], 0, 0);
+                }
+        });
+
+        for (const FakeCreature& creature : creatures) {
+                check(creature.ticks == 1, "objects added during a pass must be ticked by it once");
+        }
+}
+
+void testOtherBucket() {
+        FakeCreature first, second;
+        Registry registry = makeRegistry();
+        registry.add(&first, 0, 0);
+        registry.add(&second, 1, 0);
+
+        registry.tick(0, [&](FakeCreature*) {
+                registry.remove(&second);
+                check(second.released, "a removal from another bucket must be immediate");
+        });
+        check(registry.size() == 1, "size must drop by the removed object");
+
+        registry.tick(1, [](FakeCreature*) { check(false, "a removed object must not be ticked"); });
+}
+
+} // namespace
+
+int main() {
+        testAddAndIdle();
+        testRemoveDuringTick();
+        testAddDuringTick();
+        testOtherBucket();
+        return failures == 0 ? 0 : 1;
+}
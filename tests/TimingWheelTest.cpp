@@ -0,0 +1,144 @@
+#include "otpch.h"
+#include "timingwheel.h"
+
+#include <cstdio>
+
+// The invariants Game::checkDecay and Spawns::checkSpawns rely on: an object
+// expires once, never before its expiry and at most one resolution after it,
+// whatever level it was placed in, including expiries past the reach of the
+// wheel; rescheduling moves an object, unscheduling drops it, and the
+// callback may schedule the expired object again.
+
+namespace {
+
+constexpr int64_t RESOLUTION = 250;
+constexpr int64_t START = 1000000;
+
+struct FakeItem {
+        TimerHandle& getTimerHandle() {
+                return timerHandle;
+        }
+
+        TimerHandle timerHandle;
+        int64_t expiry = 0;
+        int64_t expiredAt = -1;
+        int expirations = 0;
+};
+
+int failures = 0;
+
+void check(bool condition, const char* message) {
+        if (!condition) {
+                std::fprintf(stderr, "%s\n", message);
+                ++failures;
+        }
+}
+
+// advances the way the game loop does, one resolution at a time
+template <typename Fn>
+void run(TimingWheel<FakeItem>& wheel, int64_t from, int64_t to, Fn&& fn) {
+        for (int64_t now = from; now <= to; now += RESOLUTION) {
+                wheel.advance(now, [&](FakeItem* item) { fn(item, now); });
+        }
+}
+
+void testExpiries() {
+        // every level, the boundaries between them and past the reach
+        std::vector<int64_t> delays = {1, RESOLUTION - 1, RESOLUTION, RESOLUTION + 1, 63 * RESOLUTION, 64 * RESOLUTION,
+                                       65 * RESOLUTION, 4096 * RESOLUTION + 17, 262144 * RESOLUTION + 3,
+                                       (int64_t{1} << 24) * RESOLUTION + 5, (int64_t{1} << 25) * RESOLUTION};
+        std::mt19937 rng{11};
+        std::uniform_int_distribution<int64_t> randomDelay(1, 300000 * RESOLUTION);
+        for (int i = 0; i < 500; ++i) {
+                delays.push_back(randomDelay(rng));
+        }
+
+        std::vector<FakeItem> items(delays.size());
+        TimingWheel<FakeItem> wheel{RESOLUTION, START};
+        for (size_t i = 0; i < items.size(); ++i) {
+                items[i].expiry = START + delays[i];
+                check(wheel.schedule(&items[i], items[i].expiry), "a new object must be scheduled");
+                check(items[i].timerHandle.isScheduled(), "the handle must be scheduled");
+        }
+        check(wheel.size() == items.size(), "size must count every object");
+
+        const int64_t end = START + *std::max_element(delays.begin(), delays.end()) + RESOLUTION;
+        run(wheel, START, end, [](FakeItem* item, int64_t now) {
+                ++item->expirations;
+                item->expiredAt = now;
+                check(!item->timerHandle.isScheduled(), "the handle must be reset before the callback");
+        });
+
+        for (const FakeItem& item : items) {
+                check(item.expirations == 1, "every object must expire exactly once");
+                check(item.expiredAt >= item.expiry, "no object may expire early");
+                check(item.expiredAt < item.expiry + RESOLUTION, "no object may expire more than one resolution late");
+        }
+        check(wheel.size() == 0, "the wheel must be empty");
+}
+
+void testRescheduleAndUnschedule() {
+        std::vector<FakeItem> items(100);
+        TimingWheel<FakeItem> wheel{RESOLUTION, START};
+        for (size_t i = 0; i < items.size(); ++i) {
+                wheel.schedule(&items[i], START + (i + 1) * 1000);
+        }
+
+        // later, earlier and dropped, each touching the slots the others sit in
+        for (size_t i = 0; i < items.size(); i += 3) {
+                items[i].expiry = START + 500000;
+                check(!wheel.schedule(&items[i], items[i].expiry), "moving an object must not schedule it twice");
+        }
+        for (size_t i = 1; i < items.size(); i += 3) {
+                items[i].expiry = START + 300;
+                wheel.schedule(&items[i], items[i].expiry);
+        }
+        for (size_t i = 2; i < items.size(); i += 3) {
+                check(wheel.unschedule(&items[i]), "a scheduled object must be unscheduled");
+                check(!wheel.unschedule(&items[i]), "an object must only be unscheduled once");
+        }
+        check(wheel.size() == items.size() - items.size() / 3, "size must drop by the unscheduled objects");
+
+        run(wheel, START, START + 500000 + RESOLUTION, [](FakeItem* item, int64_t now) {
+                ++item->expirations;
+                item->expiredAt = now;
+        });
+
+        for (size_t i = 0; i < items.size(); ++i) {
+                if (i % 3 == 2) {
+                        check(items[i].expirations == 0, "an unscheduled object must not expire");
+                } else {
+                        check(items[i].expirations == 1, "a moved object must expire once");
+                        check(items[i].expiredAt >= items[i].expiry && items[i].expiredAt < items[i].expiry + RESOLUTION,
+                              "a moved object must expire at its new time");
+                }
+        }
+}
+
+void testScheduleFromCallback() {
+        FakeItem item;
+        TimingWheel<FakeItem> wheel{RESOLUTION, START};
+        item.expiry = START + 1000;
+        wheel.schedule(&item, item.expiry);
+
+        // as a decaying item that transforms into another decaying item
+        run(wheel, START, START + 10000, [&](FakeItem* expired, int64_t now) {
+                ++expired->expirations;
+                if (expired->expirations < 3) {
+                        expired->expiry = now + 1000;
+                        wheel.schedule(expired, expired->expiry);
+                }
+        });
+
+        check(item.expirations == 3, "an object scheduled again by the callback must expire again");
+        check(wheel.size() == 0, "the wheel must be empty");
+}
+
+} // namespace
+
+int main() {
+        testExpiries();
+        testRescheduleAndUnschedule();
+        testScheduleFromCallback();
+        return failures == 0 ? 0 : 1;
+}